@@ -1,4 +1,4 @@
-// itlib-any v1.03
+// itlib-any v1.05
 //
 // An alternative implementation of C++17's std::any
 //
@@ -28,6 +28,12 @@
 //
 //                  VERSION HISTORY
 //
+//  1.05 (2026-10-16) * Static ops table instead of a virtual object block. Heap
+//                      allocations contain only the object
+//                    * Trivially copyable inline objects are moved with memcpy
+//                    * Decay the type when constructing or assigning from a
+//                      value (don't store references)
+//  1.04 (2026-10-16) * Small buffer optimization
 //  1.03 (2025-07-06) * Fix unscoped std::nullptr_t (pedantic clang error)
 //  1.02 (2023-04-29) * Support for typied and any_cast
 //                    * Fixed tdata<const T>
@@ -45,6 +51,17 @@
 //   itlib::pmr_allocator. A default allocator is provided.
 // * The type in itlib::any does not need to be copyable. If a copy is
 //   attempted for a non-copyable type, std::bad_cast is thrown
+// * The size of the inline buffer of the small buffer optimization can be
+//   configured with the second template argument: itlib::any<Alloc, Size>.
+//   The default is 3 pointers. Objects which fit in it and are nothrow
+//   move-constructible are stored inline and don't allocate. Note that this
+//   means that moving an itlib::any may move the object inside and pointers
+//   to it are only stable for objects stored on the heap.
+//
+// Type erasure is implemented with a pointer to a static table of operations
+// per type (as opposed to a virtual interface), so heap allocations contain
+// only the object itself and sizeof(itlib::any<>) is 4 pointers (when the
+// allocator is empty).
 //
 //                  TESTS
 //
@@ -52,8 +69,10 @@
 // https://github.com/iboB/itlib/blob/master/test/
 //
 #include <new>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <utility>
 #include <typeinfo>
 #include <type_traits>
@@ -61,12 +80,16 @@
 
 namespace itlib {
 
-template <typename Alloc>
+template <typename Alloc, std::size_t InlineSize>
 class any;
 
 namespace anyimpl {
 struct default_allocator {
     void* allocate_bytes(std::size_t n, std::size_t a) {
+        // some aligned_alloc implementations fail for alignments below that of a pointer
+        // or sizes which are not a multiple of the alignment
+        if (a < alignof(void*)) a = alignof(void*);
+        n = (n + a - 1) / a * a;
         void* ret =
 #if defined(_WIN32)
             _aligned_malloc(n, a);
@@ -85,64 +108,113 @@ struct default_allocator {
     }
 };
 
-struct obj_block {
-    uint32_t size; // size of block
-    uint32_t alignment; // alignment of block
-
-    virtual ~obj_block() = default;
+// alignment of the inline buffer
+static constexpr std::size_t inline_alignment = alignof(double) > alignof(void*) ? alignof(double) : alignof(void*);
 
-    virtual void* data() noexcept = 0;
+struct ops {
+    std::size_t size;
+    std::size_t alignment;
 
-    virtual void clone_to(obj_block* buf) const = 0;
+    // size needed to store the object inline
+    // SIZE_MAX if it can't be stored inline regardless of the buffer size
+    std::size_t inline_size;
 
-    virtual const std::type_info& type() const noexcept = 0;
-};
+    const std::type_info& (*type)();
 
-template <typename T>
-struct obj_block_for final : public obj_block {
-    T m_data;
+    // copy-construct at dst
+    // throws std::bad_cast for non-copyable types
+    void (*copy)(void* dst, const void* src);
 
-    template <typename... Args>
-    obj_block_for(Args&&... args)
-        : m_data(std::forward<Args>(args)...)
-    {}
+    // move-construct at dst and destroy src
+    // null for trivially copyable types whose buffer is simply memcpy-d
+    // only used for inline objects (which are nothrow move-constructible)
+    void (*relocate)(void* dst, void* src);
 
-    ~obj_block_for() = default;
+    // null for trivially destructible types
+    void (*destroy)(void* obj);
+};
 
-    virtual void* data() noexcept override {
-        return &m_data;
+template <typename T>
+struct ops_for {
+    static const std::type_info& type() {
+        return typeid(T);
     }
 
     template <typename U = T, typename std::enable_if<!std::is_copy_constructible<U>::value, int>::type = 0>
-    [[noreturn]] void do_clone_to(obj_block*) const {
+    [[noreturn]] static void copy(void*, const void*) {
         throw std::bad_cast();
     }
 
     template <typename U = T, typename std::enable_if<std::is_copy_constructible<U>::value, int>::type = 0>
-    void do_clone_to(obj_block* buf) const {
-        new (buf) obj_block_for(m_data);
+    static void copy(void* dst, const void* src) {
+        new (dst) T(*static_cast<const T*>(src));
     }
 
-    virtual void clone_to(obj_block* buf) const override {
-        do_clone_to<>(buf);
+    static void relocate(void* dst, void* src) {
+        auto s = static_cast<T*>(src);
+        new (dst) T(std::move(*s));
+        s->~T();
     }
 
-    virtual const std::type_info& type() const noexcept override {
-        return typeid(T);
+    static void destroy(void* obj) {
+        static_cast<T*>(obj)->~T();
     }
+
+    static constexpr bool can_be_inline = std::is_nothrow_move_constructible<T>::value && alignof(T) <= inline_alignment;
+
+    static constexpr std::size_t inline_size = can_be_inline ? sizeof(T) : SIZE_MAX;
+
+    using fn_t = void (*)(void*, void*);
+    static constexpr fn_t relocate_fn(std::false_type /*needs relocate*/) { return nullptr; }
+    static constexpr fn_t relocate_fn(std::true_type /*needs relocate*/) { return &relocate; }
+
+    using destroy_fn_t = void (*)(void*);
+    static constexpr destroy_fn_t destroy_fn(std::false_type /*needs destroy*/) { return nullptr; }
+    static constexpr destroy_fn_t destroy_fn(std::true_type /*needs destroy*/) { return &destroy; }
+
+    static const ops value;
+};
+
+template <typename T>
+const ops ops_for<T>::value = {
+    sizeof(T),
+    alignof(T),
+    ops_for<T>::inline_size,
+    &ops_for<T>::type,
+    &ops_for<T>::template copy<>,
+    ops_for<T>::relocate_fn(std::integral_constant<bool, ops_for<T>::can_be_inline && !std::is_trivially_copyable<T>::value>{}),
+    ops_for<T>::destroy_fn(std::integral_constant<bool, !std::is_trivially_destructible<T>::value>{}),
 };
 
 // copied from itlib-type_traits
 template <typename>
 struct is_any : public std::false_type {};
-template <typename Alloc>
-struct is_any<any<Alloc>> : public std::true_type {};
+template <typename Alloc, std::size_t InlineSize>
+struct is_any<any<Alloc, InlineSize>> : public std::true_type {};
 
 }
 
-template <typename Alloc = anyimpl::default_allocator>
+template <typename Alloc = anyimpl::default_allocator, std::size_t InlineSize = 3 * sizeof(void*)>
 class any : private /*EBO*/ Alloc {
-    anyimpl::obj_block* m_block = nullptr;
+    template <typename OAlloc, std::size_t OInlineSize>
+    friend class any;
+
+    const anyimpl::ops* m_ops = nullptr;
+
+    union storage {
+        void* heap;
+        alignas(anyimpl::inline_alignment) unsigned char buf[InlineSize > sizeof(void*) ? InlineSize : sizeof(void*)];
+    } m_storage;
+
+    static bool fits_inline(const anyimpl::ops& ops) noexcept {
+        return ops.inline_size <= InlineSize;
+    }
+
+    // assumes we have a value
+    void* ptr() const noexcept {
+        if (fits_inline(*m_ops)) return const_cast<unsigned char*>(m_storage.buf);
+        return m_storage.heap;
+    }
 public:
     using allocator_type = Alloc;
 
@@ -150,19 +222,18 @@ public:
     explicit any(const Alloc& a) noexcept : Alloc(a) {}
     any(std::allocator_arg_t, const Alloc& a) : Alloc(a) {}
 
-    any(any&& o) noexcept : Alloc(o), m_block(o.m_block) {
-        o.m_block = nullptr;
+    any(any&& o) noexcept : Alloc(o) {
+        take(o);
     }
     any& operator=(any&& o) noexcept {
         if (&o == this) return *this; // prevent self usurp
         reset();
-        m_block = o.m_block;
-        o.m_block = nullptr;
+        take(o);
         return *this;
     }
 
-    template <typename OAlloc>
-    any(const any<OAlloc>& o, const Alloc& a = {}) : Alloc(a) {
+    template <typename OAlloc, std::size_t OInlineSize>
+    any(const any<OAlloc, OInlineSize>& o, const Alloc& a = {}) : Alloc(a) {
         copy_from(o);
     }
     any(const any& o) : any(o, Alloc{}) {}
@@ -174,29 +245,29 @@ public:
     // only enable these if T is not another any
     template <typename T, typename std::enable_if<!anyimpl::is_any<typename std::decay<T>::type>::value, int>::type = 0>
     any(T&& t) {
-        emplace<T>(std::forward<T>(t));
+        emplace<typename std::decay<T>::type>(std::forward<T>(t));
     }
     template <typename T, typename std::enable_if<!anyimpl::is_any<typename std::decay<T>::type>::value, int>::type = 0>
     any(std::allocator_arg_t, const Alloc& a, T&& t) : Alloc(a) {
-        emplace<T>(std::forward<T>(t));
+        emplace<typename std::decay<T>::type>(std::forward<T>(t));
     }
     template <typename T, typename std::enable_if<!anyimpl::is_any<typename std::decay<T>::type>::value, int>::type = 0>
     any& operator=(T&& t) {
-        emplace<T>(std::forward<T>(t));
+        emplace<typename std::decay<T>::type>(std::forward<T>(t));
         return *this;
     }
 
     ~any() { reset(); }
 
-    bool has_value() const noexcept { return !!m_block; }
+    bool has_value() const noexcept { return !!m_ops; }
     explicit operator bool() const noexcept { return has_value(); }
 
     void* data() noexcept {
-        if (m_block) return m_block->data();
+        if (m_ops) return ptr();
         return nullptr;
     }
     const void* data() const noexcept {
-        if (m_block) return m_block->data();
+        if (m_ops) return ptr();
         return nullptr;
     }
 
@@ -208,72 +279,95 @@ public:
     Alloc get_allocator() const noexcept { return *this; }
 
     void reset() noexcept {
-        if (!m_block) return;
-        auto size = m_block->size;
-        auto alignment = m_block->alignment;
-        m_block->~obj_block();
-        free_block(size, alignment);
+        if (!m_ops) return;
+        auto& ops = *m_ops;
+        m_ops = nullptr;
+        if (fits_inline(ops)) {
+            if (ops.destroy) ops.destroy(m_storage.buf);
+            return;
+        }
+        if (ops.destroy) ops.destroy(m_storage.heap);
+        Alloc::deallocate_bytes(m_storage.heap, ops.size, ops.alignment);
     }
 
     template <typename T, typename... Args>
     T& emplace(Args&&... args) {
         reset();
-        using obj_block_for_t = anyimpl::obj_block_for<T>;
-        constexpr uint32_t size = sizeof(obj_block_for_t);
-        constexpr uint32_t alignment = alignof(obj_block_for_t);
-        m_block = static_cast<anyimpl::obj_block*>(Alloc::allocate_bytes(size, alignment));
+        auto& ops = anyimpl::ops_for<T>::value;
+        if (fits_inline(ops)) {
+            auto r = new (m_storage.buf) T(std::forward<Args>(args)...);
+            m_ops = &ops;
+            return *r;
+        }
+        void* block = Alloc::allocate_bytes(sizeof(T), alignof(T));
         try {
-            auto r = new (m_block) obj_block_for_t(std::forward<Args>(args)...);
-            r->size = size;
-            r->alignment = alignment;
-            return r->m_data;
+            auto r = new (block) T(std::forward<Args>(args)...);
+            m_storage.heap = block;
+            m_ops = &ops;
+            return *r;
         }
         catch (...) {
-            free_block(size, alignment);
+            Alloc::deallocate_bytes(block, sizeof(T), alignof(T));
             throw;
         }
     }
 
-    template <typename OAlloc>
-    void copy_from(const any<OAlloc>& o) {
+    template <typename OAlloc, std::size_t OInlineSize>
+    void copy_from(const any<OAlloc, OInlineSize>& o) {
         reset();
         if (!o.has_value()) return;
-        m_block = static_cast<anyimpl::obj_block*>(Alloc::allocate_bytes(o.m_block->size, o.m_block->alignment));
+        auto& ops = *o.m_ops;
+        if (fits_inline(ops)) {
+            ops.copy(m_storage.buf, o.data());
+            m_ops = &ops;
+            return;
+        }
+        void* block = Alloc::allocate_bytes(ops.size, ops.alignment);
         try {
-            o.m_block->clone_to(m_block);
-            m_block->size = o.m_block->size;
-            m_block->alignment = o.m_block->alignment;
+            ops.copy(block, o.data());
+            m_storage.heap = block;
+            m_ops = &ops;
         }
         catch (...) {
-            free_block(o.m_block->size, o.m_block->alignment);
+            Alloc::deallocate_bytes(block, ops.size, ops.alignment);
             throw;
         }
     }
 
     const std::type_info& type() const noexcept {
-        if (m_block) return m_block->type();
+        if (m_ops) return m_ops->type();
         return typeid(void);
     }
 
 private:
-    void free_block(size_t size, size_t alignment) noexcept {
-        Alloc::deallocate_bytes(m_block, size, alignment);
-        m_block = nullptr;
+    // assumes we're empty
+    void take(any& o) noexcept {
+        if (!o.m_ops) return;
+        auto& ops = *o.m_ops;
+        if (fits_inline(ops)) {
+            if (ops.relocate) ops.relocate(m_storage.buf, o.m_storage.buf);
+            else std::memcpy(m_storage.buf, o.m_storage.buf, sizeof(m_storage.buf)); // whole buffer: fixed size copy
+        }
+        else {
+            m_storage.heap = o.m_storage.heap;
+        }
+        m_ops = &ops;
+        o.m_ops = nullptr;
     }
 };
 
 template <typename T>
 const T* any_cast(std::nullptr_t) { return nullptr; }
 
-template <typename T, typename Alloc>
-const T* any_cast(const any<Alloc>* a) {
+template <typename T, typename Alloc, std::size_t InlineSize>
+const T* any_cast(const any<Alloc, InlineSize>* a) {
     if (!a) return nullptr;
     if (typeid(T) != a->type()) return nullptr;
     return a->template tdata<T>();
 }
 
-template <typename T, typename Alloc>
-T* any_cast(any<Alloc>* a) {
+template <typename T, typename Alloc, std::size_t InlineSize>
+T* any_cast(any<Alloc, InlineSize>* a) {
     if (!a) return nullptr;
     if (typeid(T) != a->type()) return nullptr;
     return a->template tdata<T>();
@@ -289,13 +383,13 @@ T do_cast(A& a) {
 }
 }
 
-template <typename T, typename Alloc>
-T any_cast(const any<Alloc>& a) { return anyimpl::do_cast<T>(a); }
+template <typename T, typename Alloc, std::size_t InlineSize>
+T any_cast(const any<Alloc, InlineSize>& a) { return anyimpl::do_cast<T>(a); }
 
-template <typename T, typename Alloc>
-T any_cast(any<Alloc>& a) { return anyimpl::do_cast<T>(a); }
+template <typename T, typename Alloc, std::size_t InlineSize>
+T any_cast(any<Alloc, InlineSize>& a) { return anyimpl::do_cast<T>(a); }
 
-template <typename T, typename Alloc>
-T any_cast(any<Alloc>&& a) { return std::move(anyimpl::do_cast<T&>(a)); }
+template <typename T, typename Alloc, std::size_t InlineSize>
+T any_cast(any<Alloc, InlineSize>&& a) { return std::move(anyimpl::do_cast<T&>(a)); }
 
 }
@@ -1,10 +1,10 @@
-// itlib-atomic-shared-ptr-storage v1.01
+// itlib-atomic-shared-ptr-storage v1.02
 //
 // A saner alternative to std::atomic<std::shared_ptr<T>>
 //
 // SPDX-License-Identifier: MIT
 // MIT License:
-// Copyright(c) 2022 Borislav Stanimirov
+// Copyright(c) 2022-2026 Borislav Stanimirov
 //
 // Permission is hereby granted, free of charge, to any person obtaining
 // a copy of this software and associated documentation files(the
@@ -28,6 +28,7 @@
 //
 //                  VERSION HISTORY
 //
+//  1.02 (2026-10-16) Lock-free fallback with split reference counting
 //  1.01 (2023-04-29) Disable MSVC warning 4243 (padding due do alignment)
 //  1.00 (2022-13-12) Initial release
 //
@@ -46,6 +47,24 @@
 // dangerous and bad. This class provides the interface which I consider
 // valuable and explicitly describes the purpose - atomic ops.
 //
+// Implementation:
+// If std::atomic<std::shared_ptr<T>> is available (C++20), it is used. The
+// stdlib implementers know best how to make it fast on their platform.
+// Otherwise, on 64-bit x86 and ARM the shared_ptr is kept in a heap-allocated
+// node and the storage is a single atomic word: a 48-bit pointer to the node
+// and a 16-bit count of the loads in progress (split reference counting).
+// load() pins the node by incrementing the count with fetch_add, copies the
+// shared_ptr, and then unpins it. Writers swap the node and transfer the
+// count of the old one to its internal counter, so it's deleted when the last
+// load which pinned it is done. All operations are lock-free. Concurrent
+// loads still write to the same cache line (as does copying a shared_ptr),
+// but they never wait for each other or for writers.
+// store, exchange and compare_exchange allocate a node (and abort with
+// std::bad_alloc if they can't, since they are noexcept). There can be at
+// most 65535 loads in progress at the same time (this is asserted in debug
+// builds).
+// On other platforms a spinlock guards the shared_ptr.
+//
 //                  TESTS
 //
 // You can find unit tests in the official repo:
@@ -53,15 +72,17 @@
 //
 #pragma once
 #include <memory>
+#include <atomic>
+#include <cstdint>
+#include <cassert>
 
-#if __cplusplus >= 202000L && defined(__cpp_lib_atomic_shared_ptr)
-// do what the stdlib implementers chose as best in case it's available
-namespace itlib::impl {
-template <typename T>
-using asps_holder = std::atomic<std::shared_ptr<T>>;
-}
+#if defined(__x86_64__) || defined(_M_X64) || ((defined(__aarch64__) || defined(_M_ARM64)) && !defined(__ANDROID__))
+// user-space pointers fit in 48 bits (no pointer tagging on Android)
+#   define ITLIB_ASPS_SPLIT_COUNT 1
 #else
-#include <atomic>
+#   define ITLIB_ASPS_SPLIT_COUNT 0
+#endif
+
 namespace itlib {
 namespace impl {
 
@@ -87,13 +108,13 @@ struct asps_spinlock {
 #pragma warning(disable : 4324)
 #endif
 template <typename T>
-class alignas(64) asps_holder {
+class alignas(64) asps_spinlock_holder {
     using sptr = std::shared_ptr<T>;
     sptr m_ptr;
     mutable asps_spinlock m_spinlock;
 public:
-    asps_holder() noexcept = default;
-    asps_holder(std::shared_ptr<T> ptr) noexcept : m_ptr(std::move(ptr)) {}
+    asps_spinlock_holder() noexcept = default;
+    asps_spinlock_holder(std::shared_ptr<T> ptr) noexcept : m_ptr(std::move(ptr)) {}
 
     sptr load() const noexcept {
         asps_spinlock::lock_guard _l(m_spinlock);
@@ -130,13 +151,156 @@ public:
         }
     }
 };
+
+#if ITLIB_ASPS_SPLIT_COUNT
+template <typename T>
+class alignas(64) asps_split_count_holder {
+    using sptr = std::shared_ptr<T>;
+
+    struct node {
+        node(sptr p) noexcept : ptr(std::move(p)) {}
+        sptr ptr;
+        // the pins released by loads (negative) plus the pins transferred by
+        // the writer which replaced the node
+        // the node is deleted when it reaches zero after the transfer
+        std::atomic<int64_t> internal_count{0};
+    };
+
+    static constexpr int count_shift = 48;
+    static constexpr uint64_t one_pin = uint64_t(1) << count_shift;
+    static constexpr uint64_t ptr_mask = one_pin - 1;
+
+    static node* node_of(uint64_t word) noexcept { return reinterpret_cast<node*>(word & ptr_mask); }
+    static int64_t pins_of(uint64_t word) noexcept { return int64_t(word >> count_shift); }
+
+    static uint64_t make_word(sptr ptr) noexcept {
+        auto n = new node(std::move(ptr));
+        auto word = uint64_t(reinterpret_cast<uintptr_t>(n));
+        assert((word & ~ptr_mask) == 0);
+        return word;
+    }
+
+    static void release(node* n, int64_t count) noexcept {
+        if (n->internal_count.fetch_add(count, std::memory_order_acq_rel) + count == 0) {
+            delete n;
+        }
+    }
+
+    // zero means empty and only happens before the first store
+    // afterwards empty pointers are also stored in nodes, so that a node,
+    // once pinned, can't be freed and reused while the pin is held
+    mutable std::atomic<uint64_t> m_word;
+
+    // returns the word with the pin
+    uint64_t pin() const noexcept {
+        auto word = m_word.fetch_add(one_pin, std::memory_order_acquire) + one_pin;
+        assert(pins_of(word) != 0 && "atomic_shared_ptr_storage: too many loads in progress");
+        return word;
+    }
+
+    void unpin(uint64_t word) const noexcept {
+        auto n = node_of(word);
+        while (node_of(word) == n) {
+            // still current: just return the pin
+            if (m_word.compare_exchange_weak(word, word - one_pin, std::memory_order_release, std::memory_order_relaxed)) return;
+        }
+        // replaced: the writer transferred our pin to the node
+        release(n, -1);
+    }
+
+    // the caller has exclusive ownership of the replaced word (and holds extra_pins of its pins)
+    static void retire(uint64_t word, int64_t extra_pins) noexcept {
+        if (auto n = node_of(word)) {
+            release(n, pins_of(word) - extra_pins);
+        }
+    }
+
+public:
+    asps_split_count_holder() noexcept : m_word(0) {}
+    asps_split_count_holder(sptr ptr) noexcept : m_word(ptr ? make_word(std::move(ptr)) : 0) {}
+    ~asps_split_count_holder() {
+        delete node_of(m_word.load(std::memory_order_acquire));
+    }
+
+    sptr load() const noexcept {
+        if (m_word.load(std::memory_order_acquire) == 0) return {};
+        auto word = pin();
+        sptr ret = node_of(word)->ptr;
+        unpin(word);
+        return ret;
+    }
+
+    void store(sptr ptr) noexcept {
+        retire(m_word.exchange(make_word(std::move(ptr)), std::memory_order_acq_rel), 0);
+    }
+
+    sptr exchange(sptr ptr) noexcept {
+        auto old = m_word.exchange(make_word(std::move(ptr)), std::memory_order_acq_rel);
+        sptr ret;
+        if (auto n = node_of(old)) {
+            // we own the node until we transfer the pins
+            ret = n->ptr;
+        }
+        retire(old, 0);
+        return ret;
+    }
+
+    bool compare_exchange_strong(sptr& expect, sptr ptr) noexcept {
+        uint64_t desired = 0;
+        while (true) {
+            auto word = m_word.load(std::memory_order_acquire);
+            if (word == 0) {
+                if (expect) {
+                    expect.reset();
+                    if (desired) retire(desired, 0);
+                    return false;
+                }
+                if (!desired) desired = make_word(std::move(ptr));
+                if (m_word.compare_exchange_strong(word, desired, std::memory_order_acq_rel, std::memory_order_relaxed)) return true;
+                continue;
+            }
+
+            word = pin();
+            auto n = node_of(word);
+            if (n->ptr != expect) {
+                expect = n->ptr;
+                unpin(word);
+                if (desired) retire(desired, 0);
+                return false;
+            }
+
+            if (!desired) desired = make_word(std::move(ptr));
+            while (node_of(word) == n) {
+                if (m_word.compare_exchange_weak(word, desired, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                    retire(word, 1); // our pin is in the count
+                    return true;
+                }
+            }
+            // replaced while we were comparing
+            release(n, -1);
+        }
+    }
+};
+#endif
+
 #if defined(_MSC_VER)
 #pragma warning(pop)
 #endif
 
+#if __cplusplus >= 202000L && defined(__cpp_lib_atomic_shared_ptr)
+// do what the stdlib implementers chose as best in case it's available
+template <typename T>
+using asps_holder = std::atomic<std::shared_ptr<T>>;
+#elif ITLIB_ASPS_SPLIT_COUNT
+template <typename T>
+using asps_holder = asps_split_count_holder<T>;
+#else
+template <typename T>
+using asps_holder = asps_spinlock_holder<T>;
+#endif
+
 }
 }
-#endif
 
 namespace itlib {
 template <typename T>
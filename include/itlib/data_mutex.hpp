@@ -1,10 +1,10 @@
-// itlib-data-mutex v1.00
+// itlib-data-mutex v1.03
 //
 // A lockable data type. Merging mutex with data
 //
 // SPDX-License-Identifier: MIT
 // MIT License:
-// Copyright(c) 2023 Borislav Stanimirov
+// Copyright(c) 2023-2026 Borislav Stanimirov
 //
 // Permission is hereby granted, free of charge, to any person obtaining
 // a copy of this software and associated documentation files(the
@@ -28,6 +28,9 @@
 //
 //                  VERSION HISTORY
 //
+//  1.03 (2026-10-16) mutex() accessor
+//  1.02 (2026-10-16) seqlock and read_optimistic
+//  1.01 (2026-10-16) sharded_map
 //  1.00 (2023-02-07) Initial release
 //
 //
@@ -47,6 +50,57 @@
 // -> and *. In the case of the try_* functions, they also have a bool
 // interface
 //
+// mutex() returns a const reference to the mutex. It's useful for mutex types
+// which can be queried, like itlib::instrumented_mutex from mutex.hpp:
+//     itlib::data_mutex<T, itlib::instrumented_mutex<std::shared_mutex>> dm;
+//     auto stats = dm.mutex().stats();
+//
+// data_mutex<T, seqlock<>> is a specialization for small trivially copyable
+// (and default constructible) types which are read much more often than
+// written. Reads never write to memory shared with other threads (unlike
+// shared_mutex::lock_shared which modifies the reader count). Instead of a
+// shared lock they copy the data and retry if a write happened during the
+// copy:
+// * read_optimistic() - returns a copy of the object
+// * try_read_optimistic(T& out) - a single attempt. Returns false if the
+//   object was being written to
+// * shared_lock() - a wrapper of a copy from read_optimistic. For
+//   compatibility with the other data_mutex-es
+// * unique_lock(), try_unique_lock() - writer locks (with seqlock's template
+//   argument, std::mutex by default). They provide access to a copy of the
+//   object, which is published on unlock
+// The object is stored as an array of atomic words, so there are no data
+// races and thread sanitizers don't complain.
+//
+// With C++17 the library also defines sharded_map<Map, Mutex>. It's a
+// concurrent map which splits the keys among several shards (a power of two),
+// each of which is a cache-line aligned data_mutex<Map, Mutex>. Map is an
+// unordered map type like std::unordered_map or itlib::transparent_umap, and
+// Mutex is typically std::shared_mutex. Operations on different shards don't
+// contend with each other. The shard of a key is chosen from its hash with
+// Map::hasher (mixed, so that it's independent from the buckets of the map).
+//
+// No references or iterators to elements escape the locks. The interface is:
+// * try_emplace(key, args...), insert_or_assign(key, value) - return true if
+//   the element was inserted
+// * erase(key) - returns the number of erased elements
+// * contains(key), get(key) - get returns std::optional<mapped_type>
+// * visit(key, f) - calls f(const mapped_type&) under a shared lock if the
+//   key exists. Returns whether it does
+// * modify(key, f) - like visit, but f(mapped_type&) under a unique lock
+// * find_many(keys, f) - calls f(index, const mapped_type*) for each key in
+//   the container keys (the pointer is null if the key is not in the map).
+//   Keys are grouped by shard, so each shard is locked once
+// * find_many(keys) - returns a vector of std::optional<mapped_type>
+// * insert_many(begin, end) - try_emplace for a range of pairs, grouped by
+//   shard. Returns the number of inserted elements. The range is traversed
+//   more than once, so the iterators must be forward iterators
+// * size(), empty(), clear(), for_each(f) - go through the shards one by one
+// * num_shards(), shard_index(key), shard(i) - direct access to the shards
+// Batch and whole-map functions lock one shard at a time, so they are not
+// atomic with respect to other operations. Keys of types other than
+// key_type work if Map::hasher and the map itself support them.
+//
 //
 //                  TESTS
 //
@@ -55,6 +109,21 @@
 //
 #pragma once
 #include <utility>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+
+#if __cplusplus >= 201700
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <vector>
+#include <iterator>
+#endif
 
 namespace itlib {
 
@@ -173,6 +242,375 @@ public:
     try_shared_lock_t try_shared_lock() const {
         return try_shared_lock_t(*this);
     }
+
+    const Mutex& mutex() const noexcept { return m_mutex; }
 };
 
+// use as the Mutex argument of data_mutex to make it a seqlock
+// WriterMutex is the mutex between writers
+template <typename WriterMutex = std::mutex>
+struct seqlock {};
+
+template <typename T, typename WriterMutex>
+class data_mutex<T, seqlock<WriterMutex>> {
+    static_assert(std::is_trivially_copyable<T>::value, "seqlock data must be trivially copyable");
+    static_assert(std::is_default_constructible<T>::value, "seqlock data must be default constructible");
+
+    using word = uintptr_t;
+    static constexpr size_t num_words = (sizeof(T) + sizeof(word) - 1) / sizeof(word);
+
+    // odd while a write is in progress
+    std::atomic<uint32_t> m_seq;
+    std::atomic<word> m_words[num_words];
+    WriterMutex m_writer_mutex;
+
+    // words are copied with relaxed atomics, the sequence number orders them
+    void load_words(T& out) const {
+        word buf[num_words];
+        for (size_t i = 0; i < num_words; ++i) {
+            buf[i] = m_words[i].load(std::memory_order_relaxed);
+        }
+        std::memcpy(&out, buf, sizeof(T));
+    }
+
+    // requires a writer lock
+    void store(const T& value) {
+        word buf[num_words] = {};
+        std::memcpy(buf, &value, sizeof(T));
+        const auto seq = m_seq.load(std::memory_order_relaxed);
+        m_seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < num_words; ++i) {
+            m_words[i].store(buf[i], std::memory_order_relaxed);
+        }
+        m_seq.store(seq + 2, std::memory_order_release);
+    }
+
+public:
+    template <typename... Args>
+    data_mutex(Args&&... args) : m_seq(0) {
+        const T value(std::forward<Args>(args)...);
+        word buf[num_words] = {};
+        std::memcpy(buf, &value, sizeof(T));
+        for (size_t i = 0; i < num_words; ++i) {
+            m_words[i].store(buf[i], std::memory_order_relaxed);
+        }
+    }
+
+    data_mutex(const data_mutex&) = delete;
+    data_mutex& operator=(const data_mutex&) = delete;
+    data_mutex(data_mutex&&) = delete;
+    data_mutex& operator=(data_mutex&&) = delete;
+
+    bool try_read_optimistic(T& out) const {
+        const auto seq = m_seq.load(std::memory_order_acquire);
+        if (seq & 1) return false;
+        load_words(out);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return m_seq.load(std::memory_order_relaxed) == seq;
+    }
+
+    T read_optimistic() const {
+        T ret{};
+        while (!try_read_optimistic(ret)) {
+            // the writer may have been preempted
+            std::this_thread::yield();
+        }
+        return ret;
+    }
+
+    class shared_lock_t {
+        T m_data;
+    public:
+        explicit shared_lock_t(const data_mutex& dm) : m_data(dm.read_optimistic()) {}
+        const T& operator*() const { return m_data; }
+        const T* operator->() const { return &m_data; }
+    };
+
+    class unique_lock_base_t {
+    protected:
+        data_mutex* m_dm;
+        T m_data;
+        explicit unique_lock_base_t(data_mutex* dm) : m_dm(dm) {
+            if (m_dm) m_dm->load_words(m_data);
+        }
+        ~unique_lock_base_t() {
+            if (!m_dm) return;
+            m_dm->store(m_data);
+            m_dm->m_writer_mutex.unlock();
+        }
+        unique_lock_base_t(const unique_lock_base_t&) = delete;
+        unique_lock_base_t& operator=(const unique_lock_base_t&) = delete;
+        unique_lock_base_t(unique_lock_base_t&& o) noexcept : m_dm(o.m_dm), m_data(o.m_data) {
+            o.m_dm = nullptr;
+        }
+        unique_lock_base_t& operator=(unique_lock_base_t&&) = delete;
+    public:
+        T& operator*() { return m_data; }
+        T* operator->() { return &m_data; }
+        const T& operator*() const { return m_data; }
+        const T* operator->() const { return &m_data; }
+    };
+
+    struct unique_lock_t : public unique_lock_base_t {
+        explicit unique_lock_t(data_mutex& dm) : unique_lock_base_t((dm.m_writer_mutex.lock(), &dm)) {}
+    };
+
+    struct try_unique_lock_t : public unique_lock_base_t {
+        explicit try_unique_lock_t(data_mutex& dm)
+            : unique_lock_base_t(dm.m_writer_mutex.try_lock() ? &dm : nullptr)
+        {}
+        explicit operator bool() const noexcept { return !!this->m_dm; }
+    };
+
+    unique_lock_t unique_lock() {
+        return unique_lock_t(*this);
+    }
+
+    try_unique_lock_t try_unique_lock() {
+        return try_unique_lock_t(*this);
+    }
+
+    shared_lock_t shared_lock() const {
+        return shared_lock_t(*this);
+    }
+};
+
+#if __cplusplus >= 201700
+
+template <typename Map, typename Mutex>
+class sharded_map {
+public:
+    using map_type = Map;
+    using shard_type = data_mutex<Map, Mutex>;
+    using key_type = typename Map::key_type;
+    using mapped_type = typename Map::mapped_type;
+    using hasher = typename Map::hasher;
+
+    // not std::hardware_destructive_interference_size, as it may differ
+    // between compilation units (and compilers warn about it)
+    static constexpr size_t cache_line_size = 64;
+
+    // a power of two, at least twice the number of hardware threads
+    static size_t default_num_shards() {
+        size_t min = 2 * size_t(std::thread::hardware_concurrency());
+        if (min < 8) min = 8;
+        size_t ret = 1;
+        while (ret < min) ret *= 2;
+        return ret;
+    }
+
+    // the number of shards is rounded up to a power of two
+    explicit sharded_map(size_t num_shards = default_num_shards(), const hasher& hash = hasher())
+        : m_hash(hash)
+    {
+        m_num_shards = 1;
+        while (m_num_shards < num_shards) {
+            m_num_shards *= 2;
+            ++m_shard_bits;
+        }
+        m_shards.reset(new shard_holder[m_num_shards]);
+    }
+
+    sharded_map(const sharded_map&) = delete;
+    sharded_map& operator=(const sharded_map&) = delete;
+
+    size_t num_shards() const noexcept { return m_num_shards; }
+
+    shard_type& shard(size_t i) noexcept { return m_shards[i].data; }
+    const shard_type& shard(size_t i) const noexcept { return m_shards[i].data; }
+
+    template <typename K>
+    size_t shard_index(const K& key) const {
+        if (!m_shard_bits) return 0;
+        // fibonacci hashing: the top bits of the product depend on all bits of the hash
+        const uint64_t h = uint64_t(m_hash(key)) * 0x9E3779B97F4A7C15ull;
+        return size_t(h >> (64 - m_shard_bits));
+    }
+
+    template <typename K>
+    shard_type& shard_for(const K& key) { return shard(shard_index(key)); }
+    template <typename K>
+    const shard_type& shard_for(const K& key) const { return shard(shard_index(key)); }
+
+    template <typename K, typename... Args>
+    bool try_emplace(K&& key, Args&&... args) {
+        auto& s = shard_for(key);
+        return s.unique_lock()->try_emplace(std::forward<K>(key), std::forward<Args>(args)...).second;
+    }
+
+    template <typename K, typename M>
+    bool insert_or_assign(K&& key, M&& value) {
+        auto& s = shard_for(key);
+        return s.unique_lock()->insert_or_assign(std::forward<K>(key), std::forward<M>(value)).second;
+    }
+
+    template <typename K>
+    size_t erase(const K& key) {
+        return shard_for(key).unique_lock()->erase(key);
+    }
+
+    template <typename K>
+    bool contains(const K& key) const {
+        auto l = shard_for(key).shared_lock();
+        return l->find(key) != l->end();
+    }
+
+    template <typename K>
+    std::optional<mapped_type> get(const K& key) const {
+        auto l = shard_for(key).shared_lock();
+        auto f = l->find(key);
+        if (f == l->end()) return std::nullopt;
+        return f->second;
+    }
+
+    template <typename K, typename F>
+    bool visit(const K& key, F&& f) const {
+        auto l = shard_for(key).shared_lock();
+        auto found = l->find(key);
+        if (found == l->end()) return false;
+        f(found->second);
+        return true;
+    }
+
+    template <typename K, typename F>
+    bool modify(const K& key, F&& f) {
+        auto l = shard_for(key).unique_lock();
+        auto found = l->find(key);
+        if (found == l->end()) return false;
+        f(found->second);
+        return true;
+    }
+
+    template <typename Keys, typename F>
+    void find_many(const Keys& keys, F&& f) const {
+        std::vector<const typename Keys::value_type*> ptrs;
+        ptrs.reserve(keys.size());
+        for (auto& k : keys) ptrs.push_back(&k);
+
+        auto shard_of = [&](size_t i) { return shard_index(*ptrs[i]); };
+        for_each_shard_group(ptrs.size(), shard_of, [&](size_t si, const entry* begin, const entry* end) {
+            auto l = shard(si).shared_lock();
+            for (auto e = begin; e != end; ++e) {
+                auto found = l->find(*ptrs[e->index]);
+                f(e->index, found == l->end() ? nullptr : &found->second);
+            }
+        });
+    }
+
+    template <typename Keys>
+    std::vector<std::optional<mapped_type>> find_many(const Keys& keys) const {
+        std::vector<std::optional<mapped_type>> ret(keys.size());
+        find_many(keys, [&](size_t i, const mapped_type* value) {
+            if (value) ret[i] = *value;
+        });
+        return ret;
+    }
+
+    // elements are pairs (or anything with first and second)
+    // if a key is repeated, the first element with it wins
+    // the items are dereferenced after they're grouped, so this needs a multi-pass range
+    template <typename ForwardIterator>
+    size_t insert_many(ForwardIterator begin, ForwardIterator end) {
+        static_assert(std::is_base_of<std::forward_iterator_tag,
+            typename std::iterator_traits<ForwardIterator>::iterator_category>::value,
+            "insert_many requires forward iterators");
+        std::vector<ForwardIterator> items;
+        for (; begin != end; ++begin) items.push_back(begin);
+
+        auto shard_of = [&](size_t i) { return shard_index((*items[i]).first); };
+        size_t ret = 0;
+        for_each_shard_group(items.size(), shard_of, [&](size_t si, const entry* gbegin, const entry* gend) {
+            auto l = shard(si).unique_lock();
+            for (auto e = gbegin; e != gend; ++e) {
+                auto&& item = *items[e->index];
+                ret += l->try_emplace(std::forward<decltype(item)>(item).first,
+                    std::forward<decltype(item)>(item).second).second;
+            }
+        });
+        return ret;
+    }
+
+    template <typename Pairs>
+    size_t insert_many(const Pairs& items) {
+        using std::begin;
+        using std::end;
+        return insert_many(begin(items), end(items));
+    }
+
+    // the result is not a snapshot if the map is concurrently modified
+    size_t size() const {
+        size_t ret = 0;
+        for (size_t i = 0; i < m_num_shards; ++i) {
+            ret += shard(i).shared_lock()->size();
+        }
+        return ret;
+    }
+
+    bool empty() const {
+        for (size_t i = 0; i < m_num_shards; ++i) {
+            if (!shard(i).shared_lock()->empty()) return false;
+        }
+        return true;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < m_num_shards; ++i) {
+            shard(i).unique_lock()->clear();
+        }
+    }
+
+    // f(const key_type&, const mapped_type&) under a shared lock of each shard
+    template <typename F>
+    void for_each(F&& f) const {
+        for (size_t i = 0; i < m_num_shards; ++i) {
+            auto l = shard(i).shared_lock();
+            for (auto& elem : *l) {
+                f(elem.first, elem.second);
+            }
+        }
+    }
+
+private:
+    struct alignas(cache_line_size) shard_holder {
+        shard_type data;
+    };
+
+    struct entry {
+        size_t shard;
+        size_t index;
+        bool operator<(const entry& other) const {
+            return shard < other.shard || (shard == other.shard && index < other.index);
+        }
+    };
+
+    // sorts the indices of items by shard (keeping their order within a shard)
+    // and calls f(shard_index, begin, end) for each group
+    template <typename ShardOf, typename F>
+    void for_each_shard_group(size_t num_items, ShardOf&& shard_of, F&& f) const {
+        std::vector<entry> entries;
+        entries.reserve(num_items);
+        for (size_t i = 0; i < num_items; ++i) {
+            entries.push_back({shard_of(i), i});
+        }
+        std::sort(entries.begin(), entries.end());
+
+        auto gbegin = entries.data();
+        const auto eend = gbegin + entries.size();
+        while (gbegin != eend) {
+            auto gend = gbegin + 1;
+            while (gend != eend && gend->shard == gbegin->shard) ++gend;
+            f(gbegin->shard, gbegin, gend);
+            gbegin = gend;
+        }
+    }
+
+    hasher m_hash;
+    size_t m_num_shards = 1;
+    unsigned m_shard_bits = 0;
+    std::unique_ptr<shard_holder[]> m_shards;
+};
+
+#endif
+
 }
@@ -1,10 +1,10 @@
-// itlib-dynamic-bitset v1.02
+// itlib-dynamic-bitset v1.05
 //
 // A class similar to std::bitset but the size is not a part of the type
 //
 // SPDX-License-Identifier: MIT
 // MIT License:
-// Copyright(c) 2020-2021 Borislav Stanimirov
+// Copyright(c) 2020-2026 Borislav Stanimirov
 //
 // Permission is hereby granted, free of charge, to any person obtaining
 // a copy of this software and associated documentation files(the
@@ -28,6 +28,12 @@
 //
 //                  VERSION HISTORY
 //
+//  1.05 (2026-10-16) Added atomic_dynamic_bitset
+//  1.04 (2026-10-16) Added append from a word buffer, shift_left, shift_right
+//                    Amortized O(1) push_back
+//  1.03 (2026-10-16) Added count, find_first, find_next, set_range,
+//                    reset_range, andnot and bitwise assignment operators
+//                    Fixed all() for word types smaller than int
 //  1.02 (2021-01-29) Added copy
 //                    Added iterator +-num arithmetic
 //  1.01 (2021-01-28) Added assign
@@ -86,16 +92,37 @@
 //      set bit to value
 // * void flip(size_type i)
 //      flip bit
+// * size_type count() const noexcept
+//      number of true bits
+// * size_type find_first() const noexcept
+//      index of the first true bit or npos if there is none
+// * size_type find_next(size_type i) const noexcept
+//      index of the first true bit after i or npos if there is none
+// * void set_range(size_type from, size_type to)
+// * void reset_range(size_type from, size_type to)
+//      set bits in [from, to) to true or false
+// * dynamic_bitset& operator&=(const dynamic_bitset& other)
+// * dynamic_bitset& operator|=(const dynamic_bitset& other)
+// * dynamic_bitset& operator^=(const dynamic_bitset& other)
+// * dynamic_bitset& andnot(const dynamic_bitset& other)
+//      bitwise ops with a bitset of the same size (andnot is &= ~other)
 // * void assign(const Buffer&)
 //      set values from a given word-type buffer
 // * void append(const dynamic_bitset&)
 //      append an existing dynamic bitset to this one
+// * void append(const word_type* words, size_type bit_count)
+//      append the first bit_count bits of a word buffer (which must not be
+//      the buffer of this bitset)
 // * void reserve(size_type size)
 //      reserve buffer for size bits
 // * void resize(size_type size)
 //      resize to size bits
 // * void push_back(bool b)
-//      add bit and resize
+//      add bit (amortized O(1))
+// * void shift_left(size_type n)
+// * void shift_right(size_type n)
+//      move all bits n positions towards the higher (left) or lower (right)
+//      indices. The size doesn't change. Vacated bits become zero
 // * bool operator[](size_type i) const
 //      get bit at index
 // * bitref operator[](size_type i)
@@ -117,6 +144,30 @@
 // * static constexpr word_type word_mask(size_type index) noexcept
 //      mask representing a mask for a given bit within its word
 //
+// The bulk operations (count, find_*, *_range, and the bitwise ops) work on
+// whole words (with popcount and count-trailing-zeroes intrinsics where
+// available) and are much faster than going bit by bit.
+//
+// The library also defines itlib::atomic_dynamic_bitset<Word = uint64_t>.
+// It's a bitset whose size is fixed on construction and whose bits can be
+// modified concurrently from multiple threads. The words are std::atomic<Word>
+// and all single-bit operations take an optional std::memory_order argument
+// (std::memory_order_seq_cst by default):
+// * bool test(size_type i, order) const
+// * void set(size_type i, order)
+// * void reset(size_type i, order)
+// * bool flip(size_type i, order)
+// * bool test_and_set(size_type i, order)
+// * bool test_and_reset(size_type i, order)
+//      flip, test_and_set and test_and_reset return the previous value.
+//      test_and_set and test_and_reset first load the word and skip the
+//      read-modify-write if the bit already has the desired value. Thus
+//      repeatedly marking the same bits (as in parallel graph traversals)
+//      doesn't bounce cache lines between cores
+// The functions size, word_size, count, any, none, find_first, find_next,
+// and reset_all (reset all bits) are also available. The bulk functions go
+// through the words one by one. They are not atomic as a whole
+//
 //
 //                  TESTS
 //
@@ -126,12 +177,60 @@
 #pragma once
 
 #include <cstdint>
+#include <cstddef>
 #include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <atomic>
+#include <memory>
 #include <cassert>
 
+#if defined(__GNUC__)
+// builtins
+#elif __cplusplus >= 202000
+#   include <bit>
+#elif defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
 namespace itlib {
 
 namespace impl {
+
+template <typename Word>
+unsigned dynamic_bitset_popcount(Word w) noexcept
+{
+#if defined(__GNUC__)
+    return unsigned(__builtin_popcountll((unsigned long long)w));
+#elif __cplusplus >= 202000
+    return unsigned(std::popcount(w));
+#else
+    unsigned ret = 0;
+    for (; w; w &= Word(w - 1)) ++ret;
+    return ret;
+#endif
+}
+
+// w must not be zero
+template <typename Word>
+unsigned dynamic_bitset_ctz(Word w) noexcept
+{
+    assert(w);
+#if defined(__GNUC__)
+    return unsigned(__builtin_ctzll((unsigned long long)w));
+#elif __cplusplus >= 202000
+    return unsigned(std::countr_zero(w));
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long ret;
+    _BitScanForward64(&ret, (unsigned long long)w);
+    return unsigned(ret);
+#else
+    unsigned ret = 0;
+    for (; !(w & 1); w >>= 1) ++ret;
+    return ret;
+#endif
+}
+
 struct dynamic_bitset_iterator_base
 {
     explicit dynamic_bitset_iterator_base(size_t i) noexcept : index(i) {}
@@ -154,6 +253,8 @@ public:
     using size_type = size_t;
     using buffer_size_type = typename buffer_type::size_type;
     static constexpr uint8_t bits_per_word = sizeof(word_type) * 8;
+    static constexpr word_type all_ones = word_type(~word_type(0));
+    static constexpr size_type npos = size_type(-1);
 
     explicit dynamic_bitset(const allocator_type& alloc = allocator_type()) noexcept : m_buf(alloc), m_size(0) {}
     explicit dynamic_bitset(size_type size, word_type value = 0, const allocator_type& alloc = allocator_type())
@@ -199,7 +300,7 @@ public:
         auto endit = it + m_size / bits_per_word;
         for (; it != endit; ++it)
         {
-            if (*it != ~word_type(0)) return false;
+            if (*it != all_ones) return false;
         }
         if (endit != m_buf.end())
         {
@@ -251,22 +352,132 @@ public:
         m_buf[word_index(i)] ^= word_mask(i);
     }
 
+    // bulk ops
+    // the bits of the last word after the size are not guaranteed to be zero
+    // so they are masked out when reading
+    size_type count() const noexcept
+    {
+        const word_type* p = m_buf.data();
+        const auto full = m_size / bits_per_word;
+        size_type ret = 0;
+        for (size_type i = 0; i < full; ++i)
+        {
+            ret += impl::dynamic_bitset_popcount(p[i]);
+        }
+        if (auto pad = bit_index(m_size))
+        {
+            ret += impl::dynamic_bitset_popcount(word_type(p[full] & low_mask(pad)));
+        }
+        return ret;
+    }
+
+    size_type find_first() const noexcept
+    {
+        return find_from(0);
+    }
+
+    size_type find_next(size_type i) const noexcept
+    {
+        if (i >= m_size) return npos;
+        return find_from(i + 1);
+    }
+
+    void set_range(size_type from, size_type to)
+    {
+        assert(from <= to && to <= m_size);
+        if (from == to) return;
+        const auto fw = word_index(from);
+        const auto lw = word_index(to - 1);
+        const word_type head = word_type(all_ones << bit_index(from));
+        const word_type tail = low_mask(bit_index(to - 1) + 1);
+        if (fw == lw)
+        {
+            m_buf[fw] |= word_type(head & tail);
+            return;
+        }
+        m_buf[fw] |= head;
+        std::fill(m_buf.data() + fw + 1, m_buf.data() + lw, all_ones);
+        m_buf[lw] |= tail;
+    }
+
+    void reset_range(size_type from, size_type to)
+    {
+        assert(from <= to && to <= m_size);
+        if (from == to) return;
+        const auto fw = word_index(from);
+        const auto lw = word_index(to - 1);
+        const word_type head = word_type(all_ones << bit_index(from));
+        const word_type tail = low_mask(bit_index(to - 1) + 1);
+        if (fw == lw)
+        {
+            m_buf[fw] &= word_type(~(head & tail));
+            return;
+        }
+        m_buf[fw] &= word_type(~head);
+        std::fill(m_buf.data() + fw + 1, m_buf.data() + lw, word_type(0));
+        m_buf[lw] &= word_type(~tail);
+    }
+
+    dynamic_bitset& operator&=(const dynamic_bitset& other) noexcept
+    {
+        assert(m_size == other.m_size);
+        word_type* p = m_buf.data();
+        const word_type* o = other.m_buf.data();
+        for (size_t i = 0, e = m_buf.size(); i < e; ++i) p[i] &= o[i];
+        return *this;
+    }
+
+    dynamic_bitset& operator|=(const dynamic_bitset& other) noexcept
+    {
+        assert(m_size == other.m_size);
+        word_type* p = m_buf.data();
+        const word_type* o = other.m_buf.data();
+        for (size_t i = 0, e = m_buf.size(); i < e; ++i) p[i] |= o[i];
+        return *this;
+    }
+
+    dynamic_bitset& operator^=(const dynamic_bitset& other) noexcept
+    {
+        assert(m_size == other.m_size);
+        word_type* p = m_buf.data();
+        const word_type* o = other.m_buf.data();
+        for (size_t i = 0, e = m_buf.size(); i < e; ++i) p[i] ^= o[i];
+        return *this;
+    }
+
+    // this &= ~other
+    dynamic_bitset& andnot(const dynamic_bitset& other) noexcept
+    {
+        assert(m_size == other.m_size);
+        word_type* p = m_buf.data();
+        const word_type* o = other.m_buf.data();
+        for (size_t i = 0, e = m_buf.size(); i < e; ++i) p[i] &= word_type(~o[i]);
+        return *this;
+    }
+
     // size modifiers
     void reserve(size_type size) { m_buf.reserve(word_size(size)); }
     void resize(size_type size)
     {
-        auto pad = m_size % bits_per_word;
-        if (pad) {
-            // clear the tail of the buf with zeroes in case they remain from previous ops
-            m_buf.back() &= word_mask(pad) - 1;
-        }
+        // clear the tail of the buf with zeroes in case they remain from previous ops
+        clear_tail();
         m_size = size;
         m_buf.resize(word_size(size));
     }
     void push_back(bool b)
     {
-        resize(m_size + 1);
-        set(m_size-1, b);
+        const auto bi = bit_index(m_size);
+        if (bi == 0)
+        {
+            m_buf.push_back(word_type(b));
+        }
+        else
+        {
+            // set the bit and clear the tail after it in one go
+            auto& back = m_buf.back();
+            back = word_type((back & low_mask(bi)) | (word_type(b) << bi));
+        }
+        ++m_size;
     }
 
     void assign(const buffer_type& buf)
@@ -277,30 +488,86 @@ public:
 
     void append(const dynamic_bitset& other)
     {
-        if (other.empty()) return;
+        if (&other == this)
+        {
+            const dynamic_bitset copy(other);
+            append(copy.data(), copy.size());
+            return;
+        }
+        append(other.data(), other.size());
+    }
 
-        const auto pad = m_size % bits_per_word;
+    // words must not point to the buffer of this bitset
+    void append(const word_type* words, size_type bit_count)
+    {
+        if (bit_count == 0) return;
+
+        const auto pad = bit_index(m_size);
+        const auto src_size = word_size(bit_count);
         if (pad == 0)
         {
             // lucky
-            m_buf.insert(m_buf.end(), other.m_buf.begin(), other.m_buf.end());
-            m_size += other.size();
+            m_buf.insert(m_buf.end(), words, words + src_size);
+            m_size += bit_count;
             return;
         }
 
-        auto back_buf_index = m_buf.size() - 1;
-        resize(m_size + other.m_size);
-        auto myi = m_buf.begin() + back_buf_index;
-        for (size_t i = 0; i<other.m_buf.size(); ++i)
+        clear_tail();
+        auto i = m_buf.size() - 1;
+        m_size += bit_count;
+        const auto new_size = word_size(m_size);
+        m_buf.resize(new_size);
+        word_type* p = m_buf.data();
+        for (size_t si = 0; si < src_size; ++si)
         {
-            auto cur = other.m_buf[i];
-            *myi |= cur << pad;
-            ++myi;
-            if (myi == m_buf.end()) break;
-            *myi = cur >> (bits_per_word - pad);
+            const word_type cur = words[si];
+            p[i] |= word_type(cur << pad);
+            if (++i == new_size) break;
+            p[i] = word_type(cur >> (bits_per_word - pad));
         }
     }
 
+    void shift_left(size_type n)
+    {
+        const auto size = m_buf.size();
+        word_type* p = m_buf.data();
+        if (n >= m_size)
+        {
+            std::fill(p, p + size, word_type(0));
+            return;
+        }
+        const auto ws = size_t(word_index(n));
+        const auto bs = bit_index(n);
+        for (size_t i = size; i-- > ws; )
+        {
+            word_type w = word_type(p[i - ws] << bs);
+            if (bs && i > ws) w |= word_type(p[i - ws - 1] >> (bits_per_word - bs));
+            p[i] = w;
+        }
+        std::fill(p, p + ws, word_type(0));
+    }
+
+    void shift_right(size_type n)
+    {
+        const auto size = m_buf.size();
+        word_type* p = m_buf.data();
+        if (n >= m_size)
+        {
+            std::fill(p, p + size, word_type(0));
+            return;
+        }
+        clear_tail(); // the tail would be shifted in
+        const auto ws = size_t(word_index(n));
+        const auto bs = bit_index(n);
+        for (size_t i = 0; i + ws < size; ++i)
+        {
+            word_type w = word_type(p[i + ws] >> bs);
+            if (bs && i + ws + 1 < size) w |= word_type(p[i + ws + 1] << (bits_per_word - bs));
+            p[i] = w;
+        }
+        std::fill(p + (size - ws), p + size, word_type(0));
+    }
+
     // vector-like
     struct bitref
     {
@@ -427,8 +694,212 @@ public:
     }
 
 private:
+    // mask of the lowest n bits of a word (n <= bits_per_word)
+    static constexpr word_type low_mask(size_type n) noexcept
+    {
+        return n >= bits_per_word ? all_ones : word_type((word_type(1) << n) - 1);
+    }
+
+    // zero the bits of the last word after the size
+    void clear_tail() noexcept
+    {
+        if (auto pad = bit_index(m_size))
+        {
+            m_buf.back() &= low_mask(pad);
+        }
+    }
+
+    size_type find_from(size_type i) const noexcept
+    {
+        if (i >= m_size) return npos;
+        const word_type* p = m_buf.data();
+        auto w = word_index(i);
+        const auto e = m_buf.size();
+        word_type cur = word_type(p[w] & (all_ones << bit_index(i)));
+        while (!cur)
+        {
+            if (++w == e) return npos;
+            cur = p[w];
+        }
+        const auto ret = size_type(w) * bits_per_word + impl::dynamic_bitset_ctz(cur);
+        return ret < m_size ? ret : npos;
+    }
+
     buffer_type m_buf;
     size_type m_size; // doesn't need to be divisible by bits_per_word
 };
 
+#if __cplusplus < 201700
+template <typename Buffer>
+constexpr typename dynamic_bitset<Buffer>::word_type dynamic_bitset<Buffer>::all_ones;
+template <typename Buffer>
+constexpr typename dynamic_bitset<Buffer>::size_type dynamic_bitset<Buffer>::npos;
+#endif
+
+template <typename Word = uint64_t>
+class atomic_dynamic_bitset
+{
+public:
+    using word_type = Word;
+    static_assert(std::is_unsigned<word_type>::value, "word_type must be unsigned");
+    using size_type = size_t;
+    static constexpr uint8_t bits_per_word = sizeof(word_type) * 8;
+    static constexpr size_type npos = size_type(-1);
+
+    explicit atomic_dynamic_bitset(size_type size = 0)
+        : m_words(new std::atomic<word_type>[word_size(size)]()) // value-initialized with zeroes
+        , m_size(size)
+    {}
+
+    atomic_dynamic_bitset(const atomic_dynamic_bitset&) = delete;
+    atomic_dynamic_bitset& operator=(const atomic_dynamic_bitset&) = delete;
+
+    atomic_dynamic_bitset(atomic_dynamic_bitset&& x) noexcept
+        : m_words(std::move(x.m_words)), m_size(x.m_size)
+    {
+        x.m_size = 0;
+    }
+    atomic_dynamic_bitset& operator=(atomic_dynamic_bitset&& x) noexcept
+    {
+        m_words = std::move(x.m_words);
+        m_size = x.m_size;
+        x.m_size = 0;
+        return *this;
+    }
+
+    size_type size() const noexcept { return m_size; }
+    size_t word_size() const noexcept { return word_size(m_size); }
+
+    bool test(size_type i, std::memory_order order = std::memory_order_seq_cst) const noexcept
+    {
+        return word(i).load(order) & word_mask(i);
+    }
+
+    void set(size_type i, std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+        word(i).fetch_or(word_mask(i), order);
+    }
+
+    void reset(size_type i, std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+        word(i).fetch_and(word_type(~word_mask(i)), order);
+    }
+
+    bool flip(size_type i, std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+        return word(i).fetch_xor(word_mask(i), order) & word_mask(i);
+    }
+
+    bool test_and_set(size_type i, std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+        auto& w = word(i);
+        const auto mask = word_mask(i);
+        if (w.load(load_order(order)) & mask) return true;
+        return w.fetch_or(mask, order) & mask;
+    }
+
+    bool test_and_reset(size_type i, std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+        auto& w = word(i);
+        const auto mask = word_mask(i);
+        if (!(w.load(load_order(order)) & mask)) return false;
+        return w.fetch_and(word_type(~mask), order) & mask;
+    }
+
+    size_type count(std::memory_order order = std::memory_order_seq_cst) const noexcept
+    {
+        size_type ret = 0;
+        for (size_t i = 0, e = word_size(); i < e; ++i)
+        {
+            ret += impl::dynamic_bitset_popcount(m_words[i].load(order));
+        }
+        return ret;
+    }
+
+    bool any(std::memory_order order = std::memory_order_seq_cst) const noexcept
+    {
+        for (size_t i = 0, e = word_size(); i < e; ++i)
+        {
+            if (m_words[i].load(order)) return true;
+        }
+        return false;
+    }
+
+    bool none(std::memory_order order = std::memory_order_seq_cst) const noexcept { return !any(order); }
+
+    size_type find_first(std::memory_order order = std::memory_order_seq_cst) const noexcept
+    {
+        return find_from(0, order);
+    }
+
+    size_type find_next(size_type i, std::memory_order order = std::memory_order_seq_cst) const noexcept
+    {
+        if (i >= m_size) return npos;
+        return find_from(i + 1, order);
+    }
+
+    void reset_all(std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+        for (size_t i = 0, e = word_size(); i < e; ++i)
+        {
+            m_words[i].store(0, order);
+        }
+    }
+
+    static constexpr size_t word_size(size_type size) noexcept
+    {
+        return (size + bits_per_word - 1) / bits_per_word;
+    }
+    static constexpr size_t word_index(size_type i) noexcept
+    {
+        return i / bits_per_word;
+    }
+    static constexpr word_type word_mask(size_type i) noexcept
+    {
+        return word_type(word_type(1) << (i % bits_per_word));
+    }
+
+private:
+    std::atomic<word_type>& word(size_type i) const noexcept
+    {
+        assert(i < m_size);
+        return m_words[word_index(i)];
+    }
+
+    // the strongest order allowed for a load
+    static std::memory_order load_order(std::memory_order order) noexcept
+    {
+        switch (order)
+        {
+        case std::memory_order_release: return std::memory_order_relaxed;
+        case std::memory_order_acq_rel: return std::memory_order_acquire;
+        default: return order;
+        }
+    }
+
+    size_type find_from(size_type i, std::memory_order order) const noexcept
+    {
+        if (i >= m_size) return npos;
+        auto w = word_index(i);
+        const auto e = word_size();
+        const word_type ones = word_type(~word_type(0));
+        word_type cur = word_type(m_words[w].load(order) & word_type(ones << (i % bits_per_word)));
+        while (!cur)
+        {
+            if (++w == e) return npos;
+            cur = m_words[w].load(order);
+        }
+        return size_type(w) * bits_per_word + impl::dynamic_bitset_ctz(cur);
+    }
+
+    // the bits after the size are always zero
+    std::unique_ptr<std::atomic<word_type>[]> m_words;
+    size_type m_size;
+};
+
+#if __cplusplus < 201700
+template <typename Word>
+constexpr typename atomic_dynamic_bitset<Word>::size_type atomic_dynamic_bitset<Word>::npos;
+#endif
+
 }
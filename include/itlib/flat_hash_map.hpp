@@ -0,0 +1,1191 @@
+// itlib-flat_hash_map v1.00
+//
+// An open-addressing hash map with the interface of std::unordered_map
+//
+// SPDX-License-Identifier: MIT
+// MIT License:
+// Copyright(c) 2026 Borislav Stanimirov
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files(the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and / or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions :
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//
+//                  VERSION HISTORY
+//
+//  1.00 (2026-10-16) Initial release
+//
+//
+//                  DOCUMENTATION
+//
+// Simply include this file wherever you need.
+// It defines the class itlib::flat_hash_map. It has the interface of
+// std::unordered_map (minus the bucket interface), but it's implemented as an
+// open-addressing hash table with the elements stored in a single array.
+// Thus there is no allocation per element and lookups don't chase pointers.
+//
+// The implementation follows the design of Abseil's "Swiss tables". Besides
+// the array of elements there is an array of control bytes, one per element,
+// which tells whether the slot is empty, deleted, or full. For full slots it
+// holds 7 bits of the element's hash. A lookup loads a group of control bytes
+// (16 with SSE2, 8 otherwise) and compares all of them with the hash bits at
+// once. Keys are compared only for the matches, which are almost always the
+// element being looked up or nothing. The maximum load factor is 7/8.
+//
+// Like transparent_umap, it has transparent overloads of all lookup
+// functions, as well as of:
+//
+// * try_emplace()
+// * insert_or_assign()
+// * operator[]
+// * at()
+// * erase()
+//
+// They are enabled if both Hash and KeyEqual have the type is_transparent.
+// Thus `find` in a map with std::string keys can work with std::string_view
+// without creating a temporary string.
+//
+// Differences from std::unordered_map:
+// * Inserts which cause a rehash invalidate all iterators and references to
+// elements. Call reserve() beforehand if you need stable references.
+// * erase() doesn't invalidate other iterators and references
+// * The elements are moved when the table grows if their keys and values are
+// nothrow move-constructible and the hasher is noexcept. Otherwise they are
+// copied. If copying or hashing throws, the map remains unchanged. Move-only
+// keys and values are always moved. With a move-only key, the value is also
+// moved unless its copy is noexcept. The map remains unchanged only if the
+// moves are noexcept.
+// * The hash is mixed with a multiplication, so identity hashes, like the
+// ones std::hash usually has for integers, are fine.
+// * There is no bucket interface. bucket_count() returns the number of slots.
+// * max_load_factor can't be changed
+//
+// Define ITLIB_FLAT_HASH_MAP_NO_SIMD before including the header to use the
+// portable 8-byte groups even if SSE2 is available.
+//
+//
+//                  TESTS
+//
+// You can find unit tests in the official repo:
+// https://github.com/iboB/itlib/blob/master/test/
+//
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if !defined(ITLIB_FLAT_HASH_MAP_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#   define I_ITLIB_FLAT_HASH_MAP_SSE2 1
+#   include <emmintrin.h>
+#else
+#   define I_ITLIB_FLAT_HASH_MAP_SSE2 0
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#   include <intrin.h>
+#endif
+
+namespace itlib {
+
+namespace fhmimpl {
+
+template <typename T, typename = void>
+struct is_transparent : std::false_type {};
+template <typename T>
+struct is_transparent<T, std::void_t<typename T::is_transparent>> : std::true_type {};
+
+// control bytes
+// full slots have 7 bits of the hash (so the byte is non-negative)
+using ctrl_t = int8_t;
+constexpr ctrl_t ctrl_empty = -128;
+constexpr ctrl_t ctrl_deleted = -2;
+constexpr ctrl_t ctrl_sentinel = -1; // marks the end for iterators
+
+inline bool is_full(ctrl_t c) { return c >= 0; }
+
+// x must not be zero
+inline unsigned ctz(uint64_t x) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long r;
+#   if defined(_M_X64) || defined(_M_ARM64)
+    _BitScanForward64(&r, x);
+#   else
+    if (_BitScanForward(&r, uint32_t(x))) return unsigned(r);
+    _BitScanForward(&r, uint32_t(x >> 32));
+    r += 32;
+#   endif
+    return unsigned(r);
+#else
+    return unsigned(__builtin_ctzll(x));
+#endif
+}
+
+inline unsigned clz(uint64_t x) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long r;
+#   if defined(_M_X64) || defined(_M_ARM64)
+    _BitScanReverse64(&r, x);
+#   else
+    if (_BitScanReverse(&r, uint32_t(x >> 32))) r += 32;
+    else _BitScanReverse(&r, uint32_t(x));
+#   endif
+    return 63 - unsigned(r);
+#else
+    return unsigned(__builtin_clzll(x));
+#endif
+}
+
+// positions in a group which match something
+// each position is represented by 2^Shift bits of the mask
+// iterating it produces the matching positions
+template <unsigned Width, unsigned Shift>
+class bitmask {
+public:
+    explicit bitmask(uint64_t mask) : m_mask(mask) {}
+
+    explicit operator bool() const { return m_mask != 0; }
+
+    // these require a non-empty mask
+    unsigned lowest() const { return ctz(m_mask) >> Shift; }
+    unsigned trailing_zeros() const { return ctz(m_mask) >> Shift; }
+    unsigned leading_zeros() const {
+        constexpr unsigned extra_bits = 64 - (Width << Shift);
+        return (clz(m_mask) - extra_bits) >> Shift;
+    }
+
+    unsigned operator*() const { return lowest(); }
+    bitmask& operator++() {
+        m_mask &= m_mask - 1;
+        return *this;
+    }
+    bool operator!=(const bitmask& other) const { return m_mask != other.m_mask; }
+
+    bitmask begin() const { return *this; }
+    bitmask end() const { return bitmask(0); }
+private:
+    uint64_t m_mask;
+};
+
+#if I_ITLIB_FLAT_HASH_MAP_SSE2
+class group {
+public:
+    static constexpr size_t width = 16;
+    using mask = bitmask<16, 0>;
+
+    explicit group(const ctrl_t* pos) : m_ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) {}
+
+    mask match(ctrl_t h2) const {
+        return mask(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), m_ctrl))));
+    }
+
+    mask match_empty() const {
+        return match(ctrl_empty);
+    }
+
+    mask match_empty_or_deleted() const {
+        return mask(uint32_t(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(ctrl_sentinel), m_ctrl))));
+    }
+
+    // number of consecutive empty or deleted slots at the start of the group
+    unsigned count_leading_empty_or_deleted() const {
+        const uint32_t m = uint32_t(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(ctrl_sentinel), m_ctrl)));
+        return ctz(uint64_t(m) + 1);
+    }
+private:
+    __m128i m_ctrl;
+};
+#else
+class group {
+public:
+    static constexpr size_t width = 8;
+    using mask = bitmask<8, 3>;
+
+    explicit group(const ctrl_t* pos) {
+        std::memcpy(&m_ctrl, pos, sizeof(m_ctrl));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        m_ctrl = __builtin_bswap64(m_ctrl);
+#endif
+    }
+
+    // may have false positives in bytes after a true one, which is fine,
+    // since the keys of all matches are compared
+    mask match(ctrl_t h2) const {
+        const uint64_t x = m_ctrl ^ (lsbs * uint8_t(h2));
+        return mask((x - lsbs) & ~x & msbs);
+    }
+
+    // the high bit is set for empty, deleted, and sentinel
+    // bit 1 is only zero for empty, and bit 0 is only one for sentinel
+    mask match_empty() const {
+        return mask(m_ctrl & (~m_ctrl << 6) & msbs);
+    }
+
+    mask match_empty_or_deleted() const {
+        return mask(m_ctrl & ~(m_ctrl << 7) & msbs);
+    }
+
+    unsigned count_leading_empty_or_deleted() const {
+        constexpr uint64_t gaps = 0x00FEFEFEFEFEFEFEull;
+        return (ctz(((~m_ctrl & (m_ctrl >> 7)) | gaps) + 1) + 7) >> 3;
+    }
+private:
+    static constexpr uint64_t lsbs = 0x0101010101010101ull;
+    static constexpr uint64_t msbs = 0x8080808080808080ull;
+    uint64_t m_ctrl;
+};
+#endif
+
+// the control bytes of tables with no capacity
+// a lookup in it finds an empty slot and an iteration stops at the start
+inline ctrl_t* empty_group() {
+    alignas(16) static ctrl_t g[16] = {
+        ctrl_sentinel, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty,
+        ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty,
+    };
+    return g;
+}
+
+// std::hash of integers is often the identity, so the bits are spread
+inline size_t mix(size_t h) {
+    const uint64_t m = uint64_t(h) * 0x9E3779B97F4A7C15ull;
+    return size_t(m ^ (m >> 32));
+}
+inline size_t h1(size_t hash) { return hash >> 7; }
+inline ctrl_t h2(size_t hash) { return ctrl_t(hash & 0x7F); }
+
+// triangular probing over groups
+// capacity is 2^n-1, so it visits every group once
+class probe_seq {
+public:
+    probe_seq(size_t hash, size_t mask) : m_mask(mask), m_offset(h1(hash) & mask) {}
+    size_t offset() const { return m_offset; }
+    size_t offset(size_t i) const { return (m_offset + i) & m_mask; }
+    void next() {
+        m_index += group::width;
+        m_offset = (m_offset + m_index) & m_mask;
+    }
+private:
+    size_t m_mask;
+    size_t m_offset;
+    size_t m_index = 0;
+};
+
+// capacities are 2^n-1 and at least one slot is always empty
+constexpr size_t min_capacity = 15;
+inline size_t capacity_to_growth(size_t cap) { return cap - cap / 8; }
+inline size_t growth_to_capacity(size_t growth) {
+    size_t cap = min_capacity;
+    while (capacity_to_growth(cap) < growth) cap = cap * 2 + 1;
+    return cap;
+}
+
+} // namespace fhmimpl
+
+template <
+    typename Key,
+    typename T,
+    typename Hash = std::hash<Key>,
+    typename KeyEqual = std::equal_to<Key>,
+    typename Alloc = std::allocator<std::pair<const Key, T>>
+> class flat_hash_map {
+    using group = fhmimpl::group;
+    using ctrl_t = fhmimpl::ctrl_t;
+    using alloc_traits = std::allocator_traits<Alloc>;
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<const Key, T>;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using allocator_type = Alloc;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = typename alloc_traits::pointer;
+    using const_pointer = typename alloc_traits::const_pointer;
+
+    static_assert(std::is_same<typename alloc_traits::value_type, value_type>::value,
+        "flat_hash_map allocator must be for std::pair<const Key, T>");
+    static_assert(std::is_same<pointer, value_type*>::value,
+        "flat_hash_map doesn't support fancy pointers");
+
+    template <typename V>
+    class iterator_t {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename flat_hash_map::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = V*;
+        using reference = V&;
+
+        iterator_t() = default;
+
+        // const_iterator from iterator
+        template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, V*>>>
+        iterator_t(const iterator_t<U>& other) : m_ctrl(other.m_ctrl), m_slot(other.m_slot) {}
+
+        reference operator*() const { return *m_slot; }
+        pointer operator->() const { return m_slot; }
+
+        iterator_t& operator++() {
+            ++m_ctrl;
+            ++m_slot;
+            skip_empty_or_deleted();
+            return *this;
+        }
+        iterator_t operator++(int) {
+            auto ret = *this;
+            ++*this;
+            return ret;
+        }
+
+        template <typename U>
+        bool operator==(const iterator_t<U>& other) const { return m_ctrl == other.m_ctrl; }
+        template <typename U>
+        bool operator!=(const iterator_t<U>& other) const { return m_ctrl != other.m_ctrl; }
+    private:
+        friend class flat_hash_map;
+        template <typename> friend class iterator_t;
+
+        iterator_t(const ctrl_t* ctrl, V* slot) : m_ctrl(ctrl), m_slot(slot) {}
+
+        // the sentinel at the end stops this
+        void skip_empty_or_deleted() {
+            while (*m_ctrl < fhmimpl::ctrl_sentinel) {
+                const auto shift = group(m_ctrl).count_leading_empty_or_deleted();
+                m_ctrl += shift;
+                m_slot += shift;
+            }
+        }
+
+        const ctrl_t* m_ctrl = nullptr;
+        V* m_slot = nullptr;
+    };
+
+    using iterator = iterator_t<value_type>;
+    using const_iterator = iterator_t<const value_type>;
+
+private:
+    // enable if transparent
+    template <typename K, typename R>
+    using enable_if_tr = std::enable_if_t<
+        fhmimpl::is_transparent<Hash>::value
+        && fhmimpl::is_transparent<KeyEqual>::value
+        // but not iterators
+        && !std::is_convertible_v<K, iterator>
+        && !std::is_convertible_v<K, const_iterator>
+        , R
+    >;
+
+    // enable if transparent and a key can be constructed
+    template <typename K, typename R>
+    using enable_if_tr_c = enable_if_tr<K, std::enable_if_t<std::is_constructible_v<Key, K&&>, R>>;
+
+    static constexpr size_t npos = size_t(-1);
+
+public:
+    flat_hash_map() noexcept(std::is_nothrow_default_constructible_v<Hash>
+        && std::is_nothrow_default_constructible_v<KeyEqual>
+        && std::is_nothrow_default_constructible_v<Alloc>)
+        : m_hash(), m_eq(), m_alloc()
+    {}
+
+    explicit flat_hash_map(size_type bucket_count, const Hash& hash = Hash(), const KeyEqual& eq = KeyEqual(), const Alloc& alloc = Alloc())
+        : m_hash(hash), m_eq(eq), m_alloc(alloc)
+    {
+        if (bucket_count) reserve(bucket_count);
+    }
+
+    flat_hash_map(size_type bucket_count, const Alloc& alloc)
+        : flat_hash_map(bucket_count, Hash(), KeyEqual(), alloc)
+    {}
+
+    explicit flat_hash_map(const Alloc& alloc)
+        : flat_hash_map(0, Hash(), KeyEqual(), alloc)
+    {}
+
+    template <typename InputIterator>
+    flat_hash_map(InputIterator first, InputIterator last, size_type bucket_count = 0, const Hash& hash = Hash(), const KeyEqual& eq = KeyEqual(), const Alloc& alloc = Alloc())
+        : flat_hash_map(bucket_count, hash, eq, alloc)
+    {
+        insert(first, last);
+    }
+
+    flat_hash_map(std::initializer_list<value_type> init, size_type bucket_count = 0, const Hash& hash = Hash(), const KeyEqual& eq = KeyEqual(), const Alloc& alloc = Alloc())
+        : flat_hash_map(bucket_count ? bucket_count : init.size(), hash, eq, alloc)
+    {
+        insert(init);
+    }
+
+    flat_hash_map(const flat_hash_map& other)
+        : flat_hash_map(other, alloc_traits::select_on_container_copy_construction(other.m_alloc))
+    {}
+
+    flat_hash_map(const flat_hash_map& other, const Alloc& alloc)
+        : flat_hash_map(other.size(), other.m_hash, other.m_eq, alloc)
+    {
+        for (auto& v : other) {
+            insert_unique(hash_of(v.first), v);
+        }
+    }
+
+    flat_hash_map(flat_hash_map&& other) noexcept
+        : m_ctrl(other.m_ctrl)
+        , m_slots(other.m_slots)
+        , m_capacity(other.m_capacity)
+        , m_size(other.m_size)
+        , m_growth_left(other.m_growth_left)
+        , m_hash(std::move(other.m_hash))
+        , m_eq(std::move(other.m_eq))
+        , m_alloc(std::move(other.m_alloc))
+    {
+        other.reset_storage();
+    }
+
+    flat_hash_map(flat_hash_map&& other, const Alloc& alloc)
+        : flat_hash_map(0, other.m_hash, other.m_eq, alloc)
+    {
+        if (m_alloc == other.m_alloc) {
+            steal(other);
+        }
+        else {
+            move_elements_from(other);
+        }
+    }
+
+    ~flat_hash_map() {
+        destroy_and_deallocate();
+    }
+
+    flat_hash_map& operator=(const flat_hash_map& other) {
+        if (this == &other) return *this;
+        clear();
+        if (alloc_traits::propagate_on_container_copy_assignment::value && m_alloc != other.m_alloc) {
+            destroy_and_deallocate();
+            reset_storage();
+            m_alloc = other.m_alloc;
+        }
+        m_hash = other.m_hash;
+        m_eq = other.m_eq;
+        reserve(other.size());
+        for (auto& v : other) {
+            insert_unique(hash_of(v.first), v);
+        }
+        return *this;
+    }
+
+    flat_hash_map& operator=(flat_hash_map&& other) noexcept(alloc_traits::is_always_equal::value
+        || alloc_traits::propagate_on_container_move_assignment::value)
+    {
+        if (this == &other) return *this;
+        m_hash = std::move(other.m_hash);
+        m_eq = std::move(other.m_eq);
+        if (alloc_traits::propagate_on_container_move_assignment::value || m_alloc == other.m_alloc) {
+            destroy_and_deallocate();
+            if (alloc_traits::propagate_on_container_move_assignment::value) {
+                m_alloc = std::move(other.m_alloc);
+            }
+            steal(other);
+        }
+        else {
+            clear();
+            move_elements_from(other);
+        }
+        return *this;
+    }
+
+    flat_hash_map& operator=(std::initializer_list<value_type> init) {
+        clear();
+        insert(init);
+        return *this;
+    }
+
+    allocator_type get_allocator() const { return m_alloc; }
+    hasher hash_function() const { return m_hash; }
+    key_equal key_eq() const { return m_eq; }
+
+    // iterators
+
+    iterator begin() noexcept {
+        iterator ret(m_ctrl, m_slots);
+        ret.skip_empty_or_deleted();
+        return ret;
+    }
+    const_iterator begin() const noexcept {
+        const_iterator ret(m_ctrl, m_slots);
+        ret.skip_empty_or_deleted();
+        return ret;
+    }
+    const_iterator cbegin() const noexcept { return begin(); }
+
+    iterator end() noexcept { return iterator_at(m_capacity); }
+    const_iterator end() const noexcept { return iterator_at(m_capacity); }
+    const_iterator cend() const noexcept { return end(); }
+
+    // capacity
+
+    bool empty() const noexcept { return m_size == 0; }
+    size_type size() const noexcept { return m_size; }
+    size_type max_size() const noexcept { return alloc_traits::max_size(m_alloc); }
+
+    // number of slots
+    size_type bucket_count() const noexcept { return m_capacity; }
+    size_type capacity() const noexcept { return m_capacity; }
+
+    float load_factor() const noexcept { return m_capacity ? float(m_size) / float(m_capacity) : 0.f; }
+    float max_load_factor() const noexcept { return 0.875f; }
+
+    // makes room for count elements without a rehash
+    void reserve(size_type count) {
+        if (count > m_size + m_growth_left) {
+            resize(fhmimpl::growth_to_capacity(count));
+        }
+    }
+
+    // rebuilds the table with room for at least count elements (and the ones in it)
+    // rehash(0) shrinks the table to fit the size and drops the deleted slots
+    void rehash(size_type count) {
+        if (count == 0 && m_size == 0) {
+            destroy_and_deallocate();
+            reset_storage();
+            return;
+        }
+        resize(fhmimpl::growth_to_capacity(count > m_size ? count : m_size));
+    }
+
+    // modifiers
+
+    void clear() noexcept {
+        if (!m_capacity) return;
+        destroy_elements();
+        reset_ctrl();
+        m_size = 0;
+        m_growth_left = fhmimpl::capacity_to_growth(m_capacity);
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value) {
+        return insert_value(value.first, value);
+    }
+
+    std::pair<iterator, bool> insert(value_type&& value) {
+        return insert_value(value.first, std::move(value));
+    }
+
+    template <typename P, typename = std::enable_if_t<std::is_constructible_v<value_type, P&&>>>
+    std::pair<iterator, bool> insert(P&& value) {
+        return emplace(std::forward<P>(value));
+    }
+
+    iterator insert(const_iterator, const value_type& value) {
+        return insert(value).first;
+    }
+
+    iterator insert(const_iterator, value_type&& value) {
+        return insert(std::move(value)).first;
+    }
+
+    template <typename InputIterator>
+    void insert(InputIterator first, InputIterator last) {
+        for (; first != last; ++first) {
+            emplace(*first);
+        }
+    }
+
+    void insert(std::initializer_list<value_type> init) {
+        insert(init.begin(), init.end());
+    }
+
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(const key_type& key, M&& obj) {
+        return assign_or_emplace(key, std::forward<M>(obj));
+    }
+
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(key_type&& key, M&& obj) {
+        return assign_or_emplace(std::move(key), std::forward<M>(obj));
+    }
+
+    template <typename K, typename M>
+    enable_if_tr_c<K, std::pair<iterator, bool>> insert_or_assign(K&& key, M&& obj) {
+        return assign_or_emplace(std::forward<K>(key), std::forward<M>(obj));
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        return emplace_value(std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    iterator emplace_hint(const_iterator, Args&&... args) {
+        return emplace(std::forward<Args>(args)...).first;
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args) {
+        return find_or_emplace(key, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(key_type&& key, Args&&... args) {
+        return find_or_emplace(std::move(key), std::forward<Args>(args)...);
+    }
+
+    template <typename K, typename... Args>
+    enable_if_tr_c<K, std::pair<iterator, bool>> try_emplace(K&& key, Args&&... args) {
+        return find_or_emplace(std::forward<K>(key), std::forward<Args>(args)...);
+    }
+
+    // the hint is pointless for hash maps, but it's here for compatibility
+    template <typename... Args>
+    iterator try_emplace(const_iterator, const key_type& key, Args&&... args) {
+        return try_emplace(key, std::forward<Args>(args)...).first;
+    }
+
+    template <typename... Args>
+    iterator try_emplace(const_iterator, key_type&& key, Args&&... args) {
+        return try_emplace(std::move(key), std::forward<Args>(args)...).first;
+    }
+
+    template <typename K, typename... Args>
+    enable_if_tr_c<K, iterator> try_emplace(const_iterator, K&& key, Args&&... args) {
+        return try_emplace(std::forward<K>(key), std::forward<Args>(args)...).first;
+    }
+
+    iterator erase(iterator pos) {
+        return erase(const_iterator(pos));
+    }
+
+    iterator erase(const_iterator pos) {
+        const size_t index = size_t(pos.m_slot - m_slots);
+        erase_at(index);
+        iterator ret = iterator_at(index);
+        ret.skip_empty_or_deleted();
+        return ret;
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        while (first != last) {
+            first = erase(first);
+        }
+        return iterator_at(size_t(last.m_slot - m_slots));
+    }
+
+    size_type erase(const key_type& key) {
+        return erase_key(key);
+    }
+
+    template <typename K>
+    enable_if_tr<K, size_type> erase(const K& key) {
+        return erase_key(key);
+    }
+
+    void swap(flat_hash_map& other) noexcept {
+        using std::swap;
+        swap(m_ctrl, other.m_ctrl);
+        swap(m_slots, other.m_slots);
+        swap(m_capacity, other.m_capacity);
+        swap(m_size, other.m_size);
+        swap(m_growth_left, other.m_growth_left);
+        swap(m_hash, other.m_hash);
+        swap(m_eq, other.m_eq);
+        if (alloc_traits::propagate_on_container_swap::value) {
+            swap(m_alloc, other.m_alloc);
+        }
+    }
+
+    // lookup
+
+    T& operator[](const key_type& key) {
+        return find_or_emplace(key).first->second;
+    }
+
+    T& operator[](key_type&& key) {
+        return find_or_emplace(std::move(key)).first->second;
+    }
+
+    template <typename K>
+    enable_if_tr_c<K, T&> operator[](K&& key) {
+        return find_or_emplace(std::forward<K>(key)).first->second;
+    }
+
+    T& at(const key_type& key) {
+        return at_impl(key);
+    }
+
+    const T& at(const key_type& key) const {
+        return at_impl(key);
+    }
+
+    template <typename K>
+    enable_if_tr<K, T&> at(const K& key) {
+        return at_impl(key);
+    }
+
+    template <typename K>
+    enable_if_tr<K, const T&> at(const K& key) const {
+        return at_impl(key);
+    }
+
+    iterator find(const key_type& key) {
+        return iterator_at_or_end(find_index(key, hash_of(key)));
+    }
+
+    const_iterator find(const key_type& key) const {
+        return iterator_at_or_end(find_index(key, hash_of(key)));
+    }
+
+    template <typename K>
+    enable_if_tr<K, iterator> find(const K& key) {
+        return iterator_at_or_end(find_index(key, hash_of(key)));
+    }
+
+    template <typename K>
+    enable_if_tr<K, const_iterator> find(const K& key) const {
+        return iterator_at_or_end(find_index(key, hash_of(key)));
+    }
+
+    size_type count(const key_type& key) const {
+        return contains(key);
+    }
+
+    template <typename K>
+    enable_if_tr<K, size_type> count(const K& key) const {
+        return contains(key);
+    }
+
+    bool contains(const key_type& key) const {
+        return find_index(key, hash_of(key)) != npos;
+    }
+
+    template <typename K>
+    enable_if_tr<K, bool> contains(const K& key) const {
+        return find_index(key, hash_of(key)) != npos;
+    }
+
+    std::pair<iterator, iterator> equal_range(const key_type& key) {
+        return make_range(find(key));
+    }
+
+    std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const {
+        return make_range(find(key));
+    }
+
+    template <typename K>
+    enable_if_tr<K, std::pair<iterator, iterator>> equal_range(const K& key) {
+        return make_range(find(key));
+    }
+
+    template <typename K>
+    enable_if_tr<K, std::pair<const_iterator, const_iterator>> equal_range(const K& key) const {
+        return make_range(find(key));
+    }
+
+    friend bool operator==(const flat_hash_map& a, const flat_hash_map& b) {
+        if (a.size() != b.size()) return false;
+        for (auto& v : a) {
+            auto f = b.find(v.first);
+            if (f == b.end() || !(f->second == v.second)) return false;
+        }
+        return true;
+    }
+
+    friend bool operator!=(const flat_hash_map& a, const flat_hash_map& b) {
+        return !(a == b);
+    }
+
+private:
+    template <typename K>
+    size_t hash_of(const K& key) const {
+        return fhmimpl::mix(m_hash(key));
+    }
+
+    iterator iterator_at(size_t index) {
+        return iterator(m_ctrl + index, m_slots + index);
+    }
+    const_iterator iterator_at(size_t index) const {
+        return const_iterator(m_ctrl + index, m_slots + index);
+    }
+    iterator iterator_at_or_end(size_t index) {
+        return iterator_at(index == npos ? m_capacity : index);
+    }
+    const_iterator iterator_at_or_end(size_t index) const {
+        return iterator_at(index == npos ? m_capacity : index);
+    }
+
+    template <typename It>
+    std::pair<It, It> make_range(It f) const {
+        if (f.m_ctrl == m_ctrl + m_capacity) return {f, f};
+        auto next = f;
+        ++next;
+        return {f, next};
+    }
+
+    // returns npos if the key is not in the map
+    template <typename K>
+    size_t find_index(const K& key, size_t hash) const {
+        fhmimpl::probe_seq seq(hash, m_capacity);
+        const ctrl_t h2 = fhmimpl::h2(hash);
+        while (true) {
+            group g(m_ctrl + seq.offset());
+            for (auto i : g.match(h2)) {
+                const size_t index = seq.offset(i);
+                if (m_eq(m_slots[index].first, key)) return index;
+            }
+            if (g.match_empty()) return npos;
+            seq.next();
+        }
+    }
+
+    size_t find_first_non_full(size_t hash) const {
+        fhmimpl::probe_seq seq(hash, m_capacity);
+        while (true) {
+            auto m = group(m_ctrl + seq.offset()).match_empty_or_deleted();
+            if (m) return seq.offset(m.lowest());
+            seq.next();
+        }
+    }
+
+    // returns the slot in which an element with this hash is to be constructed
+    // the slot is not marked as full until commit_insert
+    size_t prepare_insert(size_t hash) {
+        size_t index = find_first_non_full(hash);
+        // reusing a deleted slot doesn't consume growth
+        if (m_growth_left == 0 && m_ctrl[index] != fhmimpl::ctrl_deleted) {
+            grow();
+            index = find_first_non_full(hash);
+        }
+        return index;
+    }
+
+    void commit_insert(size_t index, size_t hash) {
+        ++m_size;
+        m_growth_left -= m_ctrl[index] == fhmimpl::ctrl_empty;
+        set_ctrl(index, fhmimpl::h2(hash));
+    }
+
+    // sets the byte and its clone after the sentinel
+    // the clones allow loading groups which start at the end of the table
+    void set_ctrl(size_t index, ctrl_t c) {
+        m_ctrl[index] = c;
+        m_ctrl[((index - (group::width - 1)) & m_capacity) + (group::width - 1)] = c;
+    }
+
+    template <typename... Args>
+    size_t construct_at(size_t hash, Args&&... args) {
+        const size_t index = prepare_insert(hash);
+        alloc_traits::construct(m_alloc, m_slots + index, std::forward<Args>(args)...);
+        commit_insert(index, hash);
+        return index;
+    }
+
+    // only for elements which are known not to be in the map
+    template <typename... Args>
+    void insert_unique(size_t hash, Args&&... args) {
+        construct_at(hash, std::forward<Args>(args)...);
+    }
+
+    template <typename K, typename V>
+    std::pair<iterator, bool> insert_value(const K& key, V&& value) {
+        const size_t hash = hash_of(key);
+        const size_t found = find_index(key, hash);
+        if (found != npos) return {iterator_at(found), false};
+        return {iterator_at(construct_at(hash, std::forward<V>(value))), true};
+    }
+
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> find_or_emplace(K&& key, Args&&... args) {
+        const size_t hash = hash_of(key);
+        const size_t found = find_index(key, hash);
+        if (found != npos) return {iterator_at(found), false};
+        const size_t index = construct_at(hash, std::piecewise_construct,
+            std::forward_as_tuple(std::forward<K>(key)),
+            std::forward_as_tuple(std::forward<Args>(args)...));
+        return {iterator_at(index), true};
+    }
+
+    template <typename K, typename M>
+    std::pair<iterator, bool> assign_or_emplace(K&& key, M&& obj) {
+        auto ret = find_or_emplace(std::forward<K>(key), std::forward<M>(obj));
+        if (!ret.second) ret.first->second = std::forward<M>(obj);
+        return ret;
+    }
+
+    // emplace with a key and a value is try_emplace
+    template <typename K, typename V>
+    std::enable_if_t<std::is_same_v<std::decay_t<K>, Key>, std::pair<iterator, bool>> emplace_value(K&& key, V&& value) {
+        return find_or_emplace(std::forward<K>(key), std::forward<V>(value));
+    }
+
+    template <typename K, typename V>
+    std::pair<iterator, bool> emplace_value(const std::pair<K, V>& value) {
+        return emplace_pair(value);
+    }
+
+    template <typename K, typename V>
+    std::pair<iterator, bool> emplace_value(std::pair<K, V>& value) {
+        return emplace_pair(value);
+    }
+
+    template <typename K, typename V>
+    std::pair<iterator, bool> emplace_value(std::pair<K, V>&& value) {
+        return emplace_pair(std::move(value));
+    }
+
+    // anything else needs a temporary to get the key
+    template <typename... Args>
+    std::pair<iterator, bool> emplace_value(Args&&... args) {
+        value_type tmp(std::forward<Args>(args)...);
+        return insert_value(tmp.first, std::move(tmp));
+    }
+
+    template <typename P>
+    std::pair<iterator, bool> emplace_pair(P&& p) {
+        using key_arg = decltype(std::get<0>(std::forward<P>(p)));
+        if constexpr (std::is_same_v<std::decay_t<key_arg>, Key>) {
+            return insert_value(p.first, std::forward<P>(p));
+        }
+        else {
+            value_type tmp(std::forward<P>(p));
+            return insert_value(tmp.first, std::move(tmp));
+        }
+    }
+
+    template <typename K>
+    const T& at_impl(const K& key) const {
+        const size_t index = find_index(key, hash_of(key));
+        if (index == npos) throw std::out_of_range("flat_hash_map::at");
+        return m_slots[index].second;
+    }
+
+    template <typename K>
+    T& at_impl(const K& key) {
+        return const_cast<T&>(static_cast<const flat_hash_map*>(this)->at_impl(key));
+    }
+
+    template <typename K>
+    size_type erase_key(const K& key) {
+        const size_t index = find_index(key, hash_of(key));
+        if (index == npos) return 0;
+        erase_at(index);
+        return 1;
+    }
+
+    void erase_at(size_t index) {
+        alloc_traits::destroy(m_alloc, m_slots + index);
+        --m_size;
+
+        // if no probe sequence could have passed over this slot while it was full,
+        // it can become empty, otherwise it must be marked as deleted so lookups
+        // continue past it
+        // a probe passes over it if there is a group with it and no empty slots
+        const size_t index_before = (index - group::width) & m_capacity;
+        const auto empty_after = group(m_ctrl + index).match_empty();
+        const auto empty_before = group(m_ctrl + index_before).match_empty();
+        const bool was_never_full = empty_before && empty_after
+            && (empty_after.trailing_zeros() + empty_before.leading_zeros()) < group::width;
+
+        set_ctrl(index, was_never_full ? fhmimpl::ctrl_empty : fhmimpl::ctrl_deleted);
+        m_growth_left += was_never_full;
+    }
+
+    void grow() {
+        // if more than a quarter of the slots are deleted, just drop them
+        if (m_capacity > fhmimpl::min_capacity && m_size * 32 <= m_capacity * 25) {
+            resize(m_capacity);
+        }
+        else {
+            resize(m_capacity ? m_capacity * 2 + 1 : fhmimpl::min_capacity);
+        }
+    }
+
+    // number of value_type-s which fit the control bytes
+    static size_t ctrl_units(size_t capacity) {
+        return (capacity + group::width + sizeof(value_type) - 1) / sizeof(value_type);
+    }
+
+    // the control bytes and the slots are in a single allocation of value_type-s
+    // (so the slots are aligned)
+    // there are capacity + width control bytes: one per slot, a sentinel, and width-1 clones
+    void resize(size_t new_capacity) {
+        const auto old_ctrl = m_ctrl;
+        const auto old_slots = m_slots;
+        const auto old_capacity = m_capacity;
+        const auto size = m_size;
+        const auto growth_left = m_growth_left;
+
+        // new indices of the old elements, to move them back if something throws
+        std::vector<size_t, typename alloc_traits::template rebind_alloc<size_t>> moved_to(m_alloc);
+        if constexpr (restore_key_on_throw || restore_value_on_throw) {
+            moved_to.resize(old_capacity, npos);
+        }
+
+        auto buf = alloc_traits::allocate(m_alloc, ctrl_units(new_capacity) + new_capacity);
+        m_ctrl = reinterpret_cast<ctrl_t*>(buf);
+        m_slots = buf + ctrl_units(new_capacity);
+        m_capacity = new_capacity;
+        reset_ctrl();
+        m_size = 0;
+        m_growth_left = fhmimpl::capacity_to_growth(new_capacity);
+
+        size_t i = 0;
+        try {
+            for (; i < old_capacity; ++i) {
+                if (!fhmimpl::is_full(old_ctrl[i])) continue;
+                auto& v = old_slots[i];
+                const size_t index = construct_at(hash_of(v.first), std::piecewise_construct,
+                    std::forward_as_tuple(relocated_key(v)),
+                    std::forward_as_tuple(relocated_value(v)));
+                if constexpr (restore_key_on_throw || restore_value_on_throw) {
+                    moved_to[i] = index;
+                }
+            }
+        }
+        catch (...) {
+            // copied keys and values are intact
+            // moved ones are moved back (without hashing, as the hasher may be what threw)
+            if constexpr (restore_key_on_throw || restore_value_on_throw) {
+                for (size_t j = 0; j < i; ++j) {
+                    if (moved_to[j] == npos) continue;
+                    auto& old = old_slots[j];
+                    auto& moved = m_slots[moved_to[j]];
+                    if constexpr (restore_key_on_throw) {
+                        auto& key = const_cast<Key&>(old.first);
+                        key.~Key();
+                        ::new (static_cast<void*>(std::addressof(key))) Key(std::move(const_cast<Key&>(moved.first)));
+                    }
+                    if constexpr (restore_value_on_throw) {
+                        old.second.~T();
+                        ::new (static_cast<void*>(std::addressof(old.second))) T(std::move(moved.second));
+                    }
+                }
+            }
+            destroy_and_deallocate();
+            m_ctrl = old_ctrl;
+            m_slots = old_slots;
+            m_capacity = old_capacity;
+            m_size = size;
+            m_growth_left = growth_left;
+            throw;
+        }
+
+        if (old_capacity) {
+            for (size_t j = 0; j < old_capacity; ++j) {
+                if (fhmimpl::is_full(old_ctrl[j])) {
+                    alloc_traits::destroy(m_alloc, old_slots + j);
+                }
+            }
+            alloc_traits::deallocate(m_alloc, reinterpret_cast<value_type*>(old_ctrl), ctrl_units(old_capacity) + old_capacity);
+        }
+    }
+
+    // elements are moved on resize if nothing can throw in the process
+    // otherwise keys and values are copied, so the old ones remain intact if something throws
+    // move-only keys and values are always moved. If their moves are noexcept, they are moved
+    // back when something throws. If not, there is no guarantee (as with std::vector)
+    // a moved key can't be restored if the construction of its value throws, so when the key
+    // is moved, so is the value, unless copying it can't throw
+    // keys are const in value_type, but the old elements are destroyed right after they're moved
+    // (the same is done by the node handles of std containers)
+    static constexpr bool move_on_resize = std::is_nothrow_move_constructible_v<Key>
+        && std::is_nothrow_move_constructible_v<T>
+        && std::is_nothrow_invocable_v<const Hash&, const Key&>;
+    static constexpr bool move_key_on_resize = move_on_resize || !std::is_copy_constructible_v<Key>;
+    static constexpr bool move_value_on_resize = move_on_resize || !std::is_copy_constructible_v<T>
+        || (move_key_on_resize && !std::is_nothrow_copy_constructible_v<T> && std::is_move_constructible_v<T>);
+    static constexpr bool restore_key_on_throw = !move_on_resize && move_key_on_resize
+        && std::is_nothrow_move_constructible_v<Key>;
+    static constexpr bool restore_value_on_throw = !move_on_resize && move_value_on_resize
+        && std::is_nothrow_move_constructible_v<T>;
+    using relocated_key_t = std::conditional_t<move_key_on_resize, Key&&, const Key&>;
+    using relocated_value_t = std::conditional_t<move_value_on_resize, T&&, const T&>;
+    static relocated_key_t relocated_key(value_type& v) noexcept {
+        return static_cast<relocated_key_t>(const_cast<Key&>(v.first));
+    }
+    static relocated_value_t relocated_value(value_type& v) noexcept {
+        return static_cast<relocated_value_t>(v.second);
+    }
+
+    void reset_ctrl() {
+        std::memset(m_ctrl, fhmimpl::ctrl_empty, m_capacity + group::width);
+        m_ctrl[m_capacity] = fhmimpl::ctrl_sentinel;
+    }
+
+    void destroy_elements() noexcept {
+        for (size_t i = 0; i < m_capacity; ++i) {
+            if (fhmimpl::is_full(m_ctrl[i])) {
+                alloc_traits::destroy(m_alloc, m_slots + i);
+            }
+        }
+    }
+
+    void destroy_and_deallocate() noexcept {
+        if (!m_capacity) return;
+        destroy_elements();
+        alloc_traits::deallocate(m_alloc, reinterpret_cast<value_type*>(m_ctrl), ctrl_units(m_capacity) + m_capacity);
+    }
+
+    void reset_storage() noexcept {
+        m_ctrl = fhmimpl::empty_group();
+        m_slots = nullptr;
+        m_capacity = 0;
+        m_size = 0;
+        m_growth_left = 0;
+    }
+
+    // storage must be empty
+    void steal(flat_hash_map& other) noexcept {
+        m_ctrl = other.m_ctrl;
+        m_slots = other.m_slots;
+        m_capacity = other.m_capacity;
+        m_size = other.m_size;
+        m_growth_left = other.m_growth_left;
+        other.reset_storage();
+    }
+
+    void move_elements_from(flat_hash_map& other) {
+        reserve(other.size());
+        for (auto& v : other) {
+            insert_unique(hash_of(v.first), std::piecewise_construct,
+                std::forward_as_tuple(relocated_key(v)),
+                std::forward_as_tuple(std::move(v.second)));
+        }
+        other.clear();
+    }
+
+    ctrl_t* m_ctrl = fhmimpl::empty_group();
+    value_type* m_slots = nullptr;
+    size_t m_capacity = 0;
+    size_t m_size = 0;
+    size_t m_growth_left = 0;
+
+    Hash m_hash;
+    KeyEqual m_eq;
+    Alloc m_alloc;
+};
+
+} // namespace itlib
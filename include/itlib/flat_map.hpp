@@ -1,11 +1,11 @@
-// itlib-flat-map v1.11
+// itlib-flat-map v1.14
 //
 // std::map-like class with an underlying vector
 //
 // SPDX-License-Identifier: MIT
 // MIT License:
 // Copyright(c) 2016-2019 Chobolabs Inc.
-// Copyright(c) 2020-2025 Borislav Stanimirov
+// Copyright(c) 2020-2026 Borislav Stanimirov
 //
 // Permission is hereby granted, free of charge, to any person obtaining
 // a copy of this software and associated documentation files(the
@@ -29,6 +29,9 @@
 //
 //                  VERSION HISTORY
 //
+//  1.14 (2026-10-16) String prefix lookup policy
+//  1.13 (2026-10-16) insert_bulk and merge
+//  1.12 (2026-10-16) Lookup policies: branchless and Eytzinger
 //  1.11 (2025-07-24) Fix const_pointer typedef
 //  1.10 (2025-03-18) Add hint-based insert and emplace ops
 //                    Add constructors from ready-to-use containers and
@@ -83,6 +86,74 @@
 //  > mymap
 //
 //
+//                  Bulk operations
+//
+// Inserting many elements one by one is O(n) each, as elements after the
+// insertion point are shifted. Use these instead:
+// * insert_bulk(begin, end) - append the elements from the range, sort them,
+//   and merge them with the existing ones. O(n log n + m) for n new elements
+//   and m existing ones. Like insert, elements with keys which are already in
+//   the map are not inserted, and if the range has multiple elements with the
+//   same key, only the first one is inserted
+// * insert_bulk(flat_map_ready_tag, begin, end) - same, but the range is known
+//   to be sorted and without duplicates, so sorting is skipped. O(n + m)
+// * merge(other) - like std::map::merge. Moves the elements of another flat_map
+//   whose keys are not in this one. The rest remain in other. O(n + m)
+// These require a container with random access iterators, and merge also
+// requires reserve (std::vector and itlib's vectors fit). They use extra
+// memory for merging if it's available (see std::inplace_merge).
+// If an exception is thrown while moving or comparing elements the map is
+// left in an unspecified state.
+//
+//
+//                  Lookup policies
+//
+// The fifth template argument of flat_map is a lookup policy. It determines
+// how lower_bound (and thus find, count, at, operator[], insert, etc) searches
+// for keys:
+// * flat_map_std_lookup (default) - std::lower_bound
+// * flat_map_branchless_lookup - a binary search which compiles to conditional
+//   moves instead of branches. Works on the same sorted container and needs no
+//   extra memory. It also prefetches both possible next midpoints. Faster when
+//   the keys are cheap to compare (say integers). For 10k-1M integer keys it
+//   is more than twice faster than std::lower_bound
+// * flat_map_eytzinger_lookup - a copy of the keys is stored in an additional
+//   index in Eytzinger (BFS) order, where the nodes which are visited first are
+//   adjacent in memory and the next ones can be prefetched. This makes lookups
+//   in large maps much more cache friendly at the cost of memory. Keys must be
+//   copy-constructible.
+//   The index is built on demand by calling build_lookup_index(). Any
+//   modification of the map invalidates it, and lookups fall back to the
+//   branchless search until it is built again. Thus it is suited for read-mostly
+//   maps: bulk-load, build_lookup_index(), then only lookup. Building the
+//   index is O(n).
+//   The search itself is faster, but the result needs to be mapped back to
+//   the sorted container, which costs an extra cache miss. Whether this is
+//   faster than branchless depends on the key type and the access pattern, so
+//   measure before picking it.
+//   Note that modify_container() invalidates the index when called. Any changes
+//   made via the returned reference after build_lookup_index() will break the map
+// * flat_map_string_prefix_lookup - for std::string keys (or others with
+//   std::char_traits<char>) and the default comparator. The index stores the
+//   common prefix of all keys, and for each key the next 8 bytes after it
+//   packed in an integer which preserves the order. If adjacent keys share more
+//   than that, up to three more levels of such integers are added for the
+//   following bytes. Lookups binary search the integers and narrow the range
+//   level by level. Strings are compared only if more than one key matches
+//   all levels, and for the last remaining element. Thus lookups rarely touch
+//   the strings in the map, even if the keys share long prefixes. The index
+//   takes up to 32 bytes per element. Works with transparent lookups of anything
+//   which has data() and size() (like std::string_view) and C strings. Other
+//   types fall back to std::lower_bound.
+//   Like flat_map_eytzinger_lookup, the index is built on demand with
+//   build_lookup_index(), any modification invalidates it, and lookups fall
+//   back to std::lower_bound until it is rebuilt.
+// build_lookup_index() is a no-op for the other policies.
+// upper_bound and equal_range always use the std algorithms.
+// Lookups never modify the map, so they are safe to perform concurrently with
+// all policies.
+//
+//
 //                  Configuration
 //
 // Throw
@@ -102,6 +173,10 @@
 #include <vector>
 #include <algorithm>
 #include <type_traits>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <functional>
 
 #if !defined(ITLIB_FLAT_MAP_NO_THROW)
 #   include <stdexcept>
@@ -137,22 +212,322 @@ struct pair_compare : public Compare
 };
 }
 
+// lookup policies (see docs above)
+struct flat_map_std_lookup {};
+struct flat_map_branchless_lookup {};
+struct flat_map_eytzinger_lookup {};
+struct flat_map_string_prefix_lookup {};
+
+namespace fmimpl
+{
+// lookups are implemented in classes which the map inherits
+// they derive from pair_compare so as to preserve the empty base optimization for the comparator
+template <typename Lookup, typename Key, typename T, typename Compare>
+class lookup;
+
+template <typename Key, typename T, typename Compare>
+class lookup<flat_map_std_lookup, Key, T, Compare> : public pair_compare<Key, T, Compare>
+{
+public:
+    using pair_compare<Key, T, Compare>::pair_compare;
+
+    template <typename It, typename K>
+    It lookup_lower_bound(It begin, It end, const K& k) const
+    {
+        return std::lower_bound(begin, end, k, static_cast<const pair_compare<Key, T, Compare>&>(*this));
+    }
+
+    void lookup_invalidate() noexcept {}
+
+    template <typename Container>
+    void lookup_build(const Container&) {}
+};
+
+template <typename It, typename K, typename Compare>
+It branchless_lower_bound(It begin, It end, const K& k, const Compare& cmp)
+{
+    auto len = end - begin;
+    if (len == 0) return begin;
+    while (len > 1)
+    {
+        auto half = len / 2;
+#if defined(__GNUC__)
+        __builtin_prefetch(&*begin + half / 2);
+        __builtin_prefetch(&*begin + half + half / 2);
+#endif
+        // arithmetic instead of a ternary operator, as compilers often turn the latter into a branch
+        begin += half * decltype(half)(cmp(begin[half - 1], k));
+        len -= half;
+    }
+    return begin + cmp(*begin, k);
+}
+
+template <typename Key, typename T, typename Compare>
+class lookup<flat_map_branchless_lookup, Key, T, Compare> : public pair_compare<Key, T, Compare>
+{
+public:
+    using pair_compare<Key, T, Compare>::pair_compare;
+
+    template <typename It, typename K>
+    It lookup_lower_bound(It begin, It end, const K& k) const
+    {
+        return branchless_lower_bound(begin, end, k, static_cast<const pair_compare<Key, T, Compare>&>(*this));
+    }
+
+    void lookup_invalidate() noexcept {}
+
+    template <typename Container>
+    void lookup_build(const Container&) {}
+};
+
+template <typename Key, typename T, typename Compare>
+class lookup<flat_map_eytzinger_lookup, Key, T, Compare> : public pair_compare<Key, T, Compare>
+{
+    // keys in Eytzinger order: the children of node i are 2i+1 and 2i+2
+    // (or 2i and 2i+1 in 1-based numbering)
+    std::vector<Key> m_keys;
+    // index in the sorted container of each node
+    std::vector<size_t> m_ranks;
+
+    // in-order traversal of the implicit tree
+    void fill_ranks(size_t& rank, size_t node)
+    {
+        if (node >= m_ranks.size()) return;
+        fill_ranks(rank, 2 * node + 1);
+        m_ranks[node] = rank++;
+        fill_ranks(rank, 2 * node + 2);
+    }
+public:
+    using pair_compare<Key, T, Compare>::pair_compare;
+
+    template <typename It, typename K>
+    It lookup_lower_bound(It begin, It end, const K& k) const
+    {
+        const size_t n = m_keys.size();
+        if (n == 0 || n != size_t(end - begin))
+        {
+            // no index
+            return branchless_lower_bound(begin, end, k, static_cast<const pair_compare<Key, T, Compare>&>(*this));
+        }
+
+        const Compare& cmp = *this;
+        // the search uses 1-based node numbers: children of i are 2i and 2i+1
+        const Key* keys = m_keys.data();
+        size_t node = 1;
+        while (node <= n)
+        {
+#if defined(__GNUC__)
+            // the 16 descendants four levels down are adjacent
+            // prefetching never faults, so it's fine if they're out of bounds
+            __builtin_prefetch(reinterpret_cast<const void*>(reinterpret_cast<uintptr_t>(keys + node - 1) + 15 * node * sizeof(Key)));
+#endif
+            node = 2 * node + size_t(cmp(keys[node - 1], k));
+        }
+
+        // the path to node is encoded in its bits: 1 for right, 0 for left
+        // the lower bound is where we last went left: strip the trailing rights and the last left
+#if defined(__GNUC__)
+        node >>= __builtin_ctzll(~static_cast<unsigned long long>(node)) + 1;
+#else
+        while (node & 1) node >>= 1;
+        node >>= 1;
+#endif
+
+        if (node == 0) return end;
+        return begin + m_ranks[node - 1];
+    }
+
+    void lookup_invalidate() noexcept
+    {
+        m_keys.clear();
+        m_ranks.clear();
+    }
+
+    template <typename Container>
+    void lookup_build(const Container& c)
+    {
+        lookup_invalidate();
+        if (c.empty()) return;
+        m_ranks.resize(c.size());
+        size_t rank = 0;
+        fill_ranks(rank, 0);
+        m_keys.reserve(c.size());
+        for (auto r : m_ranks)
+        {
+            m_keys.push_back(c[r].first);
+        }
+    }
+};
+
+// packs 8 bytes from an offset, padded with zeroes, into a big-endian integer
+// comparing these integers is the same as comparing the bytes lexicographically
+inline uint64_t string_head(const char* str, size_t len, size_t offset)
+{
+    uint64_t ret = 0;
+    for (size_t i = offset; i < offset + 8; ++i)
+    {
+        ret = (ret << 8) | (i < len ? uint64_t(static_cast<unsigned char>(str[i])) : 0);
+    }
+    return ret;
+}
+
+template <typename S>
+auto string_chars(const S& s) -> decltype(std::make_pair(s.data(), size_t(s.size())))
+{
+    return std::make_pair(s.data(), size_t(s.size()));
+}
+
+inline std::pair<const char*, size_t> string_chars(const char* s)
+{
+    return std::make_pair(s, std::strlen(s));
+}
+
+template <typename K, typename = void>
+struct has_string_chars : std::false_type {};
+
+template <typename K>
+struct has_string_chars<K, typename std::enable_if<std::is_same<
+    decltype(string_chars(std::declval<const K&>())), std::pair<const char*, size_t>
+>::value>::type> : std::true_type {};
+
+template <typename Key, typename T, typename Compare>
+class lookup<flat_map_string_prefix_lookup, Key, T, Compare> : public pair_compare<Key, T, Compare>
+{
+    static_assert(std::is_same<typename Key::traits_type, std::char_traits<char>>::value,
+        "flat_map_string_prefix_lookup requires std::string-like keys");
+    static_assert(std::is_same<Compare, less>::value || std::is_same<Compare, std::less<Key>>::value,
+        "flat_map_string_prefix_lookup requires lexicographical ordering of the keys");
+
+    // more levels mean fewer string comparisons for keys with long common prefixes, but more memory
+    static constexpr size_t max_levels = 4;
+
+    // common prefix of all keys
+    std::string m_prefix;
+
+    // level l has the string_head of all keys at offset prefix + 8*l
+    // elements with the same heads on all previous levels are adjacent,
+    // so a lookup narrows the range on each level until it has at most one element
+    // a level is only added if some adjacent keys have the same heads on all previous ones
+    size_t m_levels = 0;
+    std::vector<uint64_t> m_heads;
+
+    const pair_compare<Key, T, Compare>& pcmp() const { return *this; }
+
+    template <typename It, typename K>
+    It lower_bound_chars(It begin, It end, const K& k, std::false_type) const
+    {
+        return std::lower_bound(begin, end, k, pcmp());
+    }
+
+    template <typename It, typename K>
+    It lower_bound_chars(It begin, It end, const K& k, std::true_type) const
+    {
+        const auto q = string_chars(k);
+        const size_t plen = m_prefix.size();
+
+        // the searched key is either before all keys, after all keys, or shares the prefix
+        const int c = std::char_traits<char>::compare(q.first, m_prefix.data(), std::min(q.second, plen));
+        if (c < 0 || (c == 0 && q.second < plen)) return begin;
+        if (c > 0) return end;
+
+        const size_t n = size_t(end - begin);
+        size_t lo = 0, hi = n;
+        for (size_t l = 0; l < m_levels && hi - lo > 1; ++l)
+        {
+            const uint64_t qh = string_head(q.first, q.second, plen + 8 * l);
+            const uint64_t* level = m_heads.data() + l * n;
+            auto first = branchless_lower_bound(level + lo, level + hi, qh, std::less<uint64_t>());
+            auto last = branchless_lower_bound(first, level + hi, qh, std::less_equal<uint64_t>());
+            lo = size_t(first - level);
+            hi = size_t(last - level);
+        }
+
+        // no strings to compare if no key has the same heads
+        if (lo == hi) return begin + difference_type(lo);
+        return std::lower_bound(begin + difference_type(lo), begin + difference_type(hi), k, pcmp());
+    }
+
+    using difference_type = std::ptrdiff_t;
+public:
+    using pair_compare<Key, T, Compare>::pair_compare;
+
+    template <typename It, typename K>
+    It lookup_lower_bound(It begin, It end, const K& k) const
+    {
+        if (m_levels == 0 || m_heads.size() != m_levels * size_t(end - begin))
+        {
+            // no index
+            return std::lower_bound(begin, end, k, pcmp());
+        }
+        return lower_bound_chars(begin, end, k, has_string_chars<K>{});
+    }
+
+    void lookup_invalidate() noexcept
+    {
+        m_prefix.clear();
+        m_levels = 0;
+        m_heads.clear();
+    }
+
+    template <typename Container>
+    void lookup_build(const Container& c)
+    {
+        lookup_invalidate();
+        if (c.empty()) return;
+
+        // the keys are sorted, so the common prefix of all is that of the first and last
+        const Key& first = c.front().first;
+        const Key& last = c.back().first;
+        size_t plen = 0;
+        while (plen < first.size() && plen < last.size() && first[plen] == last[plen]) ++plen;
+        m_prefix.assign(first.data(), plen);
+
+        // enough levels to distinguish the longest common prefix of adjacent keys
+        size_t levels = 1;
+        for (size_t i = 1; i < c.size() && levels < max_levels; ++i)
+        {
+            const Key& a = c[i - 1].first;
+            const Key& b = c[i].first;
+            size_t lcp = plen;
+            const size_t len = std::min(a.size(), b.size());
+            while (lcp < len && a[lcp] == b[lcp]) ++lcp;
+            levels = std::max(levels, (lcp - plen) / 8 + 1);
+        }
+        levels = std::min(levels, size_t(max_levels));
+
+        m_heads.reserve(levels * c.size());
+        for (size_t l = 0; l < levels; ++l)
+        {
+            for (auto& elem : c)
+            {
+                m_heads.push_back(string_head(elem.first.data(), elem.first.size(), plen + 8 * l));
+            }
+        }
+        m_levels = levels;
+    }
+};
+}
+
 // tag for constructors which tage ready-to-use containers and sequences
 struct flat_map_ready_tag {};
 
-template <typename Key, typename T, typename Compare = fmimpl::less, typename Container = std::vector<std::pair<Key, T>>>
-class flat_map : private fmimpl::pair_compare<Key, T, Compare>
+template <typename Key, typename T, typename Compare = fmimpl::less, typename Container = std::vector<std::pair<Key, T>>, typename Lookup = flat_map_std_lookup>
+class flat_map : private fmimpl::lookup<Lookup, Key, T, Compare>
 {
     Container m_container;
     using pair_compare = fmimpl::pair_compare<Key, T, Compare>;
+    using lookup_base = fmimpl::lookup<Lookup, Key, T, Compare>;
     pair_compare& cmp() { return *this; }
     const pair_compare& cmp() const { return *this; }
+    lookup_base& lookup() { return *this; }
+    const lookup_base& lookup() const { return *this; }
 public:
     typedef Key key_type;
     typedef T mapped_type;
     typedef std::pair<Key, T> value_type;
     typedef Container container_type;
     typedef Compare key_compare;
+    typedef Lookup lookup_policy;
     typedef value_type& reference;
     typedef const value_type& const_reference;
     typedef typename container_type::allocator_type allocator_type;
@@ -168,12 +543,12 @@ public:
     flat_map() = default;
 
     explicit flat_map(const key_compare& comp, const allocator_type& alloc = allocator_type())
-        : pair_compare(comp)
+        : lookup_base(comp)
         , m_container(alloc)
     {}
 
     explicit flat_map(container_type container, const key_compare& comp = key_compare())
-        : pair_compare(comp)
+        : lookup_base(comp)
         , m_container(std::move(container))
     {
         std::sort(m_container.begin(), m_container.end(), cmp());
@@ -204,7 +579,7 @@ public:
     // ready-to-use containers and sequences
 
     flat_map(container_type container, flat_map_ready_tag, const key_compare& comp = key_compare())
-        : pair_compare(comp)
+        : lookup_base(comp)
         , m_container(std::move(container))
     {}
 
@@ -250,18 +625,28 @@ public:
     void reserve(size_type count) { return m_container.reserve(count); }
     size_type capacity() const noexcept { return m_container.capacity(); }
 
-    void clear() noexcept { m_container.clear(); }
+    void clear() noexcept
+    {
+        lookup().lookup_invalidate();
+        m_container.clear();
+    }
+
+    // build the index of lookup policies which require one
+    void build_lookup_index()
+    {
+        lookup().lookup_build(m_container);
+    }
 
     template <typename K>
     iterator lower_bound(const K& k)
     {
-        return std::lower_bound(m_container.begin(), m_container.end(), k, cmp());
+        return lookup().lookup_lower_bound(m_container.begin(), m_container.end(), k);
     }
 
     template <typename K>
     const_iterator lower_bound(const K& k) const
     {
-        return std::lower_bound(m_container.begin(), m_container.end(), k, cmp());
+        return lookup().lookup_lower_bound(m_container.begin(), m_container.end(), k);
     }
 
     template <typename K>
@@ -323,6 +708,7 @@ public:
             return { i, false };
         }
 
+        lookup().lookup_invalidate();
         return {m_container.emplace(i, std::forward<P>(val)), true};
     }
 
@@ -334,6 +720,7 @@ public:
             return { i, false };
         }
 
+        lookup().lookup_invalidate();
         return {m_container.emplace(i, val), true};
     }
 
@@ -360,6 +747,7 @@ public:
     {
         if (empty())
         {
+            lookup().lookup_invalidate();
             m_container.emplace_back(std::forward<Args>(args)...);
             return begin();
         }
@@ -380,19 +768,87 @@ public:
 
         if (bok && eok)
         {
+            lookup().lookup_invalidate();
             return m_container.emplace(pos, std::move(val));
         }
 
         return insert(std::move(val)).first;
     }
 
+    template <class InputIterator>
+    void insert_bulk(InputIterator begin, InputIterator end)
+    {
+        const auto old_size = size();
+        lookup().lookup_invalidate();
+        m_container.insert(m_container.end(), begin, end);
+        const auto mid = m_container.begin() + difference_type(old_size);
+
+        // stable so that the first of several equivalent elements is the one which remains
+        std::stable_sort(mid, m_container.end(), cmp());
+        auto new_end = std::unique(mid, m_container.end(), [this](const value_type& a, const value_type& b) -> bool {
+            return !cmp()(a, b) && !cmp()(b, a);
+        });
+        m_container.erase(new_end, m_container.end());
+
+        merge_tail(old_size);
+    }
+
+    template <class InputIterator>
+    void insert_bulk(flat_map_ready_tag, InputIterator begin, InputIterator end)
+    {
+        const auto old_size = size();
+        lookup().lookup_invalidate();
+        m_container.insert(m_container.end(), begin, end);
+        merge_tail(old_size);
+    }
+
+    void merge(flat_map& other)
+    {
+        if (&other == this) return;
+
+        lookup().lookup_invalidate();
+        other.lookup().lookup_invalidate();
+
+        const auto old_size = size();
+        m_container.reserve(old_size + other.size());
+
+        // both are sorted: walk them together
+        // move the elements which aren't in this to its tail and compact the rest in other
+        auto& oc = other.m_container;
+        auto keep = oc.begin();
+        size_type i = 0;
+        for (auto o = oc.begin(); o != oc.end(); ++o)
+        {
+            while (i < old_size && cmp()(m_container[i], *o)) ++i;
+            if (i < old_size && !cmp()(*o, m_container[i]))
+            {
+                if (keep != o) *keep = std::move(*o);
+                ++keep;
+            }
+            else
+            {
+                m_container.push_back(std::move(*o));
+            }
+        }
+        oc.erase(keep, oc.end());
+
+        std::inplace_merge(m_container.begin(), m_container.begin() + difference_type(old_size), m_container.end(), cmp());
+    }
+
+    void merge(flat_map&& other)
+    {
+        merge(other);
+    }
+
     iterator erase(const_iterator pos)
     {
+        lookup().lookup_invalidate();
         return m_container.erase(pos);
     }
 
     iterator erase(iterator pos)
     {
+        lookup().lookup_invalidate();
         return m_container.erase(const_iterator(pos));
     }
 
@@ -419,6 +875,7 @@ public:
             return i->second;
         }
 
+        lookup().lookup_invalidate();
         i = m_container.emplace(i, std::forward<K>(k), mapped_type());
         return i->second;
     }
@@ -447,7 +904,7 @@ public:
 
     void swap(flat_map& x)
     {
-        std::swap(cmp(), x.cmp());
+        std::swap(lookup(), x.lookup());
         m_container.swap(x.m_container);
     }
 
@@ -459,18 +916,38 @@ public:
     // DANGER! If you're not careful with this function, you may irreversably break the map
     container_type& modify_container() noexcept
     {
+        lookup().lookup_invalidate();
         return m_container;
     }
+
+private:
+    // merge sorted and unique elements from old_size to the end with the ones before them
+    // elements in the tail with keys which are in the head are removed
+    void merge_tail(size_type old_size)
+    {
+        const auto mid = m_container.begin() + difference_type(old_size);
+        if (old_size == 0 || mid == m_container.end()) return;
+
+        // the common case of appending greater keys needs no merge
+        if (cmp()(*(mid - 1), *mid)) return;
+
+        // stable, so the existing element comes first among equivalent ones
+        std::inplace_merge(m_container.begin(), mid, m_container.end(), cmp());
+        auto new_end = std::unique(m_container.begin(), m_container.end(), [this](const value_type& a, const value_type& b) -> bool {
+            return !cmp()(a, b) && !cmp()(b, a);
+        });
+        m_container.erase(new_end, m_container.end());
+    }
 };
 
-template <typename Key, typename T, typename Compare, typename Container>
-bool operator==(const flat_map<Key, T, Compare, Container>& a, const flat_map<Key, T, Compare, Container>& b)
+template <typename Key, typename T, typename Compare, typename Container, typename Lookup>
+bool operator==(const flat_map<Key, T, Compare, Container, Lookup>& a, const flat_map<Key, T, Compare, Container, Lookup>& b)
 {
     return a.container() == b.container();
 }
 
-template <typename Key, typename T, typename Compare, typename Container>
-bool operator!=(const flat_map<Key, T, Compare, Container>& a, const flat_map<Key, T, Compare, Container>& b)
+template <typename Key, typename T, typename Compare, typename Container, typename Lookup>
+bool operator!=(const flat_map<Key, T, Compare, Container, Lookup>& a, const flat_map<Key, T, Compare, Container, Lookup>& b)
 {
     return a.container() != b.container();
 }
@@ -0,0 +1,586 @@
+// itlib-flat-soa-map v1.00
+//
+// std::map-like class with keys and values in two separate vectors
+//
+// SPDX-License-Identifier: MIT
+// MIT License:
+// Copyright(c) 2026 Borislav Stanimirov
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files(the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and / or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions :
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//
+//                  VERSION HISTORY
+//
+//  1.00 (2026-10-16) Initial release
+//
+//
+//                  DOCUMENTATION
+//
+// Simply include this file wherever you need.
+// It defines the class itlib::flat_soa_map, which is a variant of
+// itlib::flat_map (and similar to C++23's std::flat_map) where the keys and the
+// mapped values are stored in two separate containers (a structure of arrays).
+//
+// Lookups only touch the keys. Thus for maps with large values they touch far
+// fewer cache lines than flat_map, where a binary search drags the values
+// along with the keys.
+//
+// The template arguments are <key, value, compare, key container, mapped container>
+// The containers must be std::vector compatible. By default they are
+// std::vector<key> and std::vector<value>. Other viable options are
+// itlib::small_vector and itlib::pod_vector (for trivial types). For example:
+//
+// itlib::flat_soa_map<
+//      int,
+//      vec4,
+//      std::less<int>,
+//      itlib::pod_vector<int>,
+//      itlib::pod_vector<vec4>
+//  > mymap;
+//
+// The interface is that of flat_map with these differences:
+// * Dereferencing an iterator returns a proxy: std::pair<const key&, value&>
+//   (for const_iterator: std::pair<const key&, const value&>). Thus
+//   `it->first` and `it->second` work, but `auto& elem = *it` does not.
+//   Use `auto elem = *it` or `auto&& elem = *it`.
+// * Iterators are random access and expose the underlying container
+//   iterators via key_iter() and mapped_iter()
+// * The containers are accessible via keys() and values(). The values can be
+//   modified via modify_values()
+// * The constructors which take containers take two: keys and values. Their
+//   sizes must match. If they don't, std::invalid_argument is thrown
+// * The lookup policies and bulk ops of flat_map are not supported
+//
+//
+//                  Configuration
+//
+// Throw
+// Whether to throw exceptions: when `at` is called with a non-existent key.
+// By default, like std::map, it throws an std::out_of_range exception. If you define
+// ITLIB_FLAT_SOA_MAP_NO_THROW before including this header, the exception will
+// be substituted by an assertion.
+// The same goes for the std::invalid_argument exception on mismatched container
+// sizes. With ITLIB_FLAT_SOA_MAP_NO_THROW (and no asserts) the map is left empty
+//
+//
+//                  TESTS
+//
+// You can find unit tests in the official repo:
+// https://github.com/iboB/itlib/blob/master/test/
+//
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <iterator>
+#include <utility>
+#include <cstddef>
+
+#if !defined(ITLIB_FLAT_SOA_MAP_NO_THROW)
+#   include <stdexcept>
+#   define I_ITLIB_THROW_FLAT_SOA_MAP_OUT_OF_RANGE() throw std::out_of_range("itlib::flat_soa_map out of range")
+#   define I_ITLIB_THROW_FLAT_SOA_MAP_SIZE_MISMATCH() throw std::invalid_argument("itlib::flat_soa_map container size mismatch")
+#else
+#   include <cassert>
+#   define I_ITLIB_THROW_FLAT_SOA_MAP_OUT_OF_RANGE() assert(false && "itlib::flat_soa_map out of range")
+#   define I_ITLIB_THROW_FLAT_SOA_MAP_SIZE_MISMATCH() assert(false && "itlib::flat_soa_map container size mismatch")
+#endif
+
+namespace itlib
+{
+
+namespace fsoaimpl
+{
+struct less // so as not to clash with flat_map's less
+{
+    template <typename T, typename U>
+    auto operator()(const T& t, const U& u) const -> decltype(t < u)
+    {
+        return t < u;
+    }
+};
+
+// KeyIt is always a const_iterator of the key container
+template <typename KeyIt, typename MappedIt>
+class iterator
+{
+    KeyIt m_key;
+    MappedIt m_mapped;
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::pair<
+        typename std::iterator_traits<KeyIt>::value_type,
+        typename std::iterator_traits<MappedIt>::value_type
+    >;
+    using reference = std::pair<
+        typename std::iterator_traits<KeyIt>::reference,
+        typename std::iterator_traits<MappedIt>::reference
+    >;
+    using difference_type = std::ptrdiff_t;
+
+    // operator-> needs an address, so the proxy reference is stored in it
+    struct pointer
+    {
+        reference ref;
+        reference* operator->() { return &ref; }
+    };
+
+    iterator() = default;
+    iterator(KeyIt k, MappedIt m) : m_key(k), m_mapped(m) {}
+
+    // iterator to const_iterator
+    template <typename MI, typename = typename std::enable_if<std::is_convertible<MI, MappedIt>::value>::type>
+    iterator(const iterator<KeyIt, MI>& other) : m_key(other.key_iter()), m_mapped(other.mapped_iter()) {}
+
+    const KeyIt& key_iter() const { return m_key; }
+    const MappedIt& mapped_iter() const { return m_mapped; }
+
+    reference operator*() const { return reference(*m_key, *m_mapped); }
+    pointer operator->() const { return pointer{**this}; }
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    iterator& operator++() { ++m_key; ++m_mapped; return *this; }
+    iterator operator++(int) { auto ret = *this; ++*this; return ret; }
+    iterator& operator--() { --m_key; --m_mapped; return *this; }
+    iterator operator--(int) { auto ret = *this; --*this; return ret; }
+
+    iterator& operator+=(difference_type n) { m_key += n; m_mapped += n; return *this; }
+    iterator& operator-=(difference_type n) { m_key -= n; m_mapped -= n; return *this; }
+    friend iterator operator+(iterator i, difference_type n) { return i += n; }
+    friend iterator operator+(difference_type n, iterator i) { return i += n; }
+    friend iterator operator-(iterator i, difference_type n) { return i -= n; }
+
+    // keys and values move together, so it's enough to compare the keys
+    template <typename MI>
+    difference_type operator-(const iterator<KeyIt, MI>& other) const { return m_key - other.key_iter(); }
+    template <typename MI>
+    bool operator==(const iterator<KeyIt, MI>& other) const { return m_key == other.key_iter(); }
+    template <typename MI>
+    bool operator!=(const iterator<KeyIt, MI>& other) const { return m_key != other.key_iter(); }
+    template <typename MI>
+    bool operator<(const iterator<KeyIt, MI>& other) const { return m_key < other.key_iter(); }
+    template <typename MI>
+    bool operator>(const iterator<KeyIt, MI>& other) const { return m_key > other.key_iter(); }
+    template <typename MI>
+    bool operator<=(const iterator<KeyIt, MI>& other) const { return m_key <= other.key_iter(); }
+    template <typename MI>
+    bool operator>=(const iterator<KeyIt, MI>& other) const { return m_key >= other.key_iter(); }
+};
+}
+
+// tag for constructors which take ready-to-use containers
+struct flat_soa_map_ready_tag {};
+
+template <
+    typename Key,
+    typename T,
+    typename Compare = fsoaimpl::less,
+    typename KeyContainer = std::vector<Key>,
+    typename MappedContainer = std::vector<T>
+>
+class flat_soa_map : private /*EBO*/ Compare
+{
+    KeyContainer m_keys;
+    MappedContainer m_values;
+    Compare& cmp() { return *this; }
+    const Compare& cmp() const { return *this; }
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<Key, T>;
+    using key_compare = Compare;
+    using key_container_type = KeyContainer;
+    using mapped_container_type = MappedContainer;
+    using iterator = fsoaimpl::iterator<typename KeyContainer::const_iterator, typename MappedContainer::iterator>;
+    using const_iterator = fsoaimpl::iterator<typename KeyContainer::const_iterator, typename MappedContainer::const_iterator>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    using reference = typename iterator::reference;
+    using const_reference = typename const_iterator::reference;
+    using difference_type = std::ptrdiff_t;
+    using size_type = typename KeyContainer::size_type;
+
+    flat_soa_map() = default;
+
+    explicit flat_soa_map(const key_compare& comp)
+        : Compare(comp)
+    {}
+
+    // the containers are sorted, and for equivalent keys only the first one remains
+    flat_soa_map(key_container_type keys, mapped_container_type values, const key_compare& comp = key_compare())
+        : Compare(comp)
+        , m_keys(std::move(keys))
+        , m_values(std::move(values))
+    {
+        check_sizes();
+        sort_and_unique();
+    }
+
+    flat_soa_map(std::initializer_list<value_type> init, const key_compare& comp = key_compare())
+        : Compare(comp)
+    {
+        m_keys.reserve(init.size());
+        m_values.reserve(init.size());
+        for (auto& elem : init)
+        {
+            m_keys.push_back(elem.first);
+            m_values.push_back(elem.second);
+        }
+        sort_and_unique();
+    }
+
+    template <class InputIterator, typename = decltype(*std::declval<InputIterator>())>
+    flat_soa_map(InputIterator begin, InputIterator end, const key_compare& comp = key_compare())
+        : Compare(comp)
+    {
+        for (; begin != end; ++begin)
+        {
+            m_keys.push_back(begin->first);
+            m_values.push_back(begin->second);
+        }
+        sort_and_unique();
+    }
+
+    // ready-to-use containers: keys must be sorted and unique
+    flat_soa_map(key_container_type keys, mapped_container_type values, flat_soa_map_ready_tag, const key_compare& comp = key_compare())
+        : Compare(comp)
+        , m_keys(std::move(keys))
+        , m_values(std::move(values))
+    {
+        check_sizes();
+    }
+
+    flat_soa_map(const flat_soa_map& x) = default;
+    flat_soa_map& operator=(const flat_soa_map& x) = default;
+
+    flat_soa_map(flat_soa_map&& x) noexcept = default;
+    flat_soa_map& operator=(flat_soa_map&& x) noexcept = default;
+
+    key_compare key_comp() const { return *this; }
+
+    iterator begin() noexcept { return iterator(m_keys.cbegin(), m_values.begin()); }
+    const_iterator begin() const noexcept { return const_iterator(m_keys.cbegin(), m_values.cbegin()); }
+    iterator end() noexcept { return iterator(m_keys.cend(), m_values.end()); }
+    const_iterator end() const noexcept { return const_iterator(m_keys.cend(), m_values.cend()); }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    bool empty() const noexcept { return m_keys.empty(); }
+    size_type size() const noexcept { return m_keys.size(); }
+    size_type max_size() const noexcept { return m_keys.max_size(); }
+
+    void reserve(size_type count)
+    {
+        m_keys.reserve(count);
+        m_values.reserve(count);
+    }
+    size_type capacity() const noexcept { return m_keys.capacity(); }
+
+    void clear() noexcept
+    {
+        m_keys.clear();
+        m_values.clear();
+    }
+
+    template <typename K>
+    iterator lower_bound(const K& k)
+    {
+        return iter_at(std::lower_bound(m_keys.begin(), m_keys.end(), k, cmp()) - m_keys.begin());
+    }
+
+    template <typename K>
+    const_iterator lower_bound(const K& k) const
+    {
+        return iter_at(std::lower_bound(m_keys.begin(), m_keys.end(), k, cmp()) - m_keys.begin());
+    }
+
+    template <typename K>
+    iterator upper_bound(const K& k)
+    {
+        return iter_at(std::upper_bound(m_keys.begin(), m_keys.end(), k, cmp()) - m_keys.begin());
+    }
+
+    template <typename K>
+    const_iterator upper_bound(const K& k) const
+    {
+        return iter_at(std::upper_bound(m_keys.begin(), m_keys.end(), k, cmp()) - m_keys.begin());
+    }
+
+    template <typename K>
+    std::pair<iterator, iterator> equal_range(const K& k)
+    {
+        auto r = std::equal_range(m_keys.begin(), m_keys.end(), k, cmp());
+        return {iter_at(r.first - m_keys.begin()), iter_at(r.second - m_keys.begin())};
+    }
+
+    template <typename K>
+    std::pair<const_iterator, const_iterator> equal_range(const K& k) const
+    {
+        auto r = std::equal_range(m_keys.begin(), m_keys.end(), k, cmp());
+        return {iter_at(r.first - m_keys.begin()), iter_at(r.second - m_keys.begin())};
+    }
+
+    template <typename K>
+    iterator find(const K& k)
+    {
+        auto i = lower_bound(k);
+        if (i != end() && !cmp()(k, *i.key_iter()))
+            return i;
+
+        return end();
+    }
+
+    template <typename K>
+    const_iterator find(const K& k) const
+    {
+        auto i = lower_bound(k);
+        if (i != end() && !cmp()(k, *i.key_iter()))
+            return i;
+
+        return end();
+    }
+
+    template <typename K>
+    size_t count(const K& k) const
+    {
+        return find(k) == end() ? 0 : 1;
+    }
+
+    template <typename P>
+    std::pair<iterator, bool> insert(P&& val)
+    {
+        auto i = lower_bound(val.first);
+        if (i != end() && !cmp()(val.first, *i.key_iter()))
+        {
+            return {i, false};
+        }
+
+        return {insert_at(i, std::forward<P>(val).first, std::forward<P>(val).second), true};
+    }
+
+    std::pair<iterator, bool> insert(const value_type& val)
+    {
+        auto i = lower_bound(val.first);
+        if (i != end() && !cmp()(val.first, *i.key_iter()))
+        {
+            return {i, false};
+        }
+
+        return {insert_at(i, val.first, val.second), true};
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args)
+    {
+        value_type val(std::forward<Args>(args)...);
+        return insert(std::move(val));
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        auto k = m_keys.erase(pos.key_iter());
+        auto m = m_values.erase(pos.mapped_iter());
+        return iterator(k, m);
+    }
+
+    iterator erase(iterator pos)
+    {
+        return erase(const_iterator(pos));
+    }
+
+    template <typename K>
+    size_type erase(const K& k)
+    {
+        auto i = find(k);
+        if (i == end())
+        {
+            return 0;
+        }
+
+        erase(i);
+        return 1;
+    }
+
+    template <typename K>
+    typename std::enable_if<std::is_constructible<key_type, K>::value,
+    mapped_type&>::type operator[](K&& k)
+    {
+        auto i = lower_bound(k);
+        if (i != end() && !cmp()(k, *i.key_iter()))
+        {
+            return *i.mapped_iter();
+        }
+
+        i = insert_at(i, key_type(std::forward<K>(k)), mapped_type());
+        return *i.mapped_iter();
+    }
+
+    mapped_type& at(const key_type& k)
+    {
+        auto i = find(k);
+        if (i == end())
+        {
+            I_ITLIB_THROW_FLAT_SOA_MAP_OUT_OF_RANGE();
+        }
+
+        return *i.mapped_iter();
+    }
+
+    const mapped_type& at(const key_type& k) const
+    {
+        auto i = find(k);
+        if (i == end())
+        {
+            I_ITLIB_THROW_FLAT_SOA_MAP_OUT_OF_RANGE();
+        }
+
+        return *i.mapped_iter();
+    }
+
+    void swap(flat_soa_map& x)
+    {
+        std::swap(cmp(), x.cmp());
+        m_keys.swap(x.m_keys);
+        m_values.swap(x.m_values);
+    }
+
+    const key_container_type& keys() const noexcept
+    {
+        return m_keys;
+    }
+
+    const mapped_container_type& values() const noexcept
+    {
+        return m_values;
+    }
+
+    // values can be modified freely, but don't change the size of the container
+    mapped_container_type& modify_values() noexcept
+    {
+        return m_values;
+    }
+
+private:
+    iterator iter_at(difference_type i)
+    {
+        return begin() + i;
+    }
+
+    const_iterator iter_at(difference_type i) const
+    {
+        return begin() + i;
+    }
+
+    template <typename K, typename M>
+    iterator insert_at(const_iterator pos, K&& k, M&& m)
+    {
+        const auto index = pos - cbegin();
+        auto ki = m_keys.insert(pos.key_iter(), std::forward<K>(k));
+        try
+        {
+            m_values.insert(pos.mapped_iter(), std::forward<M>(m));
+        }
+        catch (...)
+        {
+            // keep the containers in sync
+            m_keys.erase(ki);
+            throw;
+        }
+        return iter_at(index);
+    }
+
+    void check_sizes()
+    {
+        if (size_t(m_keys.size()) != size_t(m_values.size()))
+        {
+            I_ITLIB_THROW_FLAT_SOA_MAP_SIZE_MISMATCH();
+#if defined(ITLIB_FLAT_SOA_MAP_NO_THROW)
+            // leave the map empty rather than broken
+            clear();
+#endif
+        }
+    }
+
+    void sort_and_unique()
+    {
+        const size_t size = m_keys.size();
+
+        // sort an index array and then apply the permutation to both containers
+        std::vector<size_t> perm(size);
+        for (size_t i = 0; i < size; ++i) perm[i] = i;
+        std::stable_sort(perm.begin(), perm.end(), [this](size_t a, size_t b) {
+            return cmp()(m_keys[a], m_keys[b]);
+        });
+
+        // new[i] = old[perm[i]], follow the cycles of the permutation
+        for (size_t i = 0; i < size; ++i)
+        {
+            size_t cur = i;
+            while (perm[cur] != i)
+            {
+                const size_t next = perm[cur];
+                using std::swap;
+                swap(m_keys[cur], m_keys[next]);
+                swap(m_values[cur], m_values[next]);
+                perm[cur] = cur;
+                cur = next;
+            }
+            perm[cur] = cur;
+        }
+
+        // remove duplicates, keeping the first of equivalent keys
+        if (size < 2) return;
+        size_t out = 0;
+        for (size_t i = 1; i < size; ++i)
+        {
+            if (cmp()(m_keys[out], m_keys[i]))
+            {
+                ++out;
+                if (out != i)
+                {
+                    m_keys[out] = std::move(m_keys[i]);
+                    m_values[out] = std::move(m_values[i]);
+                }
+            }
+        }
+        ++out;
+        m_keys.erase(m_keys.begin() + difference_type(out), m_keys.end());
+        m_values.erase(m_values.begin() + difference_type(out), m_values.end());
+    }
+};
+
+template <typename Key, typename T, typename Compare, typename KeyContainer, typename MappedContainer>
+bool operator==(const flat_soa_map<Key, T, Compare, KeyContainer, MappedContainer>& a, const flat_soa_map<Key, T, Compare, KeyContainer, MappedContainer>& b)
+{
+    return a.keys() == b.keys() && a.values() == b.values();
+}
+
+template <typename Key, typename T, typename Compare, typename KeyContainer, typename MappedContainer>
+bool operator!=(const flat_soa_map<Key, T, Compare, KeyContainer, MappedContainer>& a, const flat_soa_map<Key, T, Compare, KeyContainer, MappedContainer>& b)
+{
+    return !(a == b);
+}
+
+}
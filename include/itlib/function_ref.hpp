@@ -0,0 +1,173 @@
+// itlib-function_ref v1.00
+//
+// A non-owning view of a callable
+// Similar to C++26's function_ref
+//
+// SPDX-License-Identifier: MIT
+// MIT License:
+// Copyright(c) 2026 Borislav Stanimirov
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files(the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and / or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions :
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//
+//                  VERSION HISTORY
+//
+//  1.00 (2026-10-16) Initial release
+//
+//
+//                  DOCUMENTATION
+//
+// Simply include this file wherever you need.
+// It defines the class itlib::function_ref<R(Args...)>. It's a reference to a
+// callable object: a lambda, a function object or a free function.
+//
+// It's two pointers (a pointer to the object and a pointer to a function which
+// invokes it), never allocates and is trivially copyable. Thus it's a cheap
+// alternative to std::function or itlib::ufunction for function arguments
+// when the callee only calls the function and doesn't store it.
+//
+// As with any reference, the referenced object must outlive the function_ref.
+// It's fine to bind a function_ref function argument to a temporary (say a
+// lambda), but storing a function_ref to a temporary will make it dangle.
+//
+// function_ref is not nullable. It cannot be default-constructed or created
+// from nullptr. Creating it from a null function pointer triggers an assert.
+//
+// If the bound object is const, it's invoked as const. Otherwise it's invoked
+// as a mutable object (mutable lambdas will modify their captures).
+//
+// A function_ref which returns a reference can't be bound to a callable which
+// returns by value, as the returned reference would dangle.
+//
+// Example:
+//
+// void visit(const tree& t, itlib::function_ref<void(const node&)> cb);
+//
+// int count = 0;
+// visit(tree, [&](const node& n) { count += n.leaf(); });
+//
+//
+//                  TESTS
+//
+// You can find unit tests in the official repo:
+// https://github.com/iboB/itlib/blob/master/test/
+//
+#pragma once
+
+#include <type_traits>
+#include <utility>
+#include <memory> // std::addressof
+#include <cassert>
+
+namespace itlib
+{
+
+template <typename F>
+class function_ref;
+
+template <typename R, typename... Args>
+class function_ref<R(Args...)>
+{
+    union target
+    {
+        void* obj;
+        void (*func)();
+    };
+
+    using thunk_fn = R (*)(target, Args&&...);
+
+    target m_target;
+    thunk_fn m_thunk;
+
+    template <typename FO>
+    static R invoke_obj(target t, Args&&... args)
+    {
+        // cast so we can invoke function objects with return values as void
+        return static_cast<R>((*static_cast<FO*>(t.obj))(std::forward<Args>(args)...));
+    }
+
+    template <typename FP>
+    static R invoke_func(target t, Args&&... args)
+    {
+        return static_cast<R>(reinterpret_cast<FP>(t.func)(std::forward<Args>(args)...));
+    }
+
+    // a reference can only be returned if the callable returns a compatible reference
+    // (otherwise it would be bound to a temporary)
+    template <typename Res>
+    struct returns_as : std::integral_constant<bool,
+        std::is_void<R>::value
+        || (std::is_convertible<Res, R>::value
+            && (!std::is_reference<R>::value || (std::is_reference<Res>::value
+                && std::is_convertible<typename std::remove_reference<Res>::type*, typename std::remove_reference<R>::type*>::value)))>
+    {};
+
+    template <typename FO, typename = void>
+    struct is_invocable : std::false_type {};
+
+    template <typename FO>
+    struct is_invocable<FO, typename std::enable_if<
+        returns_as<decltype(std::declval<FO&>()(std::declval<Args>()...))>::value
+    >::type> : std::true_type {};
+
+    template <typename FO>
+    using enable_for_object = typename std::enable_if<
+        !std::is_same<typename std::decay<FO>::type, function_ref>::value
+        && !std::is_pointer<typename std::decay<FO>::type>::value
+        && is_invocable<typename std::remove_reference<FO>::type>::value
+    , int>::type;
+
+public:
+    template <typename FO, enable_for_object<FO> = 0>
+    function_ref(FO&& f) noexcept
+    {
+        using fo_t = typename std::remove_reference<FO>::type;
+        m_target.obj = const_cast<void*>(static_cast<const volatile void*>(std::addressof(f)));
+        m_thunk = &invoke_obj<fo_t>;
+    }
+
+    template <typename FR, typename... FArgs>
+    function_ref(FR (*fptr)(FArgs...)) noexcept
+    {
+        using fp_t = FR(*)(FArgs...);
+        static_assert(is_invocable<fp_t>::value, "function pointer is not compatible with function_ref signature");
+        assert(fptr && "function_ref can't be null");
+        m_target.func = reinterpret_cast<void (*)()>(fptr);
+        m_thunk = &invoke_func<fp_t>;
+    }
+
+    function_ref(std::nullptr_t) = delete;
+
+    function_ref(const function_ref&) noexcept = default;
+    function_ref& operator=(const function_ref&) noexcept = default;
+
+    // don't allow assigning temporary callables
+    // this would make things like `fref = [] { ... };` compile and dangle
+    template <typename FO, enable_for_object<FO> = 0,
+        typename std::enable_if<!std::is_lvalue_reference<FO>::value, int>::type = 0>
+    function_ref& operator=(FO&&) = delete;
+
+    R operator()(Args... args) const
+    {
+        return m_thunk(m_target, std::forward<Args>(args)...);
+    }
+};
+
+}
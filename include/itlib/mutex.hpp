@@ -1,10 +1,10 @@
-// itlib-mutex v0.01 alpha
+// itlib-mutex v0.03 alpha
 //
 // Mutex types to extend the existing standard mutexes
 //
 // SPDX-License-Identifier: MIT
 // MIT License:
-// Copyright(c) 2021 Borislav Stanimirov
+// Copyright(c) 2021-2026 Borislav Stanimirov
 //
 // Permission is hereby granted, free of charge, to any person obtaining
 // a copy of this software and associated documentation files(the
@@ -28,6 +28,8 @@
 //
 //                  VERSION HISTORY
 //
+//  0.03 (2026-10-16) adaptive_mutex and adaptive_shared_mutex
+//  0.02 (2026-10-16) instrumented_mutex
 //  0.01 (2021-10-24) Initial release
 //
 //
@@ -44,11 +46,40 @@
 // * try: blocking is not supported. Only try_lock
 // * strong: no spurious behavior. try_lock guarantees a lock exists
 // * rec: recursive. Recursive locks from the same thread are supported
+// * shared: lock_shared and unlock_shared are supported
+// * adaptive: spin for a while before blocking
 //
 // Defined types:
 // * strong_try_rec_mutex
 //   Basically the only difference between this and std::recursive_mutex is the
 //   guarantee that try_lock has no spurious false returns
+// * adaptive_mutex, adaptive_shared_mutex
+//   Mutexes for short critical sections. When the mutex is locked, lock spins
+//   with exponential backoff (and a pause instruction) for a bounded number of
+//   iterations (a few microseconds) hoping that it will be unlocked soon. Only
+//   then does the thread block. With C++20 blocking is std::atomic::wait (a
+//   futex or the equivalent) and an uncontended lock/unlock doesn't enter the
+//   kernel. Before C++20 an internal std::mutex and std::condition_variable
+//   are used for blocking. On single-core machines there is no spinning.
+//   adaptive_shared_mutex also has the shared lock functions. It makes no
+//   fairness guarantees: a steady stream of readers can starve writers
+// * instrumented_mutex<Mutex = std::mutex>
+//   A wrapper of another mutex which collects contention statistics. It has
+//   the interface of Mutex (lock, try_lock, unlock, and the shared variants if
+//   Mutex has them), so it can be used as the Mutex argument of data_mutex to
+//   find out which lock is hot. stats() returns a snapshot of:
+//   * acquisitions, shared_acquisitions - successful locks
+//   * contended - acquisitions which had to wait (try_lock failed first)
+//   * failed_try_locks - try_lock and try_lock_shared which returned false
+//   * total_wait_ns, max_wait_ns, wait_histogram - time spent waiting in
+//     contended acquisitions. Bucket i of the histogram counts the waits
+//     shorter than wait_bucket_limit_ns(i) (1us * 2^i). The last bucket counts
+//     the rest
+//   * total_hold_ns, max_hold_ns - time between lock and unlock (only for
+//     exclusive locks. Shared locks can overlap and are not timed)
+//   reset_stats() zeroes the counters. Uncontended acquisitions cost a
+//   try_lock and a few relaxed atomic increments, plus a clock read for the
+//   hold time of exclusive locks
 //
 //                  TESTS
 //
@@ -59,8 +90,22 @@
 
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <cassert>
 
+#if __cplusplus >= 202000 && defined(__cpp_lib_atomic_wait)
+#   define ITLIB_MUTEX_ATOMIC_WAIT 1
+#else
+#   define ITLIB_MUTEX_ATOMIC_WAIT 0
+#   include <condition_variable>
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#   include <intrin.h>
+#endif
+
 namespace itlib
 {
 
@@ -103,4 +148,385 @@ private:
     std::int_fast32_t m_depth = 0; // recursion depth
 };
 
+namespace impl
+{
+
+inline void cpu_pause()
+{
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    _mm_pause();
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    __builtin_ia32_pause();
+#elif defined(__GNUC__) && (defined(__aarch64__) || defined(__arm__))
+    asm volatile("yield");
+#endif
+}
+
+// spin with exponential backoff until try_acquire succeeds or the budget is exhausted
+template <typename TryAcquire>
+bool spin_try(TryAcquire try_acquire)
+{
+    static const bool multicore = std::thread::hardware_concurrency() > 1;
+    if (!multicore) return false;
+    for (uint32_t backoff = 1; backoff <= 128; backoff *= 2)
+    {
+        for (uint32_t i = 0; i < backoff; ++i)
+        {
+            cpu_pause();
+        }
+        if (try_acquire()) return true;
+    }
+    return false;
+}
+
+// an atomic word which threads can block on until it changes
+class parking_word
+{
+public:
+    explicit parking_word(uint32_t v) : m_value(v) {}
+
+    std::atomic<uint32_t>& value() { return m_value; }
+
+    // block while the value equals old
+    void wait(uint32_t old)
+    {
+#if ITLIB_MUTEX_ATOMIC_WAIT
+        m_value.wait(old, std::memory_order_relaxed);
+#else
+        std::unique_lock<std::mutex> l(m_mutex);
+        m_cv.wait(l, [&]() { return m_value.load(std::memory_order_relaxed) != old; });
+#endif
+    }
+
+    // must be called after the value has been changed
+    void notify_one()
+    {
+#if ITLIB_MUTEX_ATOMIC_WAIT
+        m_value.notify_one();
+#else
+        { std::lock_guard<std::mutex> l(m_mutex); }
+        m_cv.notify_one();
+#endif
+    }
+
+    void notify_all()
+    {
+#if ITLIB_MUTEX_ATOMIC_WAIT
+        m_value.notify_all();
+#else
+        { std::lock_guard<std::mutex> l(m_mutex); }
+        m_cv.notify_all();
+#endif
+    }
+
+private:
+    std::atomic<uint32_t> m_value;
+#if !ITLIB_MUTEX_ATOMIC_WAIT
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+#endif
+};
+
+}
+
+class adaptive_mutex
+{
+public:
+    adaptive_mutex() = default;
+    adaptive_mutex(const adaptive_mutex&) = delete;
+    adaptive_mutex& operator=(const adaptive_mutex&) = delete;
+
+    bool try_lock()
+    {
+        uint32_t expected = unlocked;
+        return state().compare_exchange_strong(expected, locked, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void lock()
+    {
+        if (try_lock()) return;
+        if (impl::spin_try([this]() { return state().load(std::memory_order_relaxed) == unlocked && try_lock(); })) return;
+
+        // mark as contended so that unlock wakes us
+        while (state().exchange(contended, std::memory_order_acquire) != unlocked)
+        {
+            m_word.wait(contended);
+        }
+    }
+
+    void unlock()
+    {
+        if (state().exchange(unlocked, std::memory_order_release) == contended)
+        {
+            m_word.notify_one();
+        }
+    }
+
+private:
+    static constexpr uint32_t unlocked = 0;
+    static constexpr uint32_t locked = 1;
+    static constexpr uint32_t contended = 2; // locked and there may be blocked threads
+
+    std::atomic<uint32_t>& state() { return m_word.value(); }
+
+    impl::parking_word m_word{unlocked};
+};
+
+class adaptive_shared_mutex
+{
+public:
+    adaptive_shared_mutex() = default;
+    adaptive_shared_mutex(const adaptive_shared_mutex&) = delete;
+    adaptive_shared_mutex& operator=(const adaptive_shared_mutex&) = delete;
+
+    bool try_lock()
+    {
+        auto s = state().load(std::memory_order_relaxed);
+        while (!(s & (writer | readers_mask)))
+        {
+            if (state().compare_exchange_weak(s, s | writer, std::memory_order_acquire, std::memory_order_relaxed)) return true;
+        }
+        return false;
+    }
+
+    void lock()
+    {
+        if (try_lock()) return;
+        if (impl::spin_try([this]() { return try_lock(); })) return;
+        while (!try_lock())
+        {
+            park(writer | readers_mask);
+        }
+    }
+
+    void unlock()
+    {
+        // while the writer holds the lock, the only other bit which can be set is waiting
+        if (state().exchange(0, std::memory_order_release) & waiting)
+        {
+            m_word.notify_all();
+        }
+    }
+
+    bool try_lock_shared()
+    {
+        auto s = state().load(std::memory_order_relaxed);
+        while (!(s & writer))
+        {
+            assert((s & readers_mask) != readers_mask);
+            if (state().compare_exchange_weak(s, s + 1, std::memory_order_acquire, std::memory_order_relaxed)) return true;
+        }
+        return false;
+    }
+
+    void lock_shared()
+    {
+        if (try_lock_shared()) return;
+        if (impl::spin_try([this]() { return try_lock_shared(); })) return;
+        while (!try_lock_shared())
+        {
+            park(writer);
+        }
+    }
+
+    void unlock_shared()
+    {
+        auto s = state().fetch_sub(1, std::memory_order_release);
+        assert(s & readers_mask);
+        // the last reader wakes the writers
+        if ((s & readers_mask) == 1 && (s & waiting))
+        {
+            state().fetch_and(~waiting, std::memory_order_relaxed);
+            m_word.notify_all();
+        }
+    }
+
+private:
+    static constexpr uint32_t writer = 1u << 31;
+    static constexpr uint32_t waiting = 1u << 30; // there may be blocked threads
+    static constexpr uint32_t readers_mask = waiting - 1;
+
+    std::atomic<uint32_t>& state() { return m_word.value(); }
+
+    // block while any of the busy bits are set
+    void park(uint32_t busy)
+    {
+        auto s = state().load(std::memory_order_relaxed);
+        while (s & busy)
+        {
+            if ((s & waiting) || state().compare_exchange_weak(s, s | waiting, std::memory_order_relaxed))
+            {
+                m_word.wait(s | waiting);
+                return;
+            }
+        }
+    }
+
+    impl::parking_word m_word{0};
+};
+
+struct mutex_stats
+{
+    static constexpr int num_wait_buckets = 16;
+
+    uint64_t acquisitions;
+    uint64_t shared_acquisitions;
+    uint64_t contended;
+    uint64_t failed_try_locks;
+    uint64_t total_wait_ns;
+    uint64_t max_wait_ns;
+    uint64_t total_hold_ns;
+    uint64_t max_hold_ns;
+    uint64_t wait_histogram[num_wait_buckets];
+
+    // upper limit of wait_histogram[i] (the last bucket has no limit)
+    static constexpr uint64_t wait_bucket_limit_ns(int i) { return uint64_t(1000) << i; }
+};
+
+template <typename Mutex = std::mutex>
+class instrumented_mutex
+{
+public:
+    instrumented_mutex() { reset_stats(); }
+
+    instrumented_mutex(const instrumented_mutex&) = delete;
+    instrumented_mutex& operator=(const instrumented_mutex&) = delete;
+
+    void lock()
+    {
+        if (!m_mutex.try_lock())
+        {
+            auto start = now();
+            m_mutex.lock();
+            on_wait(now() - start);
+        }
+        inc(m_acquisitions);
+        m_lock_time = now();
+    }
+
+    bool try_lock()
+    {
+        if (!m_mutex.try_lock())
+        {
+            inc(m_failed_try_locks);
+            return false;
+        }
+        inc(m_acquisitions);
+        m_lock_time = now();
+        return true;
+    }
+
+    void unlock()
+    {
+        const uint64_t hold = now() - m_lock_time;
+        m_mutex.unlock();
+        m_total_hold_ns.fetch_add(hold, std::memory_order_relaxed);
+        update_max(m_max_hold_ns, hold);
+    }
+
+    void lock_shared()
+    {
+        if (!m_mutex.try_lock_shared())
+        {
+            auto start = now();
+            m_mutex.lock_shared();
+            on_wait(now() - start);
+        }
+        inc(m_shared_acquisitions);
+    }
+
+    bool try_lock_shared()
+    {
+        if (!m_mutex.try_lock_shared())
+        {
+            inc(m_failed_try_locks);
+            return false;
+        }
+        inc(m_shared_acquisitions);
+        return true;
+    }
+
+    void unlock_shared()
+    {
+        m_mutex.unlock_shared();
+    }
+
+    mutex_stats stats() const
+    {
+        mutex_stats ret;
+        ret.acquisitions = load(m_acquisitions);
+        ret.shared_acquisitions = load(m_shared_acquisitions);
+        ret.contended = load(m_contended);
+        ret.failed_try_locks = load(m_failed_try_locks);
+        ret.total_wait_ns = load(m_total_wait_ns);
+        ret.max_wait_ns = load(m_max_wait_ns);
+        ret.total_hold_ns = load(m_total_hold_ns);
+        ret.max_hold_ns = load(m_max_hold_ns);
+        for (int i = 0; i < mutex_stats::num_wait_buckets; ++i)
+        {
+            ret.wait_histogram[i] = load(m_wait_histogram[i]);
+        }
+        return ret;
+    }
+
+    void reset_stats()
+    {
+        m_acquisitions = 0;
+        m_shared_acquisitions = 0;
+        m_contended = 0;
+        m_failed_try_locks = 0;
+        m_total_wait_ns = 0;
+        m_max_wait_ns = 0;
+        m_total_hold_ns = 0;
+        m_max_hold_ns = 0;
+        for (auto& b : m_wait_histogram)
+        {
+            b = 0;
+        }
+    }
+
+private:
+    using counter = std::atomic<uint64_t>;
+
+    static uint64_t now()
+    {
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    static void inc(counter& c) { c.fetch_add(1, std::memory_order_relaxed); }
+    static uint64_t load(const counter& c) { return c.load(std::memory_order_relaxed); }
+
+    static void update_max(counter& c, uint64_t val)
+    {
+        auto cur = c.load(std::memory_order_relaxed);
+        while (cur < val && !c.compare_exchange_weak(cur, val, std::memory_order_relaxed));
+    }
+
+    void on_wait(uint64_t wait)
+    {
+        inc(m_contended);
+        m_total_wait_ns.fetch_add(wait, std::memory_order_relaxed);
+        update_max(m_max_wait_ns, wait);
+        int b = 0;
+        while (b < mutex_stats::num_wait_buckets - 1 && wait >= mutex_stats::wait_bucket_limit_ns(b)) ++b;
+        inc(m_wait_histogram[b]);
+    }
+
+    Mutex m_mutex;
+
+    // only accessed by the owner of an exclusive lock
+    uint64_t m_lock_time = 0;
+
+    counter m_acquisitions;
+    counter m_shared_acquisitions;
+    counter m_contended;
+    counter m_failed_try_locks;
+    counter m_total_wait_ns;
+    counter m_max_wait_ns;
+    counter m_total_hold_ns;
+    counter m_max_hold_ns;
+    counter m_wait_histogram[mutex_stats::num_wait_buckets];
+};
+
 }
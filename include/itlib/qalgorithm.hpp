@@ -1,10 +1,10 @@
-// itlib-qalgorithm v1.03
+// itlib-qalgorithm v1.05
 //
 // Wrappers of <algorithm> algorithms for entire containers
 //
 // SPDX-License-Identifier: MIT
 // MIT License:
-// Copyright(c) 2020-2023 Borislav Stanimirov
+// Copyright(c) 2020-2026 Borislav Stanimirov
 //
 // Permission is hereby granted, free of charge, to any person obtaining
 // a copy of this software and associated documentation files(the
@@ -28,6 +28,9 @@
 //
 //                  VERSION HISTORY
 //
+//  1.05 (2026-10-16) par_erase_all_if, par_qany_of, par_pfind_if
+//  1.04 (2026-10-16) SIMD search kernels for contiguous containers of integers,
+//                    qcount, qcontains
 //  1.03 (2023-02-07) qall_of, qany_of, qnone_of, identity
 //  1.02 (2022-11-29) span-compatible pfind and pfind_if
 //  1.01 (2020-12-29) Added erase functions
@@ -50,9 +53,47 @@
 // * bool qall_of(container, pred = identity) - checks if all elements evaluate to true with predicate
 // * bool qany_of(container, pred = identity) - checks if any elements evaluate to true with predicate
 // * bool qnone_of(container, pred = identity) - checks if no elements evaluate to true with predicate
+// * size_t qcount(container, value) - wraps std::count, returns the number of elements equal to value
+// * bool qcontains(container, value) - checks if any element is equal to value
+//
+// qfind, pfind, erase_first, erase_all, qcount, and qcontains are accelerated
+// with SIMD instructions when:
+// * the target is x86-64
+// * the container is contiguous: its iterators are pointers, they are contiguous
+//   iterators (C++20), or the container is std::vector, std::basic_string, or std::array
+// * the container's value_type and the searched value are integers (but not bool)
+// The kernels use SSE2 which is always available on x86-64. AVX2 is used if
+// the CPU supports it. The check is performed once at runtime, so no special
+// compiler flags are needed. Searched values which don't fit in the container's
+// value_type fall back to the std algorithms. For other targets and containers
+// the std algorithms are used.
+// Define ITLIB_QALGORITHM_NO_SIMD before including the header to disable the
+// SIMD kernels altogether.
+//
+// ... and the following parallel algorithms, which split a container with
+// random access iterators into chunks and process them concurrently:
+// * bool par_qany_of(container, pred, [executor]) - like qany_of. Stops all chunks once a match is found
+// * pointer par_pfind_if(container, pred, [executor]) - like pfind_if. Returns the *first* match.
+//      Chunks after a found match stop early
+// * size_t par_erase_all_if(container, pred, [executor]) - like erase_all_if. The chunks are
+//      compacted in parallel, then moved together serially (which amounts to a memmove for
+//      trivial types)
+// The predicate is called concurrently from multiple threads, so it must be safe to do so.
+// Containers with fewer than `par_min_chunk_size` elements per thread are split in fewer
+// chunks. Small ones are processed on the calling thread without involving the executor.
+//
+// The executor is where the chunks are run. It can be an adapter for your thread pool.
+// It must provide:
+// * size_t concurrency() const - the number of chunks to split a container into
+// * void operator()(size_t count, Task& task) - call task(i) for each i in [0, count),
+//      possibly concurrently, and return when all calls have completed
+// When no executor is provided `std_thread_executor` is used. It spawns count-1 std::thread-s
+// on each call and runs the first task on the calling thread. Exceptions from tasks are
+// rethrown on the calling thread.
 //
 // ... and the following types:
 // * identity - an identity unary predicate similar to C++20's std::identity
+// * std_thread_executor - the default executor for the parallel algorithms
 //
 //                  TESTS
 //
@@ -64,6 +105,31 @@
 #include <utility>
 #include <algorithm>
 #include <type_traits>
+#include <iterator>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <array>
+#include <exception>
+
+#if !defined(ITLIB_QALGORITHM_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64))
+#   define ITLIB_QALGORITHM_SIMD 1
+#   include <immintrin.h>
+#   if defined(_MSC_VER)
+#       include <intrin.h>
+#   endif
+#   if defined(__GNUC__) || defined(__clang__)
+#       define I_ITLIB_QALGORITHM_AVX2 __attribute__((target("avx2")))
+#   else
+#       define I_ITLIB_QALGORITHM_AVX2
+#   endif
+#else
+#   define ITLIB_QALGORITHM_SIMD 0
+#endif
 
 namespace itlib
 {
@@ -81,18 +147,426 @@ struct pointer_t
 {
     using type = typename std::conditional<std::is_const<Container>::value, typename Container::const_pointer, typename Container::pointer>::type;
 };
+
+namespace qsimd
+{
+template <typename T>
+struct is_element : std::integral_constant<bool,
+    std::is_integral<T>::value && !std::is_same<T, bool>::value
+    && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)
+> {};
+
+template <typename...> struct make_void { typedef void type; };
+
+// containers whose iterators are contiguous, but not raw pointers
+// a pointer-returning data() and random access iterators are not enough (think stride_span)
+template <typename Container>
+struct is_contiguous : std::false_type {};
+template <typename T, typename Alloc>
+struct is_contiguous<std::vector<T, Alloc>> : std::true_type {};
+template <typename C, typename Traits, typename Alloc>
+struct is_contiguous<std::basic_string<C, Traits, Alloc>> : std::true_type {};
+template <typename T, size_t N>
+struct is_contiguous<std::array<T, N>> : std::true_type {};
+
+template <typename Iterator>
+struct is_contiguous_iterator : std::integral_constant<bool,
+#if defined(__cpp_lib_concepts)
+    std::contiguous_iterator<Iterator>
+#else
+    false
+#endif
+> {};
+
+template <typename Container, typename = void>
+struct is_container : std::false_type {};
+
+template <typename Container>
+struct is_container<Container, typename make_void<decltype(std::declval<Container&>().data())>::type>
+{
+    using data_t = decltype(std::declval<Container&>().data());
+    using iterator = decltype(std::declval<Container&>().begin());
+    using value_type = typename std::remove_cv<typename std::remove_pointer<data_t>::type>::type;
+
+    static constexpr bool value = std::is_pointer<data_t>::value
+        && is_element<value_type>::value
+        && std::is_same<typename std::iterator_traits<iterator>::value_type, value_type>::value
+        && (std::is_same<iterator, data_t>::value
+            || is_contiguous_iterator<iterator>::value
+            || is_contiguous<typename std::remove_cv<Container>::type>::value);
+};
+
+template <typename Container, typename Value>
+struct use : std::integral_constant<bool,
+    ITLIB_QALGORITHM_SIMD && is_container<Container>::value && is_element<Value>::value
+> {};
+
+template <typename V>
+bool is_negative(V v, std::true_type) { return v < V(0); }
+template <typename V>
+bool is_negative(V, std::false_type) { return false; }
+
+// true if v can be represented in T
+// in such case `elem == v` is equivalent to `elem == T(v)`
+template <typename T, typename V>
+bool in_range(V v)
+{
+    const T t = static_cast<T>(v);
+    return static_cast<V>(t) == v
+        && is_negative(t, std::is_signed<T>{}) == is_negative(v, std::is_signed<V>{});
+}
+
+#if ITLIB_QALGORITHM_SIMD
+
+inline unsigned ctz(uint32_t m)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long ret;
+    _BitScanForward(&ret, m);
+    return unsigned(ret);
+#else
+    return unsigned(__builtin_ctz(m));
+#endif
+}
+
+inline unsigned popcount(uint32_t m)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    // __popcnt requires the POPCNT instruction which is not guaranteed on x86-64
+    m = m - ((m >> 1) & 0x55555555u);
+    m = (m & 0x33333333u) + ((m >> 2) & 0x33333333u);
+    return unsigned((((m + (m >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24);
+#else
+    return unsigned(__builtin_popcount(m));
+#endif
+}
+
+inline bool detect_avx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int r[4];
+    __cpuid(r, 0);
+    if (r[0] < 7) return false;
+    __cpuid(r, 1);
+    const int osxsave_avx = (1 << 27) | (1 << 28);
+    if ((r[2] & osxsave_avx) != osxsave_avx) return false;
+    if ((_xgetbv(0) & 6) != 6) return false; // os saves xmm and ymm registers
+    __cpuidex(r, 7, 0);
+    return (r[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+inline bool has_avx2()
+{
+    static const bool ret = detect_avx2();
+    return ret;
+}
+
+// comparisons per element size
+// movemask of the result has sizeof(T) bits set for each matching element
+
+template <size_t Size> struct sse2;
+template <> struct sse2<1>
+{
+    template <typename T>
+    static __m128i set1(T v) { return _mm_set1_epi8(static_cast<char>(v)); }
+    static __m128i eq(__m128i a, __m128i b) { return _mm_cmpeq_epi8(a, b); }
+};
+template <> struct sse2<2>
+{
+    template <typename T>
+    static __m128i set1(T v) { return _mm_set1_epi16(static_cast<short>(v)); }
+    static __m128i eq(__m128i a, __m128i b) { return _mm_cmpeq_epi16(a, b); }
+};
+template <> struct sse2<4>
+{
+    template <typename T>
+    static __m128i set1(T v) { return _mm_set1_epi32(static_cast<int>(v)); }
+    static __m128i eq(__m128i a, __m128i b) { return _mm_cmpeq_epi32(a, b); }
+};
+template <> struct sse2<8>
+{
+    template <typename T>
+    static __m128i set1(T v) { return _mm_set1_epi64x(static_cast<long long>(v)); }
+    static __m128i eq(__m128i a, __m128i b)
+    {
+        // no _mm_cmpeq_epi64 in SSE2: both 32-bit halves must match
+        const __m128i e = _mm_cmpeq_epi32(a, b);
+        return _mm_and_si128(e, _mm_shuffle_epi32(e, _MM_SHUFFLE(2, 3, 0, 1)));
+    }
+};
+
+template <size_t Size> struct avx2;
+template <> struct avx2<1>
+{
+    template <typename T>
+    I_ITLIB_QALGORITHM_AVX2 static __m256i set1(T v) { return _mm256_set1_epi8(static_cast<char>(v)); }
+    I_ITLIB_QALGORITHM_AVX2 static __m256i eq(__m256i a, __m256i b) { return _mm256_cmpeq_epi8(a, b); }
+};
+template <> struct avx2<2>
+{
+    template <typename T>
+    I_ITLIB_QALGORITHM_AVX2 static __m256i set1(T v) { return _mm256_set1_epi16(static_cast<short>(v)); }
+    I_ITLIB_QALGORITHM_AVX2 static __m256i eq(__m256i a, __m256i b) { return _mm256_cmpeq_epi16(a, b); }
+};
+template <> struct avx2<4>
+{
+    template <typename T>
+    I_ITLIB_QALGORITHM_AVX2 static __m256i set1(T v) { return _mm256_set1_epi32(static_cast<int>(v)); }
+    I_ITLIB_QALGORITHM_AVX2 static __m256i eq(__m256i a, __m256i b) { return _mm256_cmpeq_epi32(a, b); }
+};
+template <> struct avx2<8>
+{
+    template <typename T>
+    I_ITLIB_QALGORITHM_AVX2 static __m256i set1(T v) { return _mm256_set1_epi64x(static_cast<long long>(v)); }
+    I_ITLIB_QALGORITHM_AVX2 static __m256i eq(__m256i a, __m256i b) { return _mm256_cmpeq_epi64(a, b); }
+};
+
+// kernels
+// the avx2 and sse2 ones are identical except for the intrinsics
+// they can't share code as everything inlined in an avx2 function must also be compiled for avx2
+
+template <typename T>
+size_t sse2_find(const T* p, size_t n, T v)
+{
+    using cmp = sse2<sizeof(T)>;
+    const size_t lanes = 16 / sizeof(T);
+    const __m128i vv = cmp::set1(v);
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const uint32_t m = uint32_t(_mm_movemask_epi8(cmp::eq(a, vv)));
+        if (m) return i + ctz(m) / sizeof(T);
+    }
+    for (; i < n; ++i)
+    {
+        if (p[i] == v) return i;
+    }
+    return n;
+}
+
+template <typename T>
+I_ITLIB_QALGORITHM_AVX2 size_t avx2_find(const T* p, size_t n, T v)
+{
+    using cmp = avx2<sizeof(T)>;
+    const size_t lanes = 32 / sizeof(T);
+    const __m256i vv = cmp::set1(v);
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        const uint32_t m = uint32_t(_mm256_movemask_epi8(cmp::eq(a, vv)));
+        if (m) return i + ctz(m) / sizeof(T);
+    }
+    for (; i < n; ++i)
+    {
+        if (p[i] == v) return i;
+    }
+    return n;
+}
+
+template <typename T>
+size_t sse2_count(const T* p, size_t n, T v)
+{
+    using cmp = sse2<sizeof(T)>;
+    const size_t lanes = 16 / sizeof(T);
+    const __m128i vv = cmp::set1(v);
+    size_t ret = 0;
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        ret += popcount(uint32_t(_mm_movemask_epi8(cmp::eq(a, vv))));
+    }
+    ret /= sizeof(T);
+    for (; i < n; ++i)
+    {
+        ret += p[i] == v;
+    }
+    return ret;
+}
+
+template <typename T>
+I_ITLIB_QALGORITHM_AVX2 size_t avx2_count(const T* p, size_t n, T v)
+{
+    using cmp = avx2<sizeof(T)>;
+    const size_t lanes = 32 / sizeof(T);
+    const __m256i vv = cmp::set1(v);
+    size_t ret = 0;
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        ret += popcount(uint32_t(_mm256_movemask_epi8(cmp::eq(a, vv))));
+    }
+    ret /= sizeof(T);
+    for (; i < n; ++i)
+    {
+        ret += p[i] == v;
+    }
+    return ret;
+}
+
+// returns the new size
+// blocks with no matches are moved with a single store
+// the store at `out <= i` only overlaps the block which has already been loaded
+template <typename T>
+size_t sse2_remove(T* p, size_t n, T v)
+{
+    using cmp = sse2<sizeof(T)>;
+    const size_t lanes = 16 / sizeof(T);
+    const __m128i vv = cmp::set1(v);
+    size_t out = 0;
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const uint32_t m = uint32_t(_mm_movemask_epi8(cmp::eq(a, vv)));
+        if (!m)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(p + out), a);
+            out += lanes;
+        }
+        else
+        {
+            for (size_t j = 0; j < lanes; ++j)
+            {
+                if (!(m & (1u << (j * sizeof(T))))) p[out++] = p[i + j];
+            }
+        }
+    }
+    for (; i < n; ++i)
+    {
+        if (p[i] != v) p[out++] = p[i];
+    }
+    return out;
+}
+
+template <typename T>
+I_ITLIB_QALGORITHM_AVX2 size_t avx2_remove(T* p, size_t n, T v)
+{
+    using cmp = avx2<sizeof(T)>;
+    const size_t lanes = 32 / sizeof(T);
+    const __m256i vv = cmp::set1(v);
+    size_t out = 0;
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        const uint32_t m = uint32_t(_mm256_movemask_epi8(cmp::eq(a, vv)));
+        if (!m)
+        {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(p + out), a);
+            out += lanes;
+        }
+        else
+        {
+            for (size_t j = 0; j < lanes; ++j)
+            {
+                if (!(m & (1u << (j * sizeof(T))))) p[out++] = p[i + j];
+            }
+        }
+    }
+    for (; i < n; ++i)
+    {
+        if (p[i] != v) p[out++] = p[i];
+    }
+    return out;
+}
+
+// dispatch
+// buffers smaller than a single avx2 register don't benefit from the extra check
+
+template <typename T>
+size_t find(const T* p, size_t n, T v)
+{
+    if (n * sizeof(T) >= 32 && has_avx2()) return avx2_find(p, n, v);
+    return sse2_find(p, n, v);
+}
+
+template <typename T>
+size_t count(const T* p, size_t n, T v)
+{
+    if (n * sizeof(T) >= 32 && has_avx2()) return avx2_count(p, n, v);
+    return sse2_count(p, n, v);
+}
+
+template <typename T>
+size_t remove(T* p, size_t n, T v)
+{
+    if (n * sizeof(T) >= 32 && has_avx2()) return avx2_remove(p, n, v);
+    return sse2_remove(p, n, v);
 }
 
+#else
+
+template <typename T>
+size_t find(const T* p, size_t n, T v) { return size_t(std::find(p, p + n, v) - p); }
+template <typename T>
+size_t count(const T* p, size_t n, T v) { return size_t(std::count(p, p + n, v)); }
+template <typename T>
+size_t remove(T* p, size_t n, T v) { return size_t(std::remove(p, p + n, v) - p); }
+
+#endif
+} // namespace qsimd
+
 template <typename Container, typename Value>
-typename impl::iterator_t<Container>::type qfind(Container& c, const Value& val)
+typename iterator_t<Container>::type qfind(Container& c, const Value& val, std::false_type)
 {
     return std::find(c.begin(), c.end(), val);
 }
 
+template <typename Container, typename Value>
+typename iterator_t<Container>::type qfind(Container& c, const Value& val, std::true_type)
+{
+    using T = typename qsimd::is_container<Container>::value_type;
+    if (!qsimd::in_range<T>(val)) return std::find(c.begin(), c.end(), val);
+    return c.begin() + qsimd::find(c.data(), c.size(), static_cast<T>(val));
+}
+
+template <typename Container, typename Value>
+typename Container::size_type qcount(const Container& c, const Value& val, std::false_type)
+{
+    return typename Container::size_type(std::count(c.begin(), c.end(), val));
+}
+
+template <typename Container, typename Value>
+typename Container::size_type qcount(const Container& c, const Value& val, std::true_type)
+{
+    using T = typename qsimd::is_container<const Container>::value_type;
+    if (!qsimd::in_range<T>(val)) return qcount(c, val, std::false_type{});
+    return typename Container::size_type(qsimd::count(c.data(), c.size(), static_cast<T>(val)));
+}
+
+template <typename Container, typename Value>
+typename Container::iterator remove(Container& c, const Value& val, std::false_type)
+{
+    return std::remove(c.begin(), c.end(), val);
+}
+
+template <typename Container, typename Value>
+typename Container::iterator remove(Container& c, const Value& val, std::true_type)
+{
+    using T = typename qsimd::is_container<Container>::value_type;
+    if (c.empty() || !qsimd::in_range<T>(val)) return std::remove(c.begin(), c.end(), val);
+    // not data() as std::string::data() is const before C++17
+    return c.begin() + qsimd::remove(&*c.begin(), c.size(), static_cast<T>(val));
+}
+}
+
+template <typename Container, typename Value>
+typename impl::iterator_t<Container>::type qfind(Container& c, const Value& val)
+{
+    return impl::qfind(c, val, impl::qsimd::use<Container, Value>{});
+}
+
 template <typename Container, typename Value>
 typename impl::pointer_t<Container>::type pfind(Container& c, const Value& val)
 {
-    auto f = std::find(c.begin(), c.end(), val);
+    auto f = qfind(c, val);
     if (f == c.end()) return nullptr;
     return &(*f);
 }
@@ -132,7 +606,7 @@ bool erase_first_if(Container& c, Pred&& pred)
 template <typename Container, typename Value>
 typename Container::size_type erase_all(Container& c, const Value& val)
 {
-    auto newend = std::remove(c.begin(), c.end(), val);
+    auto newend = impl::remove(c, val, impl::qsimd::use<Container, Value>{});
     auto ret = c.end() - newend;
     c.erase(newend, c.end());
     return ret;
@@ -166,4 +640,212 @@ bool qnone_of(const Container& c, Pred&& pred) { return std::none_of(c.begin(),
 template <typename Container>
 bool qnone_of(const Container& c) { return qnone_of(c, identity{}); }
 
+template <typename Container, typename Value>
+typename Container::size_type qcount(const Container& c, const Value& val)
+{
+    return impl::qcount(c, val, impl::qsimd::use<const Container, Value>{});
+}
+
+template <typename Container, typename Value>
+bool qcontains(const Container& c, const Value& val)
+{
+    return qfind(c, val) != c.end();
+}
+
+
+static constexpr size_t par_min_chunk_size = 16 * 1024;
+
+class std_thread_executor
+{
+public:
+    std_thread_executor() noexcept
+        : m_max_threads(std::thread::hardware_concurrency())
+    {}
+
+    explicit std_thread_executor(size_t max_threads) noexcept
+        : m_max_threads(max_threads)
+    {}
+
+    size_t concurrency() const noexcept { return m_max_threads ? m_max_threads : 1; }
+
+    template <typename Task>
+    void operator()(size_t count, Task& task) const
+    {
+        std::exception_ptr ex;
+        std::mutex ex_mutex;
+        auto run = [&](size_t i)
+        {
+            try
+            {
+                task(i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> l(ex_mutex);
+                if (!ex) ex = std::current_exception();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(count);
+        try
+        {
+            for (size_t i = 1; i < count; ++i)
+            {
+                threads.emplace_back(run, i);
+            }
+        }
+        catch (...)
+        {
+            for (auto& t : threads) t.join();
+            throw;
+        }
+
+        if (count) run(0);
+        for (auto& t : threads) t.join();
+
+        if (ex) std::rethrow_exception(ex);
+    }
+
+private:
+    size_t m_max_threads;
+};
+
+namespace impl
+{
+template <typename Executor>
+size_t par_num_chunks(const Executor& exec, size_t size)
+{
+    const size_t max_chunks = size / par_min_chunk_size;
+    const size_t c = exec.concurrency();
+    return c < max_chunks ? c : max_chunks;
+}
+
+// the range of the i-th of num_chunks chunks in a container of a given size
+inline std::pair<size_t, size_t> par_chunk(size_t i, size_t num_chunks, size_t size)
+{
+    return {size * i / num_chunks, size * (i + 1) / num_chunks};
+}
+}
+
+template <typename Container, typename Pred, typename Executor>
+bool par_qany_of(const Container& c, Pred&& pred, Executor&& exec)
+{
+    const size_t size = c.size();
+    const size_t num_chunks = impl::par_num_chunks(exec, size);
+    if (num_chunks < 2) return qany_of(c, std::forward<Pred>(pred));
+
+    // how often the chunks check whether someone else has found a match
+    static constexpr size_t block_size = 1024;
+
+    std::atomic<bool> found(false);
+    auto begin = c.begin();
+    auto task = [&](size_t i)
+    {
+        auto range = impl::par_chunk(i, num_chunks, size);
+        for (size_t b = range.first; b < range.second; b += block_size)
+        {
+            if (found.load(std::memory_order_relaxed)) return;
+            const size_t e = std::min(b + block_size, range.second);
+            if (std::any_of(begin + b, begin + e, pred))
+            {
+                found.store(true, std::memory_order_relaxed);
+                return;
+            }
+        }
+    };
+    exec(num_chunks, task);
+    return found.load(std::memory_order_relaxed);
+}
+
+template <typename Container, typename Pred>
+bool par_qany_of(const Container& c, Pred&& pred)
+{
+    return par_qany_of(c, std::forward<Pred>(pred), std_thread_executor{});
+}
+
+template <typename Container, typename Pred, typename Executor>
+typename impl::pointer_t<Container>::type par_pfind_if(Container& c, Pred&& pred, Executor&& exec)
+{
+    const size_t size = c.size();
+    const size_t num_chunks = impl::par_num_chunks(exec, size);
+    if (num_chunks < 2) return pfind_if(c, std::forward<Pred>(pred));
+
+    static constexpr size_t block_size = 1024;
+
+    // index of the first match found so far
+    std::atomic<size_t> first(size);
+    auto begin = c.begin();
+    auto task = [&](size_t i)
+    {
+        auto range = impl::par_chunk(i, num_chunks, size);
+        for (size_t b = range.first; b < range.second; b += block_size)
+        {
+            // a match before this block was found, nothing here can be first
+            if (first.load(std::memory_order_relaxed) < b) return;
+            const size_t e = std::min(b + block_size, range.second);
+            auto f = std::find_if(begin + b, begin + e, pred);
+            if (f != begin + e)
+            {
+                size_t index = size_t(f - begin);
+                size_t cur = first.load(std::memory_order_relaxed);
+                while (index < cur && !first.compare_exchange_weak(cur, index, std::memory_order_relaxed));
+                return;
+            }
+        }
+    };
+    exec(num_chunks, task);
+
+    const size_t index = first.load(std::memory_order_relaxed);
+    if (index == size) return nullptr;
+    return &(*(begin + index));
+}
+
+template <typename Container, typename Pred>
+typename impl::pointer_t<Container>::type par_pfind_if(Container& c, Pred&& pred)
+{
+    return par_pfind_if(c, std::forward<Pred>(pred), std_thread_executor{});
+}
+
+template <typename Container, typename Pred, typename Executor>
+typename Container::size_type par_erase_all_if(Container& c, Pred&& pred, Executor&& exec)
+{
+    const size_t size = c.size();
+    const size_t num_chunks = impl::par_num_chunks(exec, size);
+    if (num_chunks < 2) return erase_all_if(c, std::forward<Pred>(pred));
+
+    // the end of the remaining elements in each chunk after remove_if
+    std::vector<size_t> chunk_ends(num_chunks);
+    auto begin = c.begin();
+    auto task = [&](size_t i)
+    {
+        auto range = impl::par_chunk(i, num_chunks, size);
+        auto e = std::remove_if(begin + range.first, begin + range.second, pred);
+        chunk_ends[i] = size_t(e - begin);
+    };
+    exec(num_chunks, task);
+
+    // the first chunk is already in place
+    auto out = begin + chunk_ends[0];
+    for (size_t i = 1; i < num_chunks; ++i)
+    {
+        auto range = impl::par_chunk(i, num_chunks, size);
+        auto chunk_begin = begin + range.first;
+        auto chunk_end = begin + chunk_ends[i];
+        // nothing was removed so far: the chunk is already in place (and self-move is not ok)
+        if (out == chunk_begin) out = chunk_end;
+        else out = std::move(chunk_begin, chunk_end, out);
+    }
+
+    auto ret = c.end() - out;
+    c.erase(out, c.end());
+    return typename Container::size_type(ret);
+}
+
+template <typename Container, typename Pred>
+typename Container::size_type par_erase_all_if(Container& c, Pred&& pred)
+{
+    return par_erase_all_if(c, std::forward<Pred>(pred), std_thread_executor{});
+}
+
 }
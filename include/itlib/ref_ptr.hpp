@@ -1,4 +1,4 @@
-// itlib-ref_ptr v1.01
+// itlib-ref_ptr v2.01
 //
 // A ref-counting smart pointer with a stable use_count
 //
@@ -28,6 +28,12 @@
 //
 //                  VERSION HISTORY
 //
+//  2.01 (2026-10-16) * Ref count policy. Added ref_ptr_st: a non-atomic ref_ptr
+//  2.00 (2026-10-16) * Native implementation with an intrusive ref count:
+//                      single allocation, sizeof(ref_ptr) == sizeof(void*)
+//                    * _as_shared_ptr_unsafe returns a shared_ptr which holds
+//                      a reference
+//                    * Removed _from_shared_ptr_unsafe
 //  1.01 (2026-02-03) * nullptr_t constructor and assignment
 //                    * _as_shared_ptr_unsafe return ref to avoid copy
 //  1.00 (2026-01-31) Initial release
@@ -40,11 +46,35 @@
 // ref_ptr is a smart, ref-couting pointer im most ways equivalent to
 // std::shared_ptr, but without weak_ptr support.
 //
-// It is currently implemented through shared_ptr, but can be changed to an
-// optimized custom implementation in the future.
 // Since there is no weak_ptr, use_count() == 1 is reliable and can be used to
 // determine if the state is unique.
 //
+// Unlike std::shared_ptr, ref_ptr is a single pointer. The object and its
+// ref count (plus a destroy function) are created in a single allocation and
+// the ref count lives right before the most derived object. The weak count of
+// shared_ptr's control block is simply not there.
+// The price of this is that a ref_ptr can only be created with the factory
+// functions below (no adopting of raw pointers and custom deleters) and that
+// converting to a ref_ptr of a base requires the base to be polymorphic. When
+// this is the case, the ref count is found through dynamic_cast<void*>
+//
+// REF COUNT POLICY
+// The second template argument of ref_ptr is the ref count policy. It can be:
+// * ref_count_mt (the default) - the ref count is atomic and ref_ptr-s to the
+//   same object can be copied and destroyed from multiple threads
+// * ref_count_st - the ref count is a plain integer. Cheaper copies, but all
+//   ref_ptr-s to an object must be confined to a single thread
+// ref_ptr_st<T> is an alias of ref_ptr<T, ref_count_st>
+// ref_ptr-s with different policies cannot be converted to one another.
+//
+// A custom policy can be provided. It needs to have the following interface:
+// struct my_policy {
+//     using counter = /*...*/; // must be constructible from long
+//     static void inc(counter& c) noexcept; // increment
+//     static bool dec(counter& c) noexcept; // decrement, return true if zero
+//     static long load(const counter& c) noexcept; // get value
+// };
+//
 // An important use case for this is copy-on-write implementations.
 // ref_ptr<const T> would be a detached read-only view of a state.//
 // Since unique() is reliable, a safe "promotion" via a const_cast is possible
@@ -63,14 +93,17 @@
 // is simply not very useful.
 //
 // API:
-// * everything from std::shared_ptr including...
+// * most of std::shared_ptr: get, ->, *, bool, use_count, reset, swap,
+//   comparisons
 // * bool unique() const noexcept; - reliable uniqueness check (which used to
 //   be in std::shared_ptr but was deprecated and removed)
 // * _as_shared_ptr_unsafe() - to get a shared_ptr as a last resort or to
-//   interop with existing APIs
+//   interop with existing APIs. The resulting shared_ptr holds a reference, so
+//   unique() will be false for as long as it's alive
 // * external factory functions:
 //  * make_ref_ptr<T>(Args&&... args) - corresponds to std::make_shared<T>
 //  * make_ref_ptr_from(T&& obj) - creates a ref_ptr by copying/moving a value
+//  * make_ref_ptr_st and make_ref_ptr_st_from - the same for ref_ptr_st
 //
 // Future Ideas:
 // * void support
@@ -84,76 +117,235 @@
 // https://github.com/iboB/itlib/blob/master/test/
 //
 #pragma once
+#include <atomic>
 #include <memory>
 #include <cstddef>
+#include <cstdint>
+#include <new>
 #include <type_traits>
 
 namespace itlib {
 
+struct ref_count_mt {
+    using counter = std::atomic<long>;
+    static void inc(counter& c) noexcept {
+        c.fetch_add(1, std::memory_order_relaxed);
+    }
+    static bool dec(counter& c) noexcept {
+        return c.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+    static long load(const counter& c) noexcept {
+        return c.load(std::memory_order_acquire);
+    }
+};
+
+struct ref_count_st {
+    using counter = long;
+    static void inc(counter& c) noexcept { ++c; }
+    static bool dec(counter& c) noexcept { return --c == 0; }
+    static long load(const counter& c) noexcept { return c; }
+};
+
+namespace impl {
+template <typename RC>
+struct ref_ptr_header {
+    typename RC::counter count;
+    void (*destroy)(ref_ptr_header*);
+
+    ref_ptr_header(void (*d)(ref_ptr_header*)) noexcept : count(1), destroy(d) {}
+};
+
+// the header is always immediately before the object regardless of its alignment
+template <typename T, typename RC>
+struct ref_ptr_block {
+    using header = ref_ptr_header<RC>;
+
+    static constexpr std::size_t obj_offset =
+        (sizeof(header) + alignof(T) - 1) / alignof(T) * alignof(T);
+
+    struct alignas(alignof(T) > alignof(header) ? alignof(T) : alignof(header)) storage {
+        unsigned char buf[obj_offset + sizeof(T)];
+    };
+
+    // before C++17 new doesn't respect over-alignment, so we align manually
+    using manual_align = std::integral_constant<bool,
+#if __cplusplus >= 201700
+        false
+#else
+        (alignof(storage) > alignof(std::max_align_t))
+#endif
+    >;
+
+    static storage* alloc_storage(std::false_type /*manual align*/) {
+        return new storage;
+    }
+    static void free_storage(storage* s, std::false_type /*manual align*/) noexcept {
+        delete s;
+    }
+
+    // the pointer to the raw buffer is stored right before the aligned storage
+    static storage* alloc_storage(std::true_type /*manual align*/) {
+        void* raw = ::operator new(sizeof(storage) + alignof(storage) - 1 + sizeof(void*));
+        auto addr = reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*);
+        addr = (addr + alignof(storage) - 1) & ~std::uintptr_t(alignof(storage) - 1);
+        reinterpret_cast<void**>(addr)[-1] = raw;
+        return new (reinterpret_cast<void*>(addr)) storage;
+    }
+    static void free_storage(storage* s, std::true_type /*manual align*/) noexcept {
+        ::operator delete(reinterpret_cast<void**>(s)[-1]);
+    }
+
+    template <typename... Args>
+    static T* create(Args&&... args) {
+        auto s = alloc_storage(manual_align{});
+        new (s->buf + obj_offset - sizeof(header)) header(&destroy);
+        try {
+            return new (s->buf + obj_offset) T(std::forward<Args>(args)...);
+        }
+        catch (...) {
+            free_storage(s, manual_align{});
+            throw;
+        }
+    }
+
+    static void destroy(header* h) noexcept {
+        auto buf = reinterpret_cast<unsigned char*>(h + 1);
+        reinterpret_cast<T*>(buf)->~T();
+        h->~header();
+        free_storage(reinterpret_cast<storage*>(buf - obj_offset), manual_align{});
+    }
+};
+
 template <typename T>
-class ref_ptr : private std::shared_ptr<T> {
-    template <typename U>
+const volatile void* most_derived(T* ptr, std::true_type /*polymorphic*/) noexcept {
+    return dynamic_cast<const volatile void*>(ptr);
+}
+template <typename T>
+const volatile void* most_derived(T* ptr, std::false_type /*polymorphic*/) noexcept {
+    return ptr;
+}
+} // namespace impl
+
+template <typename T, typename RC = ref_count_mt>
+class ref_ptr {
+    template <typename U, typename URC>
     friend class ref_ptr;
-    using super = std::shared_ptr<T>;
 
-    // only used when creating a new ref_ptr
-    explicit ref_ptr(std::shared_ptr<T> ptr)
-        : super(std::move(ptr))
-    {}
+    using header_t = impl::ref_ptr_header<RC>;
+
+    T* m_ptr = nullptr;
+
+    struct adopt_tag {};
+    ref_ptr(T* ptr, adopt_tag) noexcept : m_ptr(ptr) {}
+
+    static header_t* header(T* ptr) noexcept {
+        auto md = impl::most_derived(ptr, std::is_polymorphic<T>{});
+        return reinterpret_cast<header_t*>(const_cast<void*>(md)) - 1;
+    }
+
+    void inc_ref() const noexcept {
+        if (!m_ptr) return;
+        RC::inc(header(m_ptr)->count);
+    }
+    void dec_ref() noexcept {
+        if (!m_ptr) return;
+        auto h = header(m_ptr);
+        if (RC::dec(h->count)) {
+            h->destroy(h);
+        }
+    }
+
+    template <typename U>
+    struct is_compatible : std::integral_constant<bool,
+        std::is_convertible<U*, T*>::value
+        && (std::is_same<typename std::remove_cv<U>::type, typename std::remove_cv<T>::type>::value
+            || std::is_polymorphic<T>::value)>
+    {};
 public:
-    ref_ptr() = default;
-    ref_ptr(const ref_ptr&) = default;
-    ref_ptr& operator=(const ref_ptr&) = default;
-    ref_ptr(ref_ptr&&) noexcept = default;
-    ref_ptr& operator=(ref_ptr&&) noexcept = default;
-
-    ref_ptr(std::nullptr_t)
-        : super(nullptr)
-    {}
-    ref_ptr& operator=(std::nullptr_t) {
-        super::operator=(nullptr);
+    using element_type = T;
+
+    ref_ptr() noexcept = default;
+    ref_ptr(const ref_ptr& other) noexcept : m_ptr(other.m_ptr) {
+        inc_ref();
+    }
+    ref_ptr& operator=(const ref_ptr& other) noexcept {
+        ref_ptr(other).swap(*this);
+        return *this;
+    }
+    ref_ptr(ref_ptr&& other) noexcept : m_ptr(other.m_ptr) {
+        other.m_ptr = nullptr;
+    }
+    ref_ptr& operator=(ref_ptr&& other) noexcept {
+        ref_ptr(std::move(other)).swap(*this);
         return *this;
     }
+    ~ref_ptr() {
+        dec_ref();
+    }
 
-    template <typename U>
-    ref_ptr(const ref_ptr<U>& ptr) noexcept
-        : super(ptr)
-    {}
-    template <typename U>
-    ref_ptr& operator=(const ref_ptr<U>& ptr) noexcept {
-        super::operator=(ptr);
+    ref_ptr(std::nullptr_t) noexcept {}
+    ref_ptr& operator=(std::nullptr_t) noexcept {
+        reset();
         return *this;
     }
-    template <typename U>
-    ref_ptr(const ref_ptr<U>&& ptr) noexcept
-        : super(std::move(ptr))
-    {}
-    template <typename U>
-    ref_ptr& operator=(const ref_ptr<U>&& ptr) noexcept {
-        super::operator=(std::move(ptr));
+
+    // converting to a base requires the base to be polymorphic
+    // (the ref count is found through the most derived object)
+    template <typename U, typename std::enable_if<is_compatible<U>::value, int>::type = 0>
+    ref_ptr(const ref_ptr<U, RC>& ptr) noexcept
+        : m_ptr(ptr.m_ptr)
+    {
+        inc_ref();
+    }
+    template <typename U, typename std::enable_if<is_compatible<U>::value, int>::type = 0>
+    ref_ptr& operator=(const ref_ptr<U, RC>& ptr) noexcept {
+        ref_ptr(ptr).swap(*this);
+        return *this;
+    }
+    template <typename U, typename std::enable_if<is_compatible<U>::value, int>::type = 0>
+    ref_ptr(ref_ptr<U, RC>&& ptr) noexcept
+        : m_ptr(ptr.m_ptr)
+    {
+        ptr.m_ptr = nullptr;
+    }
+    template <typename U, typename std::enable_if<is_compatible<U>::value, int>::type = 0>
+    ref_ptr& operator=(ref_ptr<U, RC>&& ptr) noexcept {
+        ref_ptr(std::move(ptr)).swap(*this);
         return *this;
     }
 
-    using super::get;
-    using super::operator->;
-    using super::operator*;
-    using super::operator bool;
-    using super::use_count;
-    using super::reset;
+    T* get() const noexcept { return m_ptr; }
+    T* operator->() const noexcept { return m_ptr; }
+    T& operator*() const noexcept { return *m_ptr; }
+    explicit operator bool() const noexcept { return !!m_ptr; }
+
+    long use_count() const noexcept {
+        if (!m_ptr) return 0;
+        return RC::load(header(m_ptr)->count);
+    }
+
+    void reset() noexcept {
+        dec_ref();
+        m_ptr = nullptr;
+    }
+
+    void swap(ref_ptr& other) noexcept {
+        std::swap(m_ptr, other.m_ptr);
+    }
 
     // we could just do an operator <=>, but let's support pre-c++20
     template <typename U>
-    bool operator==(const ref_ptr<U>& other) const noexcept { return get() == other.get(); }
+    bool operator==(const ref_ptr<U, RC>& other) const noexcept { return get() == other.get(); }
     template <typename U>
-    bool operator!=(const ref_ptr<U>& other) const noexcept { return get() != other.get(); }
+    bool operator!=(const ref_ptr<U, RC>& other) const noexcept { return get() != other.get(); }
     template <typename U>
-    bool operator<(const ref_ptr<U>& other) const noexcept { return get() < other.get(); }
+    bool operator<(const ref_ptr<U, RC>& other) const noexcept { return get() < other.get(); }
     template <typename U>
-    bool operator<=(const ref_ptr<U>& other) const noexcept { return get() <= other.get(); }
+    bool operator<=(const ref_ptr<U, RC>& other) const noexcept { return get() <= other.get(); }
     template <typename U>
-    bool operator>(const ref_ptr<U>& other) const noexcept { return get() > other.get(); }
+    bool operator>(const ref_ptr<U, RC>& other) const noexcept { return get() > other.get(); }
     template <typename U>
-    bool operator>=(const ref_ptr<U>& other) const noexcept { return get() >= other.get(); }
+    bool operator>=(const ref_ptr<U, RC>& other) const noexcept { return get() >= other.get(); }
 
     bool unique() const noexcept {
         return use_count() == 1;
@@ -161,23 +353,28 @@ public:
 
     template <typename... Args>
     static ref_ptr make(Args&&... args) {
-        return ref_ptr(std::make_shared<T>(std::forward<Args>(args)...));
+        using obj_t = typename std::remove_cv<T>::type;
+        return ref_ptr(impl::ref_ptr_block<obj_t, RC>::create(std::forward<Args>(args)...), adopt_tag{});
     }
 
     // only use as a last resort
     // when ref_ptr needs to be provided to an existing API relying on shared_ptr
-    // be sure that the leaked shared_ptr will not be used to create weak_ptr-s
-    const std::shared_ptr<T>& _as_shared_ptr_unsafe() const& noexcept {
-        return *this;
-    }
-    std::shared_ptr<T> _as_shared_ptr_unsafe() && noexcept {
-        return std::move(*this);
-    }
-    static ref_ptr<T> _from_shared_ptr_unsafe(std::shared_ptr<T> ptr) noexcept {
-        return ref_ptr<T>(std::move(ptr));
+    // the returned shared_ptr holds a reference to the object
+    std::shared_ptr<T> _as_shared_ptr_unsafe() const {
+        if (!m_ptr) return {};
+        return std::shared_ptr<T>(m_ptr, shared_ptr_deleter{*this});
     }
+
+private:
+    struct shared_ptr_deleter {
+        ref_ptr ref;
+        void operator()(T*) noexcept { ref.reset(); }
+    };
 };
 
+template <typename T>
+using ref_ptr_st = ref_ptr<T, ref_count_st>;
+
 template <typename T, typename... Args>
 ref_ptr<T> make_ref_ptr(Args&&... args) {
     return ref_ptr<T>::make(std::forward<Args>(args)...);
@@ -188,9 +385,14 @@ auto make_ref_ptr_from(T&& obj) -> ref_ptr<typename std::remove_reference<T>::ty
     return ref_ptr<typename std::remove_reference<T>::type>::make(std::forward<T>(obj));
 }
 
+template <typename T, typename... Args>
+ref_ptr_st<T> make_ref_ptr_st(Args&&... args) {
+    return ref_ptr_st<T>::make(std::forward<Args>(args)...);
+}
+
 template <typename T>
-ref_ptr<T> _ref_ptr_from_shared_ptr_unsafe(std::shared_ptr<T> ptr) noexcept {
-    return ref_ptr<T>::_from_shared_ptr_unsafe(std::move(ptr));
+auto make_ref_ptr_st_from(T&& obj) -> ref_ptr_st<typename std::remove_reference<T>::type>{
+    return ref_ptr_st<typename std::remove_reference<T>::type>::make(std::forward<T>(obj));
 }
 
 } // namespace itlib
@@ -1,4 +1,4 @@
-// itlib-small-vector v2.07
+// itlib-small-vector v2.08
 //
 // std::vector-like class with a static buffer for initial capacity
 //
@@ -29,6 +29,8 @@
 //
 //                  VERSION HISTORY
 //
+//  2.08 (2026-10-16) memcpy and memmove for trivially copyable types
+//                    Strong exception guarantee on reallocation
 //  2.07 (2026-02-05) Drop use of deprecated std::aligned_storage
 //  2.06 (2025-03-28) Minor: Add missing header <cstdint>
 //  2.05 (2024-03-06) Minor: Return bool from shrink_to_fit
@@ -107,6 +109,10 @@
 // * shrink_to_fit will free and reallocate if size != capacity and the data
 //   doesn't fit into the static buffer. It also will revert to the static buffer
 //   whenever possible regardless of the RevertToStaticBelow value
+// * if T is trivially copyable and the allocator doesn't customize construct
+//   and destroy, elements are transferred with memcpy and memmove instead of
+//   one by one. This includes copies, insertion of ranges from pointers,
+//   erase, and switches between the static and the dynamic buffer
 //
 //
 //                  Configuration
@@ -154,10 +160,12 @@
 //
 #pragma once
 
-//#include <type_traits>
+#include <type_traits>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <memory>
+#include <utility>
 
 #define ITLIB_SMALL_VECTOR_ERROR_HANDLING_NONE  0
 #define ITLIB_SMALL_VECTOR_ERROR_HANDLING_THROW 1
@@ -194,9 +202,50 @@
 #   define I_ITLIB_SMALL_VECTOR_BOUNDS_CHECK(i) assert((i) < this->size())
 #endif
 
+// without exceptions there is nothing to roll back
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+#   define I_ITLIB_SMALL_VECTOR_TRY try
+#   define I_ITLIB_SMALL_VECTOR_CATCH_ALL catch (...)
+#   define I_ITLIB_SMALL_VECTOR_RETHROW throw
+#else
+#   define I_ITLIB_SMALL_VECTOR_TRY if (true)
+#   define I_ITLIB_SMALL_VECTOR_CATCH_ALL else
+#   define I_ITLIB_SMALL_VECTOR_RETHROW (void)0
+#endif
+
 namespace itlib
 {
 
+namespace impl
+{
+template <typename...>
+struct sv_voider { using type = void; };
+
+template <typename Alloc, typename T, typename = void>
+struct sv_alloc_has_construct : std::false_type {};
+template <typename Alloc, typename T>
+struct sv_alloc_has_construct<Alloc, T, typename sv_voider<
+    decltype(std::declval<Alloc&>().construct(std::declval<T*>(), std::declval<const T&>()))
+>::type> : std::true_type {};
+
+template <typename Alloc, typename T, typename = void>
+struct sv_alloc_has_destroy : std::false_type {};
+template <typename Alloc, typename T>
+struct sv_alloc_has_destroy<Alloc, T, typename sv_voider<
+    decltype(std::declval<Alloc&>().destroy(std::declval<T*>()))
+>::type> : std::true_type {};
+
+// whether elements can be transferred with memcpy and memmove
+// std::allocator has construct and destroy before C++20, but they do nothing special
+template <typename T, typename Alloc>
+struct sv_memcpy_elements : std::integral_constant<bool,
+    std::is_trivially_copyable<T>::value &&
+    std::is_same<typename std::allocator_traits<Alloc>::pointer, T*>::value &&
+    (std::is_same<Alloc, std::allocator<T>>::value ||
+        (!sv_alloc_has_construct<Alloc, T>::value && !sv_alloc_has_destroy<Alloc, T>::value))
+> {};
+}
+
 template<typename T, size_t StaticCapacity = 16, size_t RevertToStaticBelow = 0, class Alloc = std::allocator<T>>
 struct small_vector : private Alloc
 {
@@ -484,17 +533,19 @@ public:
         auto s = size();
 
         // now we need to transfer the existing elements into the new buffer
-        for (size_type i = 0; i < s; ++i)
+        I_ITLIB_SMALL_VECTOR_TRY
         {
-            atraits::construct(get_alloc(), cdr.ptr + i, std::move(*(m_begin + i)));
+            move_construct(cdr.ptr, m_begin, m_end);
         }
-
-        // free old elements
-        for (size_type i = 0; i < s; ++i)
+        I_ITLIB_SMALL_VECTOR_CATCH_ALL
         {
-            atraits::destroy(get_alloc(), m_begin + i);
+            atraits::deallocate(get_alloc(), cdr.ptr, cdr.cap);
+            I_ITLIB_SMALL_VECTOR_RETHROW;
         }
 
+        // free old elements
+        destroy_all();
+
         if (!is_static())
         {
             // we've moved from dyn to dyn memory, so deallocate the old one
@@ -518,31 +569,39 @@ public:
         if (s == m_capacity) return false; // we're at max
         if (is_static()) return false; // can't shrink static buf
 
-        auto old_begin = m_begin;
-        auto old_end = m_end;
-        auto old_cap = m_capacity;
-
+        choose_data_result cdr;
         if (s < StaticCapacity)
         {
             // revert to static capacity
-            m_begin = m_end = static_begin_ptr();
-            m_capacity = StaticCapacity;
+            cdr.ptr = static_begin_ptr();
+            cdr.cap = StaticCapacity;
         }
         else
         {
             // alloc new smaller buffer
-            m_begin = m_end = atraits::allocate(get_alloc(), s);
-            m_capacity = s;
+            cdr.ptr = atraits::allocate(get_alloc(), s);
+            cdr.cap = s;
         }
 
-        for (auto p = old_begin; p != old_end; ++p)
+        I_ITLIB_SMALL_VECTOR_TRY
         {
-            atraits::construct(get_alloc(), m_end, std::move(*p));
-            ++m_end;
-            atraits::destroy(get_alloc(), p);
+            move_construct(cdr.ptr, m_begin, m_end);
+        }
+        I_ITLIB_SMALL_VECTOR_CATCH_ALL
+        {
+            if (cdr.ptr != static_begin_ptr())
+            {
+                atraits::deallocate(get_alloc(), cdr.ptr, cdr.cap);
+            }
+            I_ITLIB_SMALL_VECTOR_RETHROW;
         }
 
-        atraits::deallocate(get_alloc(), old_begin, old_cap);
+        destroy_all();
+        atraits::deallocate(get_alloc(), m_begin, m_capacity);
+
+        m_begin = cdr.ptr;
+        m_end = m_begin + s;
+        m_capacity = cdr.cap;
         return true;
     }
 
@@ -611,11 +670,7 @@ public:
     iterator insert(const_iterator position, InputIterator first, InputIterator last)
     {
         auto pos = grow_at(position, last - first);
-        auto np = pos;
-        for (auto p = first; p != last; ++p, ++np)
-        {
-            atraits::construct(get_alloc(), np, *p);
-        }
+        copy_construct(pos, first, last);
         return pos;
     }
 
@@ -725,25 +780,179 @@ private:
         return &m_static_data[0].data;
     }
 
+    using memcpy_elements = impl::sv_memcpy_elements<T, Alloc>;
+
     void destroy_all()
     {
-        for (auto p = m_begin; p != m_end; ++p)
+        destroy(m_begin, m_end, memcpy_elements{});
+    }
+
+    // the element transfer helpers below have two overloads
+    // a generic one, and one with memcpy and memmove for trivially copyable types
+
+    void destroy(T*, T*, std::true_type) {}
+    void destroy(T* begin, T* end, std::false_type)
+    {
+        for (auto p = begin; p != end; ++p)
         {
             atraits::destroy(get_alloc(), p);
         }
     }
 
-    void take_impl(small_vector& v)
+    // construct copies of [first, last) in the uninitialized memory at dest
+    // if a copy throws, the ones which were constructed are destroyed
+    template <typename InputIterator>
+    T* copy_construct(T* dest, InputIterator first, InputIterator last)
     {
-        if (v.is_static())
+        // only pointers can be memcpy-d
+        using is_ptr = std::integral_constant<bool,
+            std::is_pointer<InputIterator>::value &&
+            std::is_same<typename std::remove_const<typename std::remove_pointer<InputIterator>::type>::type, T>::value
+        >;
+        return copy_construct(dest, first, last, std::integral_constant<bool, memcpy_elements::value && is_ptr::value>{});
+    }
+    template <typename Ptr>
+    T* copy_construct(T* dest, Ptr first, Ptr last, std::true_type)
+    {
+        const size_t n = size_t(last - first);
+        if (n) std::memcpy(static_cast<void*>(dest), first, n * sizeof(T));
+        return dest + n;
+    }
+    template <typename InputIterator>
+    T* copy_construct(T* dest, InputIterator first, InputIterator last, std::false_type)
+    {
+        auto p = dest;
+        I_ITLIB_SMALL_VECTOR_TRY
         {
-            m_begin = m_end = static_begin_ptr();
-            for (auto p = v.m_begin; p != v.m_end; ++p)
+            for (; first != last; ++first, ++p)
+            {
+                atraits::construct(get_alloc(), p, *first);
+            }
+        }
+        I_ITLIB_SMALL_VECTOR_CATCH_ALL
+        {
+            destroy(dest, p, std::false_type{});
+            I_ITLIB_SMALL_VECTOR_RETHROW;
+        }
+        return p;
+    }
+
+    // move [begin, end) to the uninitialized memory at dest
+    // the source and the destination must not overlap
+    // the source elements are not destroyed, so if a move throws, the ones
+    // which were constructed are destroyed and the source remains intact
+    // as with std::vector, types whose move may throw are copied if possible
+    // (a move-only type which throws when moved leaves the source moved-from)
+    T* move_construct(T* dest, T* begin, T* end)
+    {
+        return move_construct(dest, begin, end, memcpy_elements{});
+    }
+    T* move_construct(T* dest, T* begin, T* end, std::true_type)
+    {
+        const size_t n = size_t(end - begin);
+        if (n) std::memcpy(static_cast<void*>(dest), begin, n * sizeof(T));
+        return dest + n;
+    }
+    T* move_construct(T* dest, T* begin, T* end, std::false_type)
+    {
+        auto p = dest;
+        I_ITLIB_SMALL_VECTOR_TRY
+        {
+            for (; begin != end; ++begin, ++p)
             {
-                atraits::construct(get_alloc(), m_end, std::move(*p));
-                ++m_end;
+                atraits::construct(get_alloc(), p, std::move_if_noexcept(*begin));
             }
+        }
+        I_ITLIB_SMALL_VECTOR_CATCH_ALL
+        {
+            destroy(dest, p, std::false_type{});
+            I_ITLIB_SMALL_VECTOR_RETHROW;
+        }
+        return p;
+    }
 
+    // move [begin, end) to the uninitialized memory at dest
+    // unlike move_construct the elements are always moved and there are no
+    // guarantees if a move throws (used by the noexcept move operations)
+    T* relocate(T* dest, T* begin, T* end)
+    {
+        return relocate(dest, begin, end, memcpy_elements{});
+    }
+    T* relocate(T* dest, T* begin, T* end, std::true_type)
+    {
+        return move_construct(dest, begin, end, std::true_type{});
+    }
+    T* relocate(T* dest, T* begin, T* end, std::false_type)
+    {
+        for (; begin != end; ++begin, ++dest)
+        {
+            atraits::construct(get_alloc(), dest, std::move(*begin));
+        }
+        return dest;
+    }
+
+    // shift [begin, end) to begin + offset in the same buffer
+    // the memory at the destination which is not covered by the source must be uninitialized
+    // the memory at the source which is not covered by the destination is left uninitialized
+    // the caller must have m_end == end and update it afterwards
+    void shift(T* begin, T* end, ptrdiff_t offset)
+    {
+        shift(begin, end, offset, memcpy_elements{});
+    }
+    void shift(T* begin, T* end, ptrdiff_t offset, std::true_type)
+    {
+        if (begin != end) std::memmove(static_cast<void*>(begin + offset), begin, size_t(end - begin) * sizeof(T));
+    }
+    void shift(T* begin, T* end, ptrdiff_t offset, std::false_type)
+    {
+        // if a move throws, the elements which are not in place are lost, but the vector remains valid
+        if (offset > 0)
+        {
+            auto p = end;
+            I_ITLIB_SMALL_VECTOR_TRY
+            {
+                while (p != begin)
+                {
+                    --p;
+                    atraits::construct(get_alloc(), p + offset, std::move(*p));
+                    atraits::destroy(get_alloc(), p);
+                }
+            }
+            I_ITLIB_SMALL_VECTOR_CATCH_ALL
+            {
+                // [begin, p] are alive, (p, p + offset] are not, and the rest are shifted
+                destroy(p + offset + 1, end + offset, std::false_type{});
+                m_end = p + 1;
+                I_ITLIB_SMALL_VECTOR_RETHROW;
+            }
+        }
+        else
+        {
+            auto p = begin;
+            I_ITLIB_SMALL_VECTOR_TRY
+            {
+                for (; p != end; ++p)
+                {
+                    atraits::construct(get_alloc(), p + offset, std::move(*p));
+                    atraits::destroy(get_alloc(), p);
+                }
+            }
+            I_ITLIB_SMALL_VECTOR_CATCH_ALL
+            {
+                // [.., p + offset) are alive, [p + offset, p) are not, and [p, end) are not shifted
+                destroy(p, end, std::false_type{});
+                m_end = p + offset;
+                I_ITLIB_SMALL_VECTOR_RETHROW;
+            }
+        }
+    }
+
+    void take_impl(small_vector& v)
+    {
+        if (v.is_static())
+        {
+            m_begin = static_begin_ptr();
+            m_end = relocate(m_begin, v.m_begin, v.m_end);
             v.destroy_all();
         }
         else
@@ -772,13 +981,8 @@ private:
         {
             // no special transfers needed
 
-            m_end = m_begin + s + num;
-
-            for (auto p = m_end - num - 1; p >= position; --p)
-            {
-                atraits::construct(get_alloc(), p + num, std::move(*p));
-                atraits::destroy(get_alloc(), p);
-            }
+            shift(position, m_end, ptrdiff_t(num));
+            m_end += num;
 
             return position;
         }
@@ -786,27 +990,27 @@ private:
         {
             // we need to transfer the elements into the new buffer
 
+            const auto old_position = position;
             position = cdr.ptr + (position - m_begin);
 
-            auto p = m_begin;
             auto np = cdr.ptr;
-
-            for (; np != position; ++p, ++np)
+            I_ITLIB_SMALL_VECTOR_TRY
             {
-                atraits::construct(get_alloc(), np, std::move(*p));
+                np = move_construct(np, m_begin, old_position);
+                move_construct(position + num, old_position, m_end); // leave a hole
             }
-
-            np += num; // hole
-            for (; p != m_end; ++p, ++np)
+            I_ITLIB_SMALL_VECTOR_CATCH_ALL
             {
-                atraits::construct(get_alloc(), np, std::move(*p));
+                destroy(cdr.ptr, np, memcpy_elements{});
+                if (cdr.ptr != static_begin_ptr())
+                {
+                    atraits::deallocate(get_alloc(), cdr.ptr, cdr.cap);
+                }
+                I_ITLIB_SMALL_VECTOR_RETHROW;
             }
 
             // destroy old
-            for (p = m_begin; p != m_end; ++p)
-            {
-                atraits::destroy(get_alloc(), p);
-            }
+            destroy_all();
 
             if (!is_static())
             {
@@ -841,16 +1045,8 @@ private:
         {
             // no special transfers needed
 
-            for (auto p = position, np = position + num; np != m_end; ++p, ++np)
-            {
-                atraits::destroy(get_alloc(), p);
-                atraits::construct(get_alloc(), p, std::move(*np));
-            }
-
-            for (auto p = m_end - num; p != m_end; ++p)
-            {
-                atraits::destroy(get_alloc(), p);
-            }
+            destroy(position, position + num, memcpy_elements{});
+            shift(position + num, m_end, -ptrdiff_t(num));
 
             m_end -= num;
         }
@@ -860,23 +1056,20 @@ private:
 
             assert(cdr.ptr == static_begin_ptr()); // since we're shrinking that's the only way to have a new buffer
 
-            auto p = m_begin, np = cdr.ptr;
-            for (; p != position; ++p, ++np)
+            auto np = cdr.ptr;
+            I_ITLIB_SMALL_VECTOR_TRY
             {
-                atraits::construct(get_alloc(), np, std::move(*p));
-                atraits::destroy(get_alloc(), p);
+                np = move_construct(np, m_begin, position);
+                np = move_construct(np, position + num, m_end);
             }
-
-            for (; p != position + num; ++p)
+            I_ITLIB_SMALL_VECTOR_CATCH_ALL
             {
-                atraits::destroy(get_alloc(), p);
+                destroy(cdr.ptr, np, memcpy_elements{});
+                I_ITLIB_SMALL_VECTOR_RETHROW;
             }
 
-            for (; np != cdr.ptr + s - num; ++p, ++np)
-            {
-                atraits::construct(get_alloc(), np, std::move(*p));
-                atraits::destroy(get_alloc(), p);
-            }
+            // destroy old (including the erased ones)
+            destroy_all();
 
             // we've moved from dyn memory, so deallocate the old one
             atraits::deallocate(get_alloc(), m_begin, m_capacity);
@@ -915,11 +1108,20 @@ private:
     {
         const auto cdr = choose_data(last - first);
 
-        m_end = cdr.ptr;
-        for (auto p = first; p != last; ++p)
+        m_end = m_begin; // the old elements (if any) are destroyed by the caller
+
+        T* new_end;
+        I_ITLIB_SMALL_VECTOR_TRY
         {
-            atraits::construct(get_alloc(), m_end, *p);
-            ++m_end;
+            new_end = copy_construct(cdr.ptr, first, last);
+        }
+        I_ITLIB_SMALL_VECTOR_CATCH_ALL
+        {
+            if (cdr.ptr != m_begin && cdr.ptr != static_begin_ptr())
+            {
+                atraits::deallocate(get_alloc(), cdr.ptr, cdr.cap);
+            }
+            I_ITLIB_SMALL_VECTOR_RETHROW;
         }
 
         if (!is_static() && m_begin != cdr.ptr)
@@ -928,6 +1130,7 @@ private:
         }
 
         m_begin = cdr.ptr;
+        m_end = new_end;
         m_capacity = cdr.cap;
     }
 
@@ -0,0 +1,956 @@
+// itlib-sparse-bitset v1.00
+//
+// A compressed bitset of 32-bit integers for sparse sets (roaring bitmap)
+//
+// SPDX-License-Identifier: MIT
+// MIT License:
+// Copyright(c) 2026 Borislav Stanimirov
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files(the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and / or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions :
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//
+//                  VERSION HISTORY
+//
+//  1.00 (2026-10-16) Initial release
+//
+//
+//                  DOCUMENTATION
+//
+// Simply include this file wherever you need.
+// It defines the class itlib::sparse_bitset, which is a bitset over the
+// entire range of uint32_t. Its memory usage is proportional to the number
+// of set bits (or less) instead of to the largest one. It's similar to
+// itlib::dynamic_bitset and has the same query interface, but it has no size
+// and no bit references.
+//
+// The universe is split in chunks of 65536 bits by the high 16 bits of the
+// values. Only chunks with set bits are stored, sorted by key, and each
+// stores the low 16 bits of its values in one of three containers:
+// * array - sorted uint16_t values. Used when there are at most 4096 of them
+// * bitmap - 1024 uint64_t words. Used when there are more
+// * runs - sorted pairs of start and length-1. Produced by optimize() and
+//   by set_range when it covers whole chunks
+// The containers are changed automatically when bits are set or reset.
+//
+// Methods:
+// * bool test(value_type i) const
+//      test single bit
+// * void set(value_type i)
+// * void reset(value_type i)
+// * void set(value_type i, bool b)
+// * void flip(value_type i)
+//      modify single bit
+// * void set_range(size_type from, size_type to)
+// * void reset_range(size_type from, size_type to)
+//      set bits in [from, to) to true or false. to can be 2^32
+// * void clear()
+//      reset all bits
+// * size_type count() const noexcept
+//      number of true bits
+// * bool any() const noexcept
+// * bool none() const noexcept
+// * bool empty() const noexcept
+//      any bits true? no bits true? (empty is the same as none)
+// * size_type find_first() const noexcept
+//      the first true bit or npos if there is none
+// * size_type find_next(size_type i) const noexcept
+//      the first true bit after i or npos if there is none
+// * sparse_bitset& operator&=(const sparse_bitset& other)
+// * sparse_bitset& operator|=(const sparse_bitset& other)
+// * sparse_bitset& operator^=(const sparse_bitset& other)
+// * sparse_bitset& andnot(const sparse_bitset& other)
+//      bitwise ops (andnot is &= ~other)
+// * bool operator==(const sparse_bitset& other) const
+// * bool operator!=(const sparse_bitset& other) const
+//      compare bits (regardless of containers)
+// * void optimize()
+//      convert containers to runs where it saves memory (and back, where it
+//      doesn't) and release unused capacity
+// * size_t memory_usage() const noexcept
+//      approximate number of bytes used by the bitset
+// * const_iterator begin() const
+// * const_iterator end() const
+//      iterate the true bits in ascending order. Unlike the iterators of
+//      dynamic_bitset, these dereference to values and not to bools
+//
+//
+//                  TESTS
+//
+// You can find unit tests in the official repo:
+// https://github.com/iboB/itlib/blob/master/test/
+//
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include <cassert>
+
+#if defined(__GNUC__)
+// builtins
+#elif __cplusplus >= 202000
+#   include <bit>
+#endif
+
+namespace itlib {
+
+namespace sbsimpl {
+
+inline unsigned popcount(uint64_t w) noexcept
+{
+#if defined(__GNUC__)
+    return unsigned(__builtin_popcountll(w));
+#elif __cplusplus >= 202000
+    return unsigned(std::popcount(w));
+#else
+    w = w - ((w >> 1) & 0x5555555555555555ull);
+    w = (w & 0x3333333333333333ull) + ((w >> 2) & 0x3333333333333333ull);
+    w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return unsigned((w * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+// w must not be zero
+inline unsigned ctz(uint64_t w) noexcept
+{
+    assert(w);
+#if defined(__GNUC__)
+    return unsigned(__builtin_ctzll(w));
+#elif __cplusplus >= 202000
+    return unsigned(std::countr_zero(w));
+#else
+    unsigned ret = 0;
+    for (; !(w & 1); w >>= 1) ++ret;
+    return ret;
+#endif
+}
+
+enum class container_type : uint8_t
+{
+    array,
+    bitmap,
+    runs,
+};
+
+static const uint32_t chunk_bits = 65536;
+static const uint32_t array_max = 4096; // arrays larger than this become bitmaps
+static const uint32_t bitmap_words = chunk_bits / 64;
+static const uint32_t none = chunk_bits; // no value in a chunk
+
+// set bits [from, to) of a bitmap
+inline void bitmap_set_range(uint64_t* w, uint32_t from, uint32_t to) noexcept
+{
+    if (from >= to) return;
+    const uint32_t fw = from / 64, lw = (to - 1) / 64;
+    const uint64_t head = ~uint64_t(0) << (from % 64);
+    const uint64_t tail = ~uint64_t(0) >> (63 - (to - 1) % 64);
+    if (fw == lw)
+    {
+        w[fw] |= head & tail;
+        return;
+    }
+    w[fw] |= head;
+    std::fill(w + fw + 1, w + lw, ~uint64_t(0));
+    w[lw] |= tail;
+}
+
+inline void bitmap_reset_range(uint64_t* w, uint32_t from, uint32_t to) noexcept
+{
+    if (from >= to) return;
+    const uint32_t fw = from / 64, lw = (to - 1) / 64;
+    const uint64_t head = ~uint64_t(0) << (from % 64);
+    const uint64_t tail = ~uint64_t(0) >> (63 - (to - 1) % 64);
+    if (fw == lw)
+    {
+        w[fw] &= ~(head & tail);
+        return;
+    }
+    w[fw] &= ~head;
+    std::fill(w + fw + 1, w + lw, uint64_t(0));
+    w[lw] &= ~tail;
+}
+
+// first set bit >= from or none
+inline uint32_t bitmap_lower_bound(const uint64_t* w, uint32_t from) noexcept
+{
+    if (from >= chunk_bits) return none;
+    uint32_t wi = from / 64;
+    uint64_t cur = w[wi] & (~uint64_t(0) << (from % 64));
+    while (!cur)
+    {
+        if (++wi == bitmap_words) return none;
+        cur = w[wi];
+    }
+    return wi * 64 + ctz(cur);
+}
+
+inline uint32_t bitmap_count(const uint64_t* w) noexcept
+{
+    uint32_t ret = 0;
+    for (uint32_t i = 0; i < bitmap_words; ++i) ret += popcount(w[i]);
+    return ret;
+}
+
+// the values of a 64k chunk
+struct container
+{
+    container_type type = container_type::array;
+    uint32_t card = 0; // number of values
+    std::vector<uint16_t> values; // array: sorted values, runs: pairs of start and length-1
+    std::vector<uint64_t> bits; // bitmap
+
+    size_t num_runs() const noexcept { return values.size() / 2; }
+    uint32_t run_start(size_t r) const noexcept { return values[2 * r]; }
+    uint32_t run_last(size_t r) const noexcept { return uint32_t(values[2 * r]) + values[2 * r + 1]; }
+
+    // index of the last run which starts at or before v or num_runs() if none
+    size_t find_run(uint32_t v) const noexcept
+    {
+        size_t lo = 0, hi = num_runs();
+        while (lo < hi)
+        {
+            const size_t mid = (lo + hi) / 2;
+            if (run_start(mid) <= v) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo ? lo - 1 : num_runs();
+    }
+
+    bool test(uint32_t v) const noexcept
+    {
+        switch (type)
+        {
+        case container_type::array:
+            return std::binary_search(values.begin(), values.end(), uint16_t(v));
+        case container_type::bitmap:
+            return (bits[v / 64] >> (v % 64)) & 1;
+        default:
+        {
+            const auto r = find_run(v);
+            return r != num_runs() && v <= run_last(r);
+        }
+        }
+    }
+
+    // first value >= v or none
+    uint32_t lower_bound(uint32_t v) const noexcept
+    {
+        switch (type)
+        {
+        case container_type::array:
+        {
+            auto f = std::lower_bound(values.begin(), values.end(), v, [](uint16_t a, uint32_t b) { return a < b; });
+            return f == values.end() ? none : *f;
+        }
+        case container_type::bitmap:
+            return bitmap_lower_bound(bits.data(), v);
+        default:
+        {
+            auto r = find_run(v);
+            if (r != num_runs() && v <= run_last(r)) return v;
+            r = r == num_runs() ? 0 : r + 1;
+            return r < num_runs() ? run_start(r) : none;
+        }
+        }
+    }
+
+    template <typename F>
+    void for_each(F f) const
+    {
+        switch (type)
+        {
+        case container_type::array:
+            for (auto v : values) f(uint32_t(v));
+            break;
+        case container_type::bitmap:
+            for (uint32_t i = 0; i < bitmap_words; ++i)
+            {
+                for (uint64_t w = bits[i]; w; w &= w - 1) f(i * 64 + ctz(w));
+            }
+            break;
+        default:
+            for (size_t r = 0; r < num_runs(); ++r)
+            {
+                for (uint32_t v = run_start(r), e = run_last(r); v <= e; ++v) f(v);
+            }
+        }
+    }
+
+    void fill_bitmap(uint64_t* w) const noexcept
+    {
+        std::fill(w, w + bitmap_words, uint64_t(0));
+        if (type == container_type::runs)
+        {
+            for (size_t r = 0; r < num_runs(); ++r) bitmap_set_range(w, run_start(r), run_last(r) + 1);
+        }
+        else
+        {
+            for_each([w](uint32_t v) { w[v / 64] |= uint64_t(1) << (v % 64); });
+        }
+    }
+
+    void to_bitmap()
+    {
+        if (type == container_type::bitmap) return;
+        std::vector<uint64_t> b(bitmap_words);
+        fill_bitmap(b.data());
+        bits.swap(b);
+        std::vector<uint16_t>().swap(values);
+        type = container_type::bitmap;
+    }
+
+    void to_array()
+    {
+        if (type == container_type::array) return;
+        std::vector<uint16_t> a;
+        a.reserve(card);
+        for_each([&a](uint32_t v) { a.push_back(uint16_t(v)); });
+        values.swap(a);
+        std::vector<uint64_t>().swap(bits);
+        type = container_type::array;
+    }
+
+    // the best of array and bitmap for the cardinality
+    void normalize()
+    {
+        if (card <= array_max) to_array();
+        else to_bitmap();
+    }
+
+    // run containers are not modified in place
+    void unrun()
+    {
+        if (type == container_type::runs) normalize();
+    }
+
+    size_t count_runs() const noexcept
+    {
+        switch (type)
+        {
+        case container_type::array:
+        {
+            size_t ret = 0;
+            for (size_t i = 0; i < values.size(); ++i)
+            {
+                if (i == 0 || values[i] != values[i - 1] + 1) ++ret;
+            }
+            return ret;
+        }
+        case container_type::bitmap:
+        {
+            size_t ret = 0;
+            uint64_t prev_top = 0;
+            for (uint32_t i = 0; i < bitmap_words; ++i)
+            {
+                const auto w = bits[i];
+                ret += popcount(w & ~((w << 1) | prev_top));
+                prev_top = w >> 63;
+            }
+            return ret;
+        }
+        default:
+            return num_runs();
+        }
+    }
+
+    void optimize()
+    {
+        const size_t run_bytes = count_runs() * 4;
+        const size_t bytes = card <= array_max ? card * 2 : bitmap_words * 8;
+        if (run_bytes < bytes)
+        {
+            if (type == container_type::runs) return;
+            std::vector<uint16_t> r;
+            r.reserve(run_bytes / 2);
+            uint32_t start = 0, last = 0;
+            bool has = false;
+            for_each([&](uint32_t v) {
+                if (has && v == last + 1)
+                {
+                    last = v;
+                    return;
+                }
+                if (has)
+                {
+                    r.push_back(uint16_t(start));
+                    r.push_back(uint16_t(last - start));
+                }
+                start = last = v;
+                has = true;
+            });
+            r.push_back(uint16_t(start));
+            r.push_back(uint16_t(last - start));
+            values.swap(r);
+            std::vector<uint64_t>().swap(bits);
+            type = container_type::runs;
+        }
+        else
+        {
+            normalize();
+            values.shrink_to_fit();
+        }
+    }
+
+    void set(uint32_t v)
+    {
+        unrun();
+        if (type == container_type::array)
+        {
+            auto f = std::lower_bound(values.begin(), values.end(), uint16_t(v));
+            if (f != values.end() && *f == v) return;
+            values.insert(f, uint16_t(v));
+            if (++card > array_max) to_bitmap();
+        }
+        else
+        {
+            auto& w = bits[v / 64];
+            const auto mask = uint64_t(1) << (v % 64);
+            if (w & mask) return;
+            w |= mask;
+            ++card;
+        }
+    }
+
+    void reset(uint32_t v)
+    {
+        unrun();
+        if (type == container_type::array)
+        {
+            auto f = std::lower_bound(values.begin(), values.end(), uint16_t(v));
+            if (f == values.end() || *f != v) return;
+            values.erase(f);
+            --card;
+        }
+        else
+        {
+            auto& w = bits[v / 64];
+            const auto mask = uint64_t(1) << (v % 64);
+            if (!(w & mask)) return;
+            w &= ~mask;
+            if (--card <= array_max) to_array();
+        }
+    }
+
+    static container full()
+    {
+        container ret;
+        ret.type = container_type::runs;
+        ret.card = chunk_bits;
+        ret.values = {0, uint16_t(chunk_bits - 1)};
+        return ret;
+    }
+
+    bool operator==(const container& other) const
+    {
+        if (card != other.card) return false;
+        if (type == other.type && type != container_type::bitmap) return values == other.values;
+        std::vector<uint64_t> a(bitmap_words), b(bitmap_words);
+        fill_bitmap(a.data());
+        other.fill_bitmap(b.data());
+        return a == b;
+    }
+};
+
+struct op_and
+{
+    static uint64_t apply(uint64_t a, uint64_t b) { return a & b; }
+    template <typename I, typename O>
+    static O apply(I b1, I e1, I b2, I e2, O out) { return std::set_intersection(b1, e1, b2, e2, out); }
+};
+
+struct op_or
+{
+    static uint64_t apply(uint64_t a, uint64_t b) { return a | b; }
+    template <typename I, typename O>
+    static O apply(I b1, I e1, I b2, I e2, O out) { return std::set_union(b1, e1, b2, e2, out); }
+};
+
+struct op_xor
+{
+    static uint64_t apply(uint64_t a, uint64_t b) { return a ^ b; }
+    template <typename I, typename O>
+    static O apply(I b1, I e1, I b2, I e2, O out) { return std::set_symmetric_difference(b1, e1, b2, e2, out); }
+};
+
+struct op_andnot
+{
+    static uint64_t apply(uint64_t a, uint64_t b) { return a & ~b; }
+    template <typename I, typename O>
+    static O apply(I b1, I e1, I b2, I e2, O out) { return std::set_difference(b1, e1, b2, e2, out); }
+};
+
+// replace a with a op b
+template <typename Op>
+void apply(container& a, const container& b)
+{
+    if (a.type == container_type::array && b.type == container_type::array)
+    {
+        std::vector<uint16_t> r;
+        r.reserve(std::is_same<Op, op_and>::value || std::is_same<Op, op_andnot>::value ? a.card : a.card + b.card);
+        Op::apply(a.values.cbegin(), a.values.cend(), b.values.cbegin(), b.values.cend(), std::back_inserter(r));
+        a.values.swap(r);
+        a.card = uint32_t(a.values.size());
+        if (a.card > array_max) a.to_bitmap();
+        return;
+    }
+
+    if (std::is_same<Op, op_and>::value && b.type == container_type::array)
+    {
+        // filter the values of b
+        std::vector<uint16_t> r;
+        r.reserve(b.card);
+        for (auto v : b.values)
+        {
+            if (a.test(v)) r.push_back(v);
+        }
+        a.values.swap(r);
+        std::vector<uint64_t>().swap(a.bits);
+        a.type = container_type::array;
+        a.card = uint32_t(a.values.size());
+        return;
+    }
+
+    if (a.type == container_type::array && (std::is_same<Op, op_and>::value || std::is_same<Op, op_andnot>::value))
+    {
+        // filter the array
+        const bool keep = std::is_same<Op, op_and>::value;
+        auto e = std::remove_if(a.values.begin(), a.values.end(), [&](uint16_t v) { return b.test(v) != keep; });
+        a.values.erase(e, a.values.end());
+        a.card = uint32_t(a.values.size());
+        return;
+    }
+
+    std::vector<uint64_t> tmp;
+    const uint64_t* bw = b.bits.data();
+    if (b.type != container_type::bitmap)
+    {
+        tmp.resize(bitmap_words);
+        b.fill_bitmap(tmp.data());
+        bw = tmp.data();
+    }
+    a.to_bitmap();
+    uint32_t card = 0;
+    for (uint32_t i = 0; i < bitmap_words; ++i)
+    {
+        a.bits[i] = Op::apply(a.bits[i], bw[i]);
+        card += popcount(a.bits[i]);
+    }
+    a.card = card;
+    a.normalize();
+}
+
+// a template, so that npos can be defined in the header before C++17
+template <typename = void>
+struct sparse_bitset_base
+{
+    static constexpr uint64_t npos = uint64_t(-1);
+};
+
+#if __cplusplus < 201700
+template <typename T>
+constexpr uint64_t sparse_bitset_base<T>::npos;
+#endif
+
+} // namespace sbsimpl
+
+class sparse_bitset : public sbsimpl::sparse_bitset_base<>
+{
+    struct chunk
+    {
+        uint16_t key;
+        sbsimpl::container c;
+    };
+
+    std::vector<chunk> m_chunks; // sorted by key
+
+public:
+    using value_type = uint32_t;
+    using size_type = uint64_t;
+
+    sparse_bitset() noexcept = default;
+
+    bool test(value_type i) const noexcept
+    {
+        auto c = find_chunk(hi(i));
+        return c && c->test(lo(i));
+    }
+
+    void set(value_type i)
+    {
+        get_chunk(hi(i)).set(lo(i));
+    }
+
+    void reset(value_type i)
+    {
+        auto f = chunk_lower_bound(hi(i));
+        if (f == m_chunks.end() || f->key != hi(i)) return;
+        f->c.reset(lo(i));
+        if (f->c.card == 0) m_chunks.erase(f);
+    }
+
+    void set(value_type i, bool b)
+    {
+        if (b) set(i);
+        else reset(i);
+    }
+
+    void flip(value_type i)
+    {
+        set(i, !test(i));
+    }
+
+    void set_range(size_type from, size_type to)
+    {
+        assert(from <= to && to <= (size_type(1) << 32));
+        if (from == to) return;
+        const auto fk = uint32_t(from >> 16);
+        const auto lk = uint32_t((to - 1) >> 16);
+
+        // build the chunks anew, so that inserting many isn't quadratic
+        std::vector<chunk> result;
+        result.reserve(m_chunks.size() + (lk - fk + 1));
+        auto i = m_chunks.begin();
+        for (; i != m_chunks.end() && i->key < fk; ++i) result.push_back(std::move(*i));
+        for (uint32_t k = fk; k <= lk; ++k)
+        {
+            if (i != m_chunks.end() && i->key == k) result.push_back(std::move(*i++));
+            else result.push_back(chunk{uint16_t(k), sbsimpl::container{}});
+
+            const uint32_t cf = k == fk ? lo(uint32_t(from)) : 0;
+            const uint32_t ct = k == lk ? lo(uint32_t(to - 1)) + 1 : sbsimpl::chunk_bits;
+            auto& c = result.back().c;
+            if (cf == 0 && ct == sbsimpl::chunk_bits)
+            {
+                c = sbsimpl::container::full();
+                continue;
+            }
+            c.to_bitmap();
+            sbsimpl::bitmap_set_range(c.bits.data(), cf, ct);
+            c.card = sbsimpl::bitmap_count(c.bits.data());
+            c.normalize();
+        }
+        for (; i != m_chunks.end(); ++i) result.push_back(std::move(*i));
+        m_chunks.swap(result);
+    }
+
+    void reset_range(size_type from, size_type to)
+    {
+        assert(from <= to && to <= (size_type(1) << 32));
+        if (from == to) return;
+        const auto fk = uint16_t(from >> 16);
+        const auto lk = uint16_t((to - 1) >> 16);
+        auto i = chunk_lower_bound(fk);
+        auto out = i;
+        for (; i != m_chunks.end() && i->key <= lk; ++i)
+        {
+            const uint32_t cf = i->key == fk ? lo(uint32_t(from)) : 0;
+            const uint32_t ct = i->key == lk ? lo(uint32_t(to - 1)) + 1 : sbsimpl::chunk_bits;
+            if (cf == 0 && ct == sbsimpl::chunk_bits) continue; // drop the chunk
+
+            auto& c = i->c;
+            c.to_bitmap();
+            sbsimpl::bitmap_reset_range(c.bits.data(), cf, ct);
+            c.card = sbsimpl::bitmap_count(c.bits.data());
+            if (c.card == 0) continue;
+            c.normalize();
+            if (out != i) *out = std::move(*i);
+            ++out;
+        }
+        m_chunks.erase(out, i);
+    }
+
+    void clear() noexcept { m_chunks.clear(); }
+
+    size_type count() const noexcept
+    {
+        size_type ret = 0;
+        for (auto& c : m_chunks) ret += c.c.card;
+        return ret;
+    }
+
+    bool any() const noexcept { return !m_chunks.empty(); }
+    bool none() const noexcept { return m_chunks.empty(); }
+    bool empty() const noexcept { return m_chunks.empty(); }
+
+    size_type find_first() const noexcept
+    {
+        if (m_chunks.empty()) return npos;
+        return value(m_chunks.front().key, m_chunks.front().c.lower_bound(0));
+    }
+
+    size_type find_next(size_type i) const noexcept
+    {
+        if (i >= 0xFFFFFFFFu) return npos;
+        const auto x = uint32_t(i + 1);
+        auto f = chunk_lower_bound(hi(x));
+        if (f == m_chunks.end()) return npos;
+        if (f->key == hi(x))
+        {
+            const auto l = f->c.lower_bound(lo(x));
+            if (l != sbsimpl::none) return value(f->key, l);
+            if (++f == m_chunks.end()) return npos;
+        }
+        return value(f->key, f->c.lower_bound(0));
+    }
+
+    sparse_bitset& operator&=(const sparse_bitset& other)
+    {
+        if (&other == this) return *this;
+        auto o = other.m_chunks.begin();
+        auto i = m_chunks.begin();
+        while (i != m_chunks.end())
+        {
+            while (o != other.m_chunks.end() && o->key < i->key) ++o;
+            if (o != other.m_chunks.end() && o->key == i->key)
+            {
+                sbsimpl::apply<sbsimpl::op_and>(i->c, o->c);
+                if (i->c.card)
+                {
+                    ++i;
+                    continue;
+                }
+            }
+            i = m_chunks.erase(i);
+        }
+        return *this;
+    }
+
+    sparse_bitset& operator|=(const sparse_bitset& other)
+    {
+        if (&other == this) return *this;
+        return merge<sbsimpl::op_or>(other);
+    }
+
+    sparse_bitset& operator^=(const sparse_bitset& other)
+    {
+        if (&other == this)
+        {
+            clear();
+            return *this;
+        }
+        return merge<sbsimpl::op_xor>(other);
+    }
+
+    // this &= ~other
+    sparse_bitset& andnot(const sparse_bitset& other)
+    {
+        // the loop erases chunks, which would invalidate the iterators of other
+        if (&other == this)
+        {
+            clear();
+            return *this;
+        }
+        auto o = other.m_chunks.begin();
+        auto i = m_chunks.begin();
+        while (i != m_chunks.end())
+        {
+            while (o != other.m_chunks.end() && o->key < i->key) ++o;
+            if (o != other.m_chunks.end() && o->key == i->key)
+            {
+                sbsimpl::apply<sbsimpl::op_andnot>(i->c, o->c);
+                if (!i->c.card)
+                {
+                    i = m_chunks.erase(i);
+                    continue;
+                }
+            }
+            ++i;
+        }
+        return *this;
+    }
+
+    bool operator==(const sparse_bitset& other) const
+    {
+        if (m_chunks.size() != other.m_chunks.size()) return false;
+        for (size_t i = 0; i < m_chunks.size(); ++i)
+        {
+            if (m_chunks[i].key != other.m_chunks[i].key) return false;
+            if (!(m_chunks[i].c == other.m_chunks[i].c)) return false;
+        }
+        return true;
+    }
+    bool operator!=(const sparse_bitset& other) const { return !operator==(other); }
+
+    void optimize()
+    {
+        for (auto& c : m_chunks) c.c.optimize();
+        m_chunks.shrink_to_fit();
+    }
+
+    size_t memory_usage() const noexcept
+    {
+        size_t ret = sizeof(*this) + m_chunks.capacity() * sizeof(chunk);
+        for (auto& c : m_chunks)
+        {
+            ret += c.c.values.capacity() * sizeof(uint16_t) + c.c.bits.capacity() * sizeof(uint64_t);
+        }
+        return ret;
+    }
+
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = sparse_bitset::value_type;
+        using difference_type = ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = value_type;
+
+        const_iterator() noexcept = default;
+
+        value_type operator*() const noexcept { return (uint32_t(m_chunk->key) << 16) | m_low; }
+
+        const_iterator& operator++() noexcept
+        {
+            auto& c = m_chunk->c;
+            switch (c.type)
+            {
+            case sbsimpl::container_type::array:
+                if (++m_index < c.values.size())
+                {
+                    m_low = c.values[m_index];
+                    return *this;
+                }
+                break;
+            case sbsimpl::container_type::bitmap:
+                m_low = sbsimpl::bitmap_lower_bound(c.bits.data(), m_low + 1);
+                if (m_low != sbsimpl::none) return *this;
+                break;
+            default:
+                if (m_low < c.run_last(m_index))
+                {
+                    ++m_low;
+                    return *this;
+                }
+                if (++m_index < c.num_runs())
+                {
+                    m_low = c.run_start(m_index);
+                    return *this;
+                }
+            }
+            ++m_chunk;
+            first_in_chunk();
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept
+        {
+            auto ret = *this;
+            ++*this;
+            return ret;
+        }
+
+        bool operator==(const const_iterator& other) const noexcept
+        {
+            return m_chunk == other.m_chunk && (m_chunk == m_end || m_low == other.m_low);
+        }
+        bool operator!=(const const_iterator& other) const noexcept { return !operator==(other); }
+
+    private:
+        friend class sparse_bitset;
+        using chunk_iterator = std::vector<sparse_bitset::chunk>::const_iterator;
+
+        const_iterator(chunk_iterator c, chunk_iterator end) noexcept : m_chunk(c), m_end(end)
+        {
+            first_in_chunk();
+        }
+
+        void first_in_chunk() noexcept
+        {
+            m_index = 0;
+            if (m_chunk == m_end) return;
+            m_low = m_chunk->c.lower_bound(0);
+        }
+
+        chunk_iterator m_chunk = {};
+        chunk_iterator m_end = {};
+        size_t m_index = 0; // array: index of the value, runs: index of the run
+        uint32_t m_low = 0;
+    };
+
+    const_iterator begin() const noexcept { return const_iterator(m_chunks.begin(), m_chunks.end()); }
+    const_iterator end() const noexcept { return const_iterator(m_chunks.end(), m_chunks.end()); }
+
+private:
+    static uint16_t hi(uint32_t i) noexcept { return uint16_t(i >> 16); }
+    static uint16_t lo(uint32_t i) noexcept { return uint16_t(i); }
+    static size_type value(uint16_t key, uint32_t low) noexcept { return (size_type(key) << 16) | low; }
+
+    std::vector<chunk>::iterator chunk_lower_bound(uint16_t key) noexcept
+    {
+        return std::lower_bound(m_chunks.begin(), m_chunks.end(), key, [](const chunk& c, uint16_t k) { return c.key < k; });
+    }
+    std::vector<chunk>::const_iterator chunk_lower_bound(uint16_t key) const noexcept
+    {
+        return std::lower_bound(m_chunks.begin(), m_chunks.end(), key, [](const chunk& c, uint16_t k) { return c.key < k; });
+    }
+
+    const sbsimpl::container* find_chunk(uint16_t key) const noexcept
+    {
+        auto f = chunk_lower_bound(key);
+        if (f == m_chunks.end() || f->key != key) return nullptr;
+        return &f->c;
+    }
+
+    sbsimpl::container& get_chunk(uint16_t key)
+    {
+        auto f = chunk_lower_bound(key);
+        if (f == m_chunks.end() || f->key != key)
+        {
+            f = m_chunks.insert(f, chunk{key, sbsimpl::container{}});
+        }
+        return f->c;
+    }
+
+    // or and xor: chunks of other which are not in this are copied
+    template <typename Op>
+    sparse_bitset& merge(const sparse_bitset& other)
+    {
+        std::vector<chunk> result;
+        result.reserve(m_chunks.size() + other.m_chunks.size());
+        auto i = m_chunks.begin();
+        auto o = other.m_chunks.begin();
+        while (i != m_chunks.end() || o != other.m_chunks.end())
+        {
+            if (o == other.m_chunks.end() || (i != m_chunks.end() && i->key < o->key))
+            {
+                result.push_back(std::move(*i++));
+            }
+            else if (i == m_chunks.end() || o->key < i->key)
+            {
+                result.push_back(*o++);
+            }
+            else
+            {
+                sbsimpl::apply<Op>(i->c, o->c);
+                if (i->c.card) result.push_back(std::move(*i));
+                ++i;
+                ++o;
+            }
+        }
+        m_chunks.swap(result);
+        return *this;
+    }
+};
+
+}
@@ -1,11 +1,11 @@
-// itlib-transparent_umap v0.10
+// itlib-transparent_umap v1.01
 //
 // A a really transparent unordered map which includes the C++23 and C++26
 // features they forgot to add in C++20.
 //
 // SPDX-License-Identifier: MIT
 // MIT License:
-// Copyright(c) 2024 Borislav Stanimirov
+// Copyright(c) 2024-2026 Borislav Stanimirov
 //
 // Permission is hereby granted, free of charge, to any person obtaining
 // a copy of this software and associated documentation files(the
@@ -29,6 +29,7 @@
 //
 //                  VERSION HISTORY
 //
+//  1.01 (2026-10-16) node_pool_allocator and pooled_transparent_umap
 //  1.00 (2024-xx-xx) Initial release
 //
 //
@@ -43,6 +44,25 @@
 // * operator[]
 // * at()
 //
+// It also defines itlib::node_pool_allocator: an allocator which keeps
+// freed nodes of node-based containers in a free list and reuses them for
+// new nodes. Nodes are allocated in chunks of increasing size. Allocations of
+// more than one element, like the bucket arrays of unordered maps, go to
+// std::allocator. Thus a map which frequently inserts and erases elements
+// rarely reaches malloc (and doesn't compete with other threads for it).
+//
+// The pool is shared among copies of the allocator, and freed when the last
+// of them is destroyed. Memory is not returned to the system before that.
+// The pool is not thread safe. Containers copy their allocators, so each
+// container has its own pool: copying a container creates a new one. It's
+// safe to use containers from different threads, as long as they would be
+// safe to use with std::allocator. The exception is a moved-from container,
+// which still shares the pool with the one it was moved to. Don't use it
+// concurrently with that.
+//
+// itlib::pooled_transparent_umap is a transparent_umap with a
+// node_pool_allocator.
+//
 //
 //                  TESTS
 //
@@ -53,6 +73,9 @@
 #include <unordered_map>
 #include <type_traits>
 #include <stdexcept>
+#include <memory>
+#include <vector>
+#include <cstddef>
 
 namespace itlib {
 
@@ -61,8 +84,140 @@ template <typename T, typename = void>
 constexpr bool is_transparent = false;
 template <class T>
 constexpr bool is_transparent<T, std::void_t<typename T::is_transparent>> = true;
+
+// free lists of fixed size blocks
+// a list per block size, though node-based containers only have one
+class node_pool {
+public:
+    node_pool() = default;
+    node_pool(const node_pool&) = delete;
+    node_pool& operator=(const node_pool&) = delete;
+
+    ~node_pool() {
+        for (auto chunk : m_chunks) {
+            ::operator delete(chunk);
+        }
+    }
+
+    void* allocate(size_t size) {
+        auto& l = list_for(size);
+        if (!l.free) grow(l);
+        auto ret = l.free;
+        l.free = ret->next;
+        return ret;
+    }
+
+    void deallocate(void* p, size_t size) noexcept {
+        // the list must exist as the block was allocated from it
+        auto& l = *find_list(size);
+        auto b = static_cast<block*>(p);
+        b->next = l.free;
+        l.free = b;
+    }
+
+private:
+    struct block {
+        block* next;
+    };
+
+    struct list {
+        size_t block_size;
+        block* free;
+        size_t next_chunk_blocks;
+    };
+
+    static constexpr size_t first_chunk_blocks = 32;
+    static constexpr size_t max_chunk_blocks = 1024;
+
+    static size_t block_size_for(size_t size) noexcept {
+        constexpr size_t align = alignof(std::max_align_t);
+        if (size < sizeof(block)) size = sizeof(block);
+        return (size + align - 1) / align * align;
+    }
+
+    list* find_list(size_t size) noexcept {
+        const auto bsize = block_size_for(size);
+        for (auto& l : m_lists) {
+            if (l.block_size == bsize) return &l;
+        }
+        return nullptr;
+    }
+
+    list& list_for(size_t size) {
+        if (auto l = find_list(size)) return *l;
+        m_lists.push_back({block_size_for(size), nullptr, first_chunk_blocks});
+        return m_lists.back();
+    }
+
+    void grow(list& l) {
+        const auto num_blocks = l.next_chunk_blocks;
+        m_chunks.reserve(m_chunks.size() + 1); // so that push_back won't throw after the allocation
+        auto chunk = static_cast<char*>(::operator new(num_blocks * l.block_size));
+        m_chunks.push_back(chunk);
+
+        for (size_t i = num_blocks; i-- > 0; ) {
+            auto b = reinterpret_cast<block*>(chunk + i * l.block_size);
+            b->next = l.free;
+            l.free = b;
+        }
+
+        if (l.next_chunk_blocks < max_chunk_blocks) l.next_chunk_blocks *= 2;
+    }
+
+    std::vector<list> m_lists;
+    std::vector<void*> m_chunks;
+};
 } // namespace tumimpl
 
+template <typename T>
+class node_pool_allocator {
+public:
+    using value_type = T;
+
+    // each container has its own pool
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    node_pool_allocator() : m_pool(std::make_shared<tumimpl::node_pool>()) {}
+
+    // no move: moved-from allocators must still work
+    node_pool_allocator(const node_pool_allocator&) noexcept = default;
+    node_pool_allocator& operator=(const node_pool_allocator&) noexcept = default;
+
+    template <typename U>
+    node_pool_allocator(const node_pool_allocator<U>& other) noexcept : m_pool(other.m_pool) {}
+
+    T* allocate(size_t n) {
+        if (!use_pool(n)) return std::allocator<T>().allocate(n);
+        return static_cast<T*>(m_pool->allocate(sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        if (!use_pool(n)) return std::allocator<T>().deallocate(p, n);
+        m_pool->deallocate(p, sizeof(T));
+    }
+
+    node_pool_allocator select_on_container_copy_construction() const {
+        return {};
+    }
+
+    template <typename U>
+    bool operator==(const node_pool_allocator<U>& other) const noexcept { return m_pool == other.m_pool; }
+    template <typename U>
+    bool operator!=(const node_pool_allocator<U>& other) const noexcept { return m_pool != other.m_pool; }
+
+private:
+    template <typename> friend class node_pool_allocator;
+
+    static bool use_pool(size_t n) noexcept {
+        return n == 1 && alignof(T) <= alignof(std::max_align_t);
+    }
+
+    std::shared_ptr<tumimpl::node_pool> m_pool;
+};
+
 // yes... a macro
 // C++ still lacks the ability to
 // #define I_ITLIB_EIT(T)
@@ -137,5 +292,12 @@ public:
     }
 };
 
+template <
+    typename Key,
+    typename T,
+    typename Hash = std::hash<Key>,
+    typename KeyEqual = std::equal_to<Key>
+>
+using pooled_transparent_umap = transparent_umap<Key, T, Hash, KeyEqual, node_pool_allocator<std::pair<const Key, T>>>;
 
 } // namespace itlib
@@ -1,4 +1,4 @@
-// itlib-ufunction v1.03
+// itlib-ufunction v2.01
 //
 // Unique Function
 // Non-copyable and noexcept move-constructible replacement for std::function
@@ -30,6 +30,9 @@
 //
 //                  VERSION HISTORY
 //
+//  2.01 (2026-10-16) Custom allocators
+//  2.00 (2026-10-16) Standalone implementation (not based on std::function)
+//                    with a configurable inline buffer
 //  1.03 (2026-01-15) Move assignment from nullptr_t to the template
 //                    assignment overload to allow the `ufunc = {}` syntax
 //  1.02 (2024-09-24) Allow binding to copies of source functions as per C++23
@@ -53,6 +56,25 @@
 // You can use itlib::ufunction in most places where you would use
 // std::function as long as you don't copy it
 //
+// The second template argument of ufunction is the size of its inline buffer:
+// itlib::ufunction<F, InlineSize>. It defaults to 3 pointers. Function objects
+// which fit in it and are nothrow move-constructible are stored inline and
+// don't allocate. Others are allocated on the heap. Function pointers are
+// always stored inline.
+// Note that this means that moving a ufunction may move the function object
+// inside.
+//
+// The third template argument is an allocator for the function objects which
+// don't fit in the inline buffer: itlib::ufunction<F, InlineSize, Alloc>.
+// The allocator is compatible with C++20's std::pmr::polymorphic_allocator and
+// itlib::pmr_allocator (same as the one of itlib::any). A default allocator is
+// provided. Heap blocks hold a copy of the allocator which created them, so
+// moving ufunction-s with different allocators is safe as long as the memory
+// behind the allocators is alive.
+// ufunction is allocator-aware and works with std::pmr containers. Use
+// ufunction(std::allocator_arg, alloc, func) to create a ufunction with an
+// allocator.
+//
 // ufunction is essentially equivalent to std::move_only_function from C++23
 //
 // Example:
@@ -60,6 +82,9 @@
 // std::unique_ptr<foo> fp;
 // itlib::ufunction<void()> = [captured = std::move(fp)]() { ... }
 //
+// // inline capacity for bigger captures
+// itlib::ufunction<void(), 64> f = [x = std::move(fp), a, b, c]() { ... }
+//
 //
 //                  TESTS
 //
@@ -68,29 +93,278 @@
 //
 #pragma once
 
-#include <functional>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <functional> // std::bad_function_call
+#include <memory> // std::allocator_arg_t
+#include <new>
 #include <type_traits>
+#include <utility>
 
 namespace itlib
 {
 
-template <typename F>
-class ufunction : private std::function<F>
+namespace impl
+{
+// copied from itlib-any
+struct ufunction_default_allocator
+{
+    void* allocate_bytes(std::size_t n, std::size_t a)
+    {
+        // some aligned_alloc implementations fail for alignments below that of a pointer
+        // or sizes which are not a multiple of the alignment
+        if (a < alignof(void*)) a = alignof(void*);
+        n = (n + a - 1) / a * a;
+        void* ret =
+#if defined(_WIN32)
+            _aligned_malloc(n, a);
+#else
+            aligned_alloc(a, n);
+#endif
+        if (!ret) throw std::bad_alloc{};
+        return ret;
+    }
+    void deallocate_bytes(void* p, std::size_t /*n*/, std::size_t /*a*/) noexcept
+    {
+#if defined(_WIN32)
+        _aligned_free(p);
+#else
+        free(p);
+#endif
+    }
+};
+
+struct ufunction_ops
+{
+    // move-construct at dst and destroy src
+    // null if simply memcpy-ing the storage is enough
+    void (*relocate)(void* dst, void* src);
+
+    // null for trivially destructible inline function objects
+    void (*destroy)(void* storage);
+};
+
+// alignment of the inline buffer
+static constexpr std::size_t ufunction_inline_alignment = alignof(double) > alignof(void*) ? alignof(double) : alignof(void*);
+
+template <typename FO>
+struct ufunction_inline_ops
+{
+    static FO& get(void* storage) noexcept { return *static_cast<FO*>(storage); }
+
+    static void relocate(void* dst, void* src)
+    {
+        auto& s = get(src);
+        new (dst) FO(std::move(s));
+        s.~FO();
+    }
+
+    static void destroy(void* storage)
+    {
+        get(storage).~FO();
+    }
+
+    using relocate_fn = void (*)(void*, void*);
+    static constexpr relocate_fn get_relocate(std::false_type /*needs relocate*/) { return nullptr; }
+    static constexpr relocate_fn get_relocate(std::true_type /*needs relocate*/) { return &relocate; }
+
+    using destroy_fn = void (*)(void*);
+    static constexpr destroy_fn get_destroy(std::false_type /*needs destroy*/) { return nullptr; }
+    static constexpr destroy_fn get_destroy(std::true_type /*needs destroy*/) { return &destroy; }
+
+    static const ufunction_ops value;
+};
+
+template <typename FO>
+const ufunction_ops ufunction_inline_ops<FO>::value = {
+    get_relocate(std::integral_constant<bool, !std::is_trivially_copyable<FO>::value>{}),
+    get_destroy(std::integral_constant<bool, !std::is_trivially_destructible<FO>::value>{}),
+};
+
+// heap blocks hold a copy of the allocator which was used to create them
+template <typename FO, typename Alloc>
+struct ufunction_heap_block : private /*EBO*/ Alloc
 {
-    using function = std::function<F>;
+    FO func;
+
+    template <typename F>
+    ufunction_heap_block(const Alloc& a, F&& f) : Alloc(a), func(std::forward<F>(f)) {}
+
+    const Alloc& get_allocator() const noexcept { return *this; }
+};
+
+template <typename FO, typename Alloc>
+struct ufunction_heap_ops
+{
+    using block = ufunction_heap_block<FO, Alloc>;
+
+    static FO& get(void* storage) noexcept { return (*static_cast<block**>(storage))->func; }
+
+    template <typename F>
+    static block* create(Alloc& alloc, F&& f)
+    {
+        void* buf = alloc.allocate_bytes(sizeof(block), alignof(block));
+        try
+        {
+            return new (buf) block(alloc, std::forward<F>(f));
+        }
+        catch (...)
+        {
+            alloc.deallocate_bytes(buf, sizeof(block), alignof(block));
+            throw;
+        }
+    }
+
+    static void destroy(void* storage)
+    {
+        auto b = *static_cast<block**>(storage);
+        Alloc alloc = b->get_allocator();
+        b->~block();
+        alloc.deallocate_bytes(b, sizeof(block), alignof(block));
+    }
+
+    static const ufunction_ops value;
+};
+
+template <typename FO, typename Alloc>
+const ufunction_ops ufunction_heap_ops<FO, Alloc>::value = {
+    nullptr, // moving the pointer is enough
+    &destroy,
+};
+
+template <typename...>
+struct ufunction_voider { using type = void; };
+
+template <typename...>
+struct ufunction_args {};
+
+// as with std::function the result of the function object must be implicitly convertible to R
+// (or discarded if R is void) and a reference R must not bind to a temporary
+template <typename Res, typename R>
+struct ufunction_returns_as : std::integral_constant<bool,
+    std::is_convertible<Res, R>::value
+    && (!std::is_reference<R>::value || (std::is_reference<Res>::value
+        && std::is_convertible<typename std::remove_reference<Res>::type*, typename std::remove_reference<R>::type*>::value))>
+{};
+
+template <typename Res>
+struct ufunction_returns_as<Res, void> : std::true_type {};
+
+template <typename FO, typename R, typename ArgList, typename = void>
+struct ufunction_callable : std::false_type {};
+
+template <typename FO, typename R, typename... Args>
+struct ufunction_callable<FO, R, ufunction_args<Args...>,
+    typename ufunction_voider<decltype(std::declval<FO&>()(std::declval<Args>()...))>::type>
+    : ufunction_returns_as<decltype(std::declval<FO&>()(std::declval<Args>()...)), R>
+{};
+
+template <typename R, typename ArgList>
+struct ufunction_callable<std::nullptr_t, R, ArgList> : std::true_type {};
+} // namespace impl
+
+template <typename F, std::size_t InlineSize = 3 * sizeof(void*), typename Alloc = impl::ufunction_default_allocator>
+class ufunction;
+
+template <typename R, typename... Args, std::size_t InlineSize, typename Alloc>
+class ufunction<R(Args...), InlineSize, Alloc> : private /*EBO*/ Alloc
+{
+    using invoke_fn = R (*)(void*, Args&&...);
+
+    union storage
+    {
+        void* heap;
+        alignas(impl::ufunction_inline_alignment) unsigned char buf[InlineSize > sizeof(void*) ? InlineSize : sizeof(void*)];
+    };
+
+    mutable storage m_storage;
+    invoke_fn m_invoke = &empty_invoke;
+    const impl::ufunction_ops* m_ops = nullptr; // null when empty
+
+    template <typename FO>
+    struct fits_inline : std::integral_constant<bool,
+        sizeof(FO) <= InlineSize
+        && alignof(FO) <= impl::ufunction_inline_alignment
+        && std::is_nothrow_move_constructible<FO>::value>
+    {};
+
+    template <typename FO>
+    using enable_if_callable = typename std::enable_if<impl::ufunction_callable<FO, R, impl::ufunction_args<Args...>>::value>::type;
+
+    [[noreturn]] static R empty_invoke(void*, Args&&...)
+    {
+        throw std::bad_function_call();
+    }
+
+    template <typename Ops>
+    static R invoke(void* storage, Args&&... args)
+    {
+        return call(std::is_void<R>{}, Ops::get(storage), std::forward<Args>(args)...);
+    }
+
+    // the result of the function object (if any) is discarded for void signatures
+    template <typename FO>
+    static R call(std::true_type /*void R*/, FO& f, Args&&... args)
+    {
+        f(std::forward<Args>(args)...);
+    }
+
+    template <typename FO>
+    static R call(std::false_type /*void R*/, FO& f, Args&&... args)
+    {
+        return f(std::forward<Args>(args)...);
+    }
+
 public:
+    using allocator_type = Alloc;
+
     ufunction() noexcept = default;
 
-    ufunction(std::nullptr_t) noexcept : function(nullptr) {}
+    ufunction(std::nullptr_t) noexcept {}
+
+    explicit ufunction(const Alloc& a) noexcept : Alloc(a) {}
+    ufunction(std::allocator_arg_t, const Alloc& a) noexcept : Alloc(a) {}
 
     ufunction(const ufunction&) = delete;
     ufunction operator=(const ufunction&) = delete;
 
-    ufunction(ufunction&&) noexcept = default;
-    ufunction& operator=(ufunction&&) noexcept = default;
+    ufunction(ufunction&& other) noexcept : Alloc(other.get_allocator())
+    {
+        take(other);
+    }
 
-    template <typename FO>
-    ufunction(FO f) noexcept : function(copy_wrapper<FO>{std::move(f)}) {}
+    // the allocator is only used for new function objects
+    // heap blocks of other are taken as they are (they hold their own allocator)
+    ufunction(std::allocator_arg_t, const Alloc& a, ufunction&& other) noexcept : Alloc(a)
+    {
+        take(other);
+    }
+    ufunction& operator=(ufunction&& other) noexcept
+    {
+        if (&other == this) return *this; // prevent self usurp
+        reset();
+        take(other);
+        return *this;
+    }
+
+    ~ufunction()
+    {
+        reset();
+    }
+
+    template <typename FO, typename = enable_if_callable<FO>>
+    ufunction(FO f) noexcept(fits_inline<FO>::value)
+    {
+        emplace(std::move(f));
+    }
+
+    template <typename FO, typename = enable_if_callable<FO>>
+    ufunction(std::allocator_arg_t, const Alloc& a, FO f) noexcept(fits_inline<FO>::value)
+        : Alloc(a)
+    {
+        emplace(std::move(f));
+    }
 
     // this also servers to handle ufunc = nullptr_t
     // we use it instead of a separate assignment overload for nullptr_t, to allow us to write
@@ -98,58 +372,93 @@ public:
     // `ufunc = {}` will resolve to operator=(F* fptr) which is a tiny bit slower than assigning
     // nullptr_t directly (because of an additional if check) but we consider it negligible
     // and worth the syntactic sugar
-    template <typename FO>
-    ufunction& operator=(FO f) noexcept
-    {
-        function::operator=(
-            typename std::conditional<
-                std::is_same<FO, std::nullptr_t>::value,
-                std::nullptr_t,
-                copy_wrapper<FO>
-            >::type(std::move(f))
-        );
+    template <typename FO, typename = enable_if_callable<FO>>
+    ufunction& operator=(FO f) noexcept(fits_inline<FO>::value)
+    {
+        reset();
+        emplace(std::move(f));
         return *this;
     }
 
     // function pointer overloads (otherwise clang and gcc complain for const_cast of function pointers)
-    // noexcept since we're relying on the small function optimization to kick in here
-    // we can also afford to disregard the copy wrapper here since function pointers are copyable
-
-    ufunction(F* fptr) noexcept : function(fptr) {}
-    ufunction& operator=(F* fptr) noexcept
+    ufunction(R(*fptr)(Args...)) noexcept
     {
-        function::operator=(fptr);
+        emplace(fptr);
+    }
+    ufunction& operator=(R(*fptr)(Args...)) noexcept
+    {
+        reset();
+        emplace(fptr);
         return *this;
     }
 
-    using function::operator bool;
-    using function::operator();
+    explicit operator bool() const noexcept { return !!m_ops; }
+
+    Alloc get_allocator() const noexcept { return *this; }
+
+    R operator()(Args... args) const
+    {
+        return m_invoke(&m_storage, std::forward<Args>(args)...);
+    }
+
 private:
+    void reset() noexcept
+    {
+        if (!m_ops) return;
+        if (m_ops->destroy) m_ops->destroy(&m_storage);
+        m_ops = nullptr;
+        m_invoke = &empty_invoke;
+    }
+
+    // assumes we're empty
+    void take(ufunction& other) noexcept
+    {
+        if (!other.m_ops) return;
+        if (other.m_ops->relocate) other.m_ops->relocate(&m_storage, &other.m_storage);
+        else std::memcpy(&m_storage, &other.m_storage, sizeof(storage));
+        m_ops = other.m_ops;
+        m_invoke = other.m_invoke;
+        other.m_ops = nullptr;
+        other.m_invoke = &empty_invoke;
+    }
+
+    // assumes we're empty
+    void emplace(std::nullptr_t) noexcept {}
+
     template <typename FO>
-    struct copy_wrapper
+    void emplace(FO* fptr) noexcept
     {
-        static_assert(!std::is_const<FO>::value, "Cannot bind to a const function");
-        FO func_object;
-        copy_wrapper(FO&& f) : func_object(std::move(f)) {}
+        if (!fptr) return;
+        emplace_func(fptr, std::true_type{});
+    }
 
-        // we need these copy ops in order for our parent std::function to compile, but they will never be called
-        copy_wrapper(const copy_wrapper& other) : func_object(const_cast<FO&&>(other.func_object)) { throw 0; } // should never get to here
-        copy_wrapper& operator=(const copy_wrapper&) { throw 0; } // should never get to here
+    template <typename FO>
+    void emplace(FO&& f)
+    {
+        using fo_t = typename std::decay<FO>::type;
+        static_assert(!std::is_const<fo_t>::value, "Cannot bind to a const function");
+        emplace_func(std::forward<FO>(f), fits_inline<fo_t>{});
+    }
 
-        // not `= default` so we can force noexcept
-        copy_wrapper(copy_wrapper&& other) noexcept : func_object(std::move(other.func_object)) {}
-        copy_wrapper& operator=(copy_wrapper&& other) noexcept
-        {
-            func_object = std::move(other.func_object);
-            return *this;
-        }
+    template <typename FO>
+    void emplace_func(FO&& f, std::true_type /*inline*/)
+    {
+        using fo_t = typename std::decay<FO>::type;
+        using ops = impl::ufunction_inline_ops<fo_t>;
+        new (m_storage.buf) fo_t(std::forward<FO>(f));
+        m_ops = &ops::value;
+        m_invoke = &invoke<ops>;
+    }
 
-        template <typename... Args>
-        auto operator()(Args&&... args) -> decltype(func_object(std::forward<Args>(args)...))
-        {
-            return func_object(std::forward<Args>(args)...);
-        }
-    };
+    template <typename FO>
+    void emplace_func(FO&& f, std::false_type /*inline*/)
+    {
+        using fo_t = typename std::decay<FO>::type;
+        using ops = impl::ufunction_heap_ops<fo_t, Alloc>;
+        m_storage.heap = ops::create(*this, std::forward<FO>(f));
+        m_ops = &ops::value;
+        m_invoke = &invoke<ops>;
+    }
 };
 
 }
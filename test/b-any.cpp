@@ -0,0 +1,121 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include <itlib/any.hpp>
+#include <any>
+#include <string>
+#include <vector>
+
+#define PICOBENCH_IMPLEMENT
+#include <picobench/picobench.hpp>
+
+#define uauto [[maybe_unused]] auto
+
+struct small_val {
+    int value;
+    small_val(int v) : value(v) {}
+    int get() const { return value; }
+};
+
+struct large_val {
+    int value;
+    std::string name = "some string which is too long for sso";
+    large_val(int v) : value(v) {}
+    int get() const { return value; }
+};
+
+template <typename T>
+T* cast(std::any& a) { return std::any_cast<T>(&a); }
+template <typename T>
+T* cast(itlib::any<>& a) { return itlib::any_cast<T>(&a); }
+
+template <typename Any, typename T>
+void bench_construct(picobench::state& s) {
+    uintptr_t sum = 0;
+    for (auto i : s) {
+        Any a{T(i)};
+        sum += cast<T>(a)->get();
+    }
+    s.set_result(sum);
+}
+
+template <typename Any, typename T>
+void bench_copy(picobench::state& s) {
+    std::vector<Any> src;
+    for (int i = 0; i < 100; ++i) {
+        src.emplace_back(T(i));
+    }
+    uintptr_t sum = 0;
+    for (uauto _ : s) {
+        auto copy = src;
+        sum += cast<T>(copy.back())->get();
+    }
+    s.set_result(sum);
+}
+
+template <typename Any, typename T>
+void bench_move(picobench::state& s) {
+    Any a(T(5)), b;
+    uintptr_t sum = 0;
+    for (uauto _ : s) {
+        b = std::move(a);
+        a = std::move(b);
+        sum += cast<T>(a)->get();
+    }
+    s.set_result(sum);
+}
+
+template <typename Any, typename T>
+void bench_cast(picobench::state& s) {
+    std::vector<Any> vec;
+    for (int i = 0; i < 100; ++i) {
+        if (i % 2) vec.emplace_back(T(i));
+        else vec.emplace_back(i * 0.5);
+    }
+    uintptr_t sum = 0;
+    for (uauto _ : s) {
+        for (auto& a : vec) {
+            if (auto p = cast<T>(a)) sum += p->get();
+        }
+    }
+    s.set_result(sum);
+}
+
+// picobench stores the suite names as pointers, so they must be literals
+struct suite_names {
+    const char* construct;
+    const char* copy;
+    const char* move;
+    const char* cast;
+};
+
+template <typename T>
+void add_benchmarks(picobench::local_runner& r, const suite_names& names) {
+    r.set_suite(names.construct);
+    r.add_benchmark("std", bench_construct<std::any, T>);
+    r.add_benchmark("itlib", bench_construct<itlib::any<>, T>);
+
+    r.set_suite(names.copy);
+    r.add_benchmark("std", bench_copy<std::any, T>);
+    r.add_benchmark("itlib", bench_copy<itlib::any<>, T>);
+
+    r.set_suite(names.move);
+    r.add_benchmark("std", bench_move<std::any, T>);
+    r.add_benchmark("itlib", bench_move<itlib::any<>, T>);
+
+    r.set_suite(names.cast);
+    r.add_benchmark("std", bench_cast<std::any, T>);
+    r.add_benchmark("itlib", bench_cast<itlib::any<>, T>);
+}
+
+int main(int argc, char* argv[]) {
+    picobench::local_runner r;
+
+    add_benchmarks<small_val>(r, {"construct small", "copy small", "move small", "cast small"});
+    add_benchmarks<large_val>(r, {"construct large", "copy large", "move large", "cast large"});
+
+    r.set_compare_results_across_samples(true);
+    r.set_compare_results_across_benchmarks(true);
+    r.parse_cmd_line(argc, argv);
+    return r.run();
+}
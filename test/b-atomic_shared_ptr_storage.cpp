@@ -0,0 +1,107 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include <itlib/atomic_shared_ptr_storage.hpp>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+#define PICOBENCH_IMPLEMENT
+#include <picobench/picobench.hpp>
+
+#define uauto [[maybe_unused]] auto
+
+struct config {
+    int value;
+};
+
+using cptr = std::shared_ptr<const config>;
+
+// the timed thread loads in a loop while the background threads load (and optionally store)
+template <typename Holder>
+void bench_load(picobench::state& s, int num_readers, bool writer) {
+    Holder holder(std::make_shared<const config>(config{1}));
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_readers; ++i) {
+        threads.emplace_back([&]() {
+            while (!stop.load(std::memory_order_relaxed)) {
+                auto p = holder.load();
+                if (p->value == 0) break;
+            }
+        });
+    }
+    if (writer) {
+        threads.emplace_back([&]() {
+            int i = 1;
+            while (!stop.load(std::memory_order_relaxed)) {
+                holder.store(std::make_shared<const config>(config{++i}));
+            }
+        });
+    }
+
+    uintptr_t sum = 0;
+    {
+        picobench::scope scope(s);
+        for (uauto _ : s) {
+            auto p = holder.load();
+            sum += p->value != 0;
+        }
+    }
+
+    stop = true;
+    for (auto& t : threads) t.join();
+    s.set_result(sum);
+}
+
+template <typename Holder>
+void load_0(picobench::state& s) { bench_load<Holder>(s, 0, false); }
+template <typename Holder>
+void load_3(picobench::state& s) { bench_load<Holder>(s, 3, false); }
+template <typename Holder>
+void load_3_store(picobench::state& s) { bench_load<Holder>(s, 3, true); }
+
+using spinlock = itlib::impl::asps_spinlock_holder<const config>;
+#if ITLIB_ASPS_SPLIT_COUNT
+using split_count = itlib::impl::asps_split_count_holder<const config>;
+#endif
+#if defined(__cpp_lib_atomic_shared_ptr)
+using std_atomic = std::atomic<cptr>;
+#endif
+
+#define ADD_BENCHMARKS(func) \
+    r.add_benchmark("spinlock", func<spinlock>); \
+    ADD_SPLIT_COUNT(func) \
+    ADD_STD(func)
+
+#if ITLIB_ASPS_SPLIT_COUNT
+#   define ADD_SPLIT_COUNT(func) r.add_benchmark("split count", func<split_count>);
+#else
+#   define ADD_SPLIT_COUNT(func)
+#endif
+
+#if defined(__cpp_lib_atomic_shared_ptr)
+#   define ADD_STD(func) r.add_benchmark("std::atomic", func<std_atomic>);
+#else
+#   define ADD_STD(func)
+#endif
+
+int main(int argc, char* argv[]) {
+    picobench::local_runner r;
+
+    r.set_suite("load");
+    ADD_BENCHMARKS(load_0)
+
+    r.set_suite("load + 3 readers");
+    ADD_BENCHMARKS(load_3)
+
+    r.set_suite("load + 3 readers + writer");
+    ADD_BENCHMARKS(load_3_store)
+
+    r.set_compare_results_across_samples(true);
+    r.set_compare_results_across_benchmarks(true);
+    r.parse_cmd_line(argc, argv);
+    return r.run();
+}
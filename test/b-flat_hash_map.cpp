@@ -0,0 +1,166 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include <itlib/flat_hash_map.hpp>
+#include <itlib/transparent_umap.hpp>
+#include <unordered_map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <random>
+
+#define PICOBENCH_IMPLEMENT
+#include <picobench/picobench.hpp>
+
+#define uauto [[maybe_unused]] auto
+
+struct string_hash {
+    using is_transparent = void;
+    size_t operator()(std::string_view str) const { return std::hash<std::string_view>{}(str); }
+};
+
+template <template <typename...> class Map>
+using int_map = Map<uint32_t, uint32_t>;
+
+template <template <typename...> class Map>
+using string_map = Map<std::string, uint32_t, string_hash, std::equal_to<>>;
+
+constexpr uint32_t num_keys = 10000;
+
+std::vector<uint32_t> make_int_keys() {
+    std::minstd_rand rng(42);
+    std::vector<uint32_t> ret;
+    for (uint32_t i = 0; i < num_keys; ++i) {
+        ret.push_back(uint32_t(rng()));
+    }
+    return ret;
+}
+
+std::vector<std::string> make_string_keys() {
+    std::minstd_rand rng(42);
+    std::vector<std::string> ret;
+    for (uint32_t i = 0; i < num_keys; ++i) {
+        ret.push_back("cache/entry/" + std::to_string(rng()));
+    }
+    return ret;
+}
+
+const std::vector<uint32_t> int_keys = make_int_keys();
+const std::vector<std::string> string_keys = make_string_keys();
+
+// the default iterations of picobench are fewer than num_keys, so all keys are new
+template <typename Map>
+void bench_insert_int(picobench::state& s) {
+    Map map;
+    for (auto i : s) {
+        map[int_keys[i]] = uint32_t(i);
+    }
+    s.set_result(uint32_t(map.size()));
+}
+
+template <typename Map>
+void bench_find_int(picobench::state& s) {
+    Map map;
+    for (size_t i = 0; i < int_keys.size(); i += 2) {
+        map[int_keys[i]] = uint32_t(i);
+    }
+    uint32_t sum = 0;
+    size_t i = 0;
+    for (uauto _ : s) {
+        auto f = map.find(int_keys[i]);
+        if (f != map.end()) sum += f->second;
+        if (++i == int_keys.size()) i = 0;
+    }
+    s.set_result(sum);
+}
+
+template <typename Map>
+void bench_erase_insert_int(picobench::state& s) {
+    Map map;
+    for (auto k : int_keys) {
+        map[k] = k;
+    }
+    uint32_t sum = 0;
+    size_t i = 0;
+    for (uauto _ : s) {
+        const auto k = int_keys[i];
+        map.erase(k);
+        map[k + 1] = k;
+        sum += uint32_t(map.size());
+        if (++i == int_keys.size()) i = 0;
+    }
+    s.set_result(sum);
+}
+
+template <typename Map>
+void bench_insert_string(picobench::state& s) {
+    Map map;
+    for (auto i : s) {
+        map.emplace(string_keys[i], uint32_t(i));
+    }
+    s.set_result(uint32_t(map.size()));
+}
+
+template <typename Map>
+void bench_find_string(picobench::state& s) {
+    Map map;
+    for (size_t i = 0; i < string_keys.size(); i += 2) {
+        map[string_keys[i]] = uint32_t(i);
+    }
+    uint32_t sum = 0;
+    size_t i = 0;
+    for (uauto _ : s) {
+        auto f = map.find(std::string_view(string_keys[i]));
+        if (f != map.end()) sum += f->second;
+        if (++i == string_keys.size()) i = 0;
+    }
+    s.set_result(sum);
+}
+
+template <typename Map>
+void bench_subscript_string(picobench::state& s) {
+    Map map;
+    uint32_t sum = 0;
+    size_t i = 0;
+    for (uauto _ : s) {
+        sum += ++map[string_keys[i]];
+        if (++i == string_keys.size()) i = 0;
+    }
+    s.set_result(sum);
+}
+
+int main(int argc, char* argv[]) {
+    picobench::local_runner r;
+
+    r.set_suite("insert int");
+    r.add_benchmark("std", bench_insert_int<int_map<std::unordered_map>>);
+    r.add_benchmark("flat_hash_map", bench_insert_int<int_map<itlib::flat_hash_map>>);
+
+    r.set_suite("find int");
+    r.add_benchmark("std", bench_find_int<int_map<std::unordered_map>>);
+    r.add_benchmark("flat_hash_map", bench_find_int<int_map<itlib::flat_hash_map>>);
+
+    r.set_suite("erase+insert int");
+    r.add_benchmark("std", bench_erase_insert_int<int_map<std::unordered_map>>);
+    r.add_benchmark("flat_hash_map", bench_erase_insert_int<int_map<itlib::flat_hash_map>>);
+
+    r.set_suite("insert string");
+    r.add_benchmark("std", bench_insert_string<string_map<std::unordered_map>>);
+    r.add_benchmark("transparent_umap", bench_insert_string<string_map<itlib::transparent_umap>>);
+    r.add_benchmark("flat_hash_map", bench_insert_string<string_map<itlib::flat_hash_map>>);
+
+    r.set_suite("find string_view");
+    r.add_benchmark("std", bench_find_string<string_map<std::unordered_map>>);
+    r.add_benchmark("transparent_umap", bench_find_string<string_map<itlib::transparent_umap>>);
+    r.add_benchmark("flat_hash_map", bench_find_string<string_map<itlib::flat_hash_map>>);
+
+    r.set_suite("subscript string");
+    r.add_benchmark("std", bench_subscript_string<string_map<std::unordered_map>>);
+    r.add_benchmark("transparent_umap", bench_subscript_string<string_map<itlib::transparent_umap>>);
+    r.add_benchmark("flat_hash_map", bench_subscript_string<string_map<itlib::flat_hash_map>>);
+
+    r.set_compare_results_across_samples(true);
+    r.set_compare_results_across_benchmarks(true);
+    r.parse_cmd_line(argc, argv);
+    return r.run();
+}
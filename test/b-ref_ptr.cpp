@@ -0,0 +1,137 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include <itlib/ref_ptr.hpp>
+#include <memory>
+#include <vector>
+#include <string>
+#include <thread>
+
+#define PICOBENCH_IMPLEMENT
+#include <picobench/picobench.hpp>
+
+#define uauto [[maybe_unused]] auto
+
+#if defined(_MSC_VER)
+#   define NOINLINE __declspec(noinline)
+#else
+#   define NOINLINE __attribute__((noinline))
+#endif
+
+struct state {
+    std::string name;
+    int value;
+};
+
+template <typename Ptr>
+struct ptr_traits;
+
+template <>
+struct ptr_traits<std::shared_ptr<const state>> {
+    static std::shared_ptr<const state> make(int i) {
+        return std::make_shared<state>(state{"state", i});
+    }
+};
+
+template <>
+struct ptr_traits<itlib::ref_ptr<const state>> {
+    static itlib::ref_ptr<const state> make(int i) {
+        return itlib::make_ref_ptr<state>(state{"state", i});
+    }
+};
+
+template <>
+struct ptr_traits<itlib::ref_ptr_st<const state>> {
+    static itlib::ref_ptr_st<const state> make(int i) {
+        return itlib::make_ref_ptr_st<state>(state{"state", i});
+    }
+};
+
+template <typename Ptr>
+void bench_make(picobench::state& s) {
+    uintptr_t sum = 0;
+    for (auto i : s) {
+        auto p = ptr_traits<Ptr>::make(i);
+        sum += p->value;
+    }
+    s.set_result(sum);
+}
+
+template <typename Ptr>
+NOINLINE int by_value(Ptr p) {
+    return p->value;
+}
+
+template <typename Ptr>
+void bench_pass_by_value(picobench::state& s) {
+    auto p = ptr_traits<Ptr>::make(3);
+    uintptr_t sum = 0;
+    for (uauto _ : s) {
+        sum += by_value(p);
+    }
+    s.set_result(sum);
+}
+
+template <typename Ptr>
+void bench_copy_vector(picobench::state& s) {
+    std::vector<Ptr> src;
+    for (int i = 0; i < 100; ++i) {
+        src.push_back(ptr_traits<Ptr>::make(i));
+    }
+    uintptr_t sum = 0;
+    for (uauto _ : s) {
+        auto copy = src;
+        sum += copy.back()->value + copy.back().use_count();
+    }
+    s.set_result(sum);
+}
+
+template <typename Ptr>
+void bench_unique_check(picobench::state& s) {
+    auto p = ptr_traits<Ptr>::make(1);
+    auto p2 = p;
+    uintptr_t sum = 0;
+    for (auto i : s) {
+        if (i % 2) p2 = p;
+        else p2.reset();
+        sum += p.use_count() == 1;
+    }
+    s.set_result(sum);
+}
+
+using sp = std::shared_ptr<const state>;
+using rp = itlib::ref_ptr<const state>;
+using rpst = itlib::ref_ptr_st<const state>;
+
+int main(int argc, char* argv[]) {
+    // libstdc++ skips the atomic ops of shared_ptr if no thread was ever started
+    // simulate a multi-threaded program
+    std::thread([] {}).join();
+
+    picobench::local_runner r;
+
+    r.set_suite("make");
+    r.add_benchmark("shared_ptr", bench_make<sp>);
+    r.add_benchmark("ref_ptr", bench_make<rp>);
+    r.add_benchmark("ref_ptr_st", bench_make<rpst>);
+
+    r.set_suite("pass by value");
+    r.add_benchmark("shared_ptr", bench_pass_by_value<sp>);
+    r.add_benchmark("ref_ptr", bench_pass_by_value<rp>);
+    r.add_benchmark("ref_ptr_st", bench_pass_by_value<rpst>);
+
+    r.set_suite("copy vector");
+    r.add_benchmark("shared_ptr", bench_copy_vector<sp>);
+    r.add_benchmark("ref_ptr", bench_copy_vector<rp>);
+    r.add_benchmark("ref_ptr_st", bench_copy_vector<rpst>);
+
+    r.set_suite("copy/reset + unique");
+    r.add_benchmark("shared_ptr", bench_unique_check<sp>);
+    r.add_benchmark("ref_ptr", bench_unique_check<rp>);
+    r.add_benchmark("ref_ptr_st", bench_unique_check<rpst>);
+
+    r.set_compare_results_across_samples(true);
+    r.set_compare_results_across_benchmarks(true);
+    r.parse_cmd_line(argc, argv);
+    return r.run();
+}
@@ -7,6 +7,7 @@
 
 #include <string>
 #include <vector>
+#include <mutex>
 
 TEST_CASE("basic") {
     itlib::any<> a;
@@ -36,23 +37,24 @@ TEST_CASE("basic") {
     a = std::unique_ptr<int>(new int(43));
     CHECK(a);
 
-    auto& uptr = *a.tdata<std::unique_ptr<int>>();
-    CHECK(*uptr == 43);
+    auto pint = a.tdata<std::unique_ptr<int>>()->get();
+    CHECK(*pint == 43);
 
     CHECK_THROWS_AS(b = a, std::bad_cast);
     CHECK_THROWS_AS(auto e = a, std::bad_cast);
 
+    // unique_ptr is stored inline, so it's moved with the any
     b = std::move(a);
     CHECK_FALSE(a);
     CHECK(b);
-    CHECK(&uptr == b.data());
-    CHECK(*uptr == 43);
+    CHECK(b.tdata<std::unique_ptr<int>>()->get() == pint);
+    CHECK(*pint == 43);
 
     auto e = std::move(b);
     CHECK_FALSE(b);
     CHECK(e);
-    CHECK(&uptr == e.data());
-    CHECK(*uptr == 43);
+    CHECK(e.tdata<std::unique_ptr<int>>()->get() == pint);
+    CHECK(*pint == 43);
 
     auto& str = a.emplace<std::string>("baz");
     CHECK(a);
@@ -118,4 +120,145 @@ TEST_CASE("any cast") {
         CHECK(take_str == "mnp");
         CHECK(pstr->empty());
     }
-}
\ No newline at end of file
+}
+
+struct counting_allocator {
+    int allocations = 0;
+    int deallocations = 0;
+    void* allocate_bytes(std::size_t n, std::size_t a) {
+        ++allocations;
+        return itlib::anyimpl::default_allocator{}.allocate_bytes(n, a);
+    }
+    void deallocate_bytes(void* p, std::size_t n, std::size_t a) noexcept {
+        ++deallocations;
+        itlib::anyimpl::default_allocator{}.deallocate_bytes(p, n, a);
+    }
+};
+
+struct big {
+    char buf[100];
+};
+
+struct throwing_move {
+    int value = 0;
+    throwing_move(int v) : value(v) {}
+    throwing_move(const throwing_move& o) : value(o.value) {}
+    throwing_move(throwing_move&& o) noexcept(false) : value(o.value) {}
+};
+
+TEST_CASE("small buffer") {
+    using cany = itlib::any<counting_allocator>;
+
+    {
+        cany a(5);
+        CHECK(a.get_allocator().allocations == 0);
+        CHECK(itlib::any_cast<int>(a) == 5);
+
+        a = std::unique_ptr<int>(new int(3));
+        a = 3.14;
+        CHECK(a.get_allocator().allocations == 0);
+
+        // whether std::vector fits in the default buffer depends on the standard library
+        const int vec_allocs = itlib::anyimpl::ops_for<std::vector<int>>::inline_size <= 3 * sizeof(void*) ? 0 : 1;
+        a = std::vector<int>{1, 2, 3};
+        CHECK(a.get_allocator().allocations == vec_allocs);
+
+        cany b = a;
+        CHECK(b.get_allocator().allocations == vec_allocs);
+        CHECK(itlib::any_cast<const std::vector<int>&>(b).size() == 3);
+
+        cany c = std::move(b);
+        CHECK_FALSE(b);
+        CHECK(c.get_allocator().allocations == vec_allocs);
+        CHECK(itlib::any_cast<const std::vector<int>&>(c).back() == 3);
+    }
+
+    {
+        cany a(big{});
+        CHECK(a.get_allocator().allocations == 1);
+        auto data = a.data();
+
+        // heap objects are not moved
+        cany b = std::move(a);
+        CHECK(b.data() == data);
+
+        b.reset();
+        CHECK(b.get_allocator().deallocations == 1);
+    }
+
+    {
+        cany a(throwing_move(4));
+        CHECK(a.get_allocator().allocations == 1);
+        auto data = a.data();
+
+        cany b = std::move(a);
+        CHECK(b.data() == data);
+        CHECK(itlib::any_cast<const throwing_move&>(b).value == 4);
+    }
+
+    {
+        // custom inline size
+        using tiny = itlib::any<counting_allocator, 0>;
+        using large = itlib::any<counting_allocator, sizeof(big)>;
+
+        tiny t(5);
+        CHECK(t.get_allocator().allocations == 1);
+
+        large l(big{});
+        CHECK(l.get_allocator().allocations == 0);
+
+        large l2 = t;
+        CHECK(l2.get_allocator().allocations == 0);
+        CHECK(itlib::any_cast<int>(l2) == 5);
+
+        tiny t2 = l;
+        CHECK(t2.get_allocator().allocations == 1);
+        CHECK(t2.type() == typeid(big));
+    }
+}
+
+TEST_CASE("ops table") {
+    static_assert(sizeof(itlib::any<>) == 4 * sizeof(void*), "ops pointer + 3 pointer inline buffer");
+
+    {
+        // values are decayed
+        std::string str = "lvalue";
+        itlib::any<> a = str;
+        str = "changed";
+        CHECK(itlib::any_cast<std::string>(a) == "lvalue");
+        CHECK(a.type() == typeid(std::string));
+    }
+
+    {
+        // non-movable and non-copyable
+        itlib::any<> a;
+        auto& m = a.emplace<std::mutex>();
+        CHECK(a.data() == &m);
+        itlib::any<> b;
+        CHECK_THROWS_AS(b = a, std::bad_cast);
+        CHECK_FALSE(b);
+
+        b = std::move(a);
+        CHECK_FALSE(a);
+        CHECK(b.data() == &m);
+    }
+
+    {
+        // trivially copyable: inline and heap
+        struct tc3 { int a, b, c; };
+        struct tc100 { int buf[100]; };
+        counting_allocator ca;
+        itlib::any<counting_allocator> a(std::allocator_arg, ca, tc3{1, 2, 3});
+        itlib::any<counting_allocator> b(std::allocator_arg, ca, tc100{{7}});
+        CHECK(a.get_allocator().allocations == 0);
+        CHECK(b.get_allocator().allocations == 1);
+
+        auto a2 = std::move(a);
+        CHECK(itlib::any_cast<tc3&>(a2).c == 3);
+        auto b2 = std::move(b);
+        CHECK(itlib::any_cast<tc100&>(b2).buf[0] == 7);
+        a2 = b2;
+        CHECK(itlib::any_cast<tc100&>(a2).buf[0] == 7);
+        CHECK(a2.get_allocator().allocations == 1);
+    }
+}
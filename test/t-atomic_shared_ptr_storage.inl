@@ -7,6 +7,7 @@
 
 #include <thread>
 #include <atomic>
+#include <vector>
 
 TEST_CASE("[itlib::atomic_shared_ptr_storage] basic") {
     static_assert(sizeof(itlib::atomic_shared_ptr_storage<int>) <= 64, "We want true sharing here");
@@ -139,3 +140,58 @@ TEST_CASE("[itlib::atomic_shared_ptr_storage] exchange") {
 
     CHECK(sum >= 2);
 }
+
+namespace {
+struct counted {
+    static std::atomic<int> alive;
+    int a, b;
+    counted(int i) : a(i), b(-i) { ++alive; }
+    ~counted() { --alive; }
+};
+std::atomic<int> counted::alive{0};
+}
+
+TEST_CASE("[itlib::atomic_shared_ptr_storage] stress") {
+    // objects must be consistent when loaded and all of them must be freed in the end
+
+    {
+        std::atomic<bool> start{false};
+        std::atomic<int> bad{0};
+
+        itlib::atomic_shared_ptr_storage<counted> storage;
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&, t]() {
+                while (!start);
+                for (int i = 0; i < 2000; ++i) {
+                    if (auto p = storage.load()) {
+                        if (p->a != -p->b) ++bad;
+                    }
+                    switch ((i + t) % 4) {
+                    case 0:
+                        storage.store(std::make_shared<counted>(i));
+                        break;
+                    case 1:
+                        storage.exchange(std::make_shared<counted>(i));
+                        break;
+                    case 2: {
+                        auto e = storage.load();
+                        storage.compare_exchange(e, std::make_shared<counted>(i));
+                        break;
+                    }
+                    default:
+                        if (i % 64 == 3) storage.store({});
+                        break;
+                    }
+                }
+            });
+        }
+
+        start = true;
+        for (auto& t : threads) t.join();
+        CHECK(bad == 0);
+        CHECK(counted::alive <= 1);
+    }
+    CHECK(counted::alive == 0);
+}
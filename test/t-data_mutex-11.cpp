@@ -10,6 +10,9 @@
 #include <cstdlib>
 #include <random>
 #include <thread>
+#include <atomic>
+#include <string>
+#include <cstdint>
 
 #include <doctest/doctest.h>
 
@@ -48,3 +51,87 @@ TEST_CASE("data_mutex std::mutex") {
     REQUIRE(l);
     CHECK(itlib::qnone_of(*l));
 }
+
+struct config {
+    int a;
+    int b;
+    double c;
+    char name[13];
+};
+
+TEST_CASE("data_mutex seqlock") {
+    itlib::data_mutex<config, itlib::seqlock<>> cfg(config{1, 2, 3.5, "xyz"});
+
+    auto c = cfg.read_optimistic();
+    CHECK(c.a == 1);
+    CHECK(c.b == 2);
+    CHECK(c.c == 3.5);
+    CHECK(std::string(c.name) == "xyz");
+
+    {
+        auto l = cfg.unique_lock();
+        l->a = 10;
+        CHECK(cfg.read_optimistic().a == 1); // published on unlock
+
+        config out{};
+        CHECK(cfg.try_read_optimistic(out)); // reads are not blocked by the writer lock
+        CHECK(out.a == 1);
+
+        auto tl = cfg.try_unique_lock();
+        CHECK_FALSE(tl);
+    }
+    CHECK(cfg.read_optimistic().a == 10);
+    CHECK(cfg.shared_lock()->a == 10);
+
+    {
+        auto tl = cfg.try_unique_lock();
+        REQUIRE(tl);
+        (*tl).b = 20;
+    }
+    CHECK(cfg.shared_lock()->b == 20);
+    CHECK(cfg.shared_lock()->c == 3.5);
+}
+
+TEST_CASE("data_mutex seqlock threads") {
+    struct pair {
+        uint64_t a;
+        uint64_t b;
+    };
+    itlib::data_mutex<pair, itlib::seqlock<>> data(pair{0, 0});
+
+    const uint64_t num_writes = 5000;
+    std::atomic<bool> done(false);
+    std::atomic<int> torn(0);
+
+    auto reader = [&]() {
+        uint64_t last = 0;
+        while (!done) {
+            auto p = data.read_optimistic();
+            if (p.a != p.b || p.a < last) ++torn;
+            last = p.a;
+        }
+    };
+    std::thread reader_a(reader);
+    std::thread reader_b(reader);
+
+    auto writer = [&]() {
+        for (uint64_t i = 0; i < num_writes; ++i) {
+            auto l = data.unique_lock();
+            ++l->a;
+            ++l->b;
+        }
+    };
+    std::thread writer_a(writer);
+    std::thread writer_b(writer);
+
+    writer_a.join();
+    writer_b.join();
+    done = true;
+    reader_a.join();
+    reader_b.join();
+
+    CHECK(torn == 0);
+    auto p = data.read_optimistic();
+    CHECK(p.a == 2 * num_writes);
+    CHECK(p.b == 2 * num_writes);
+}
@@ -4,12 +4,18 @@
 #include <itlib/data_mutex.hpp>
 
 #include <itlib/qalgorithm.hpp>
+#include <itlib/flat_hash_map.hpp>
+#include <itlib/mutex.hpp>
 
 #include <vector>
 #include <shared_mutex>
 #include <cstdlib>
 #include <random>
 #include <thread>
+#include <string>
+#include <string_view>
+#include <atomic>
+#include <unordered_map>
 
 #include <doctest/doctest.h>
 
@@ -55,3 +61,178 @@ TEST_CASE("data_mutex std::mutex") {
     REQUIRE(l);
     CHECK(itlib::qnone_of(*l));
 }
+
+TEST_CASE("data_mutex instrumented") {
+    itlib::data_mutex<std::vector<int>, itlib::instrumented_mutex<std::shared_mutex>> dm;
+    dm.unique_lock()->push_back(5);
+    {
+        auto a = dm.shared_lock();
+        auto b = dm.try_shared_lock();
+        CHECK(b);
+        CHECK_FALSE(dm.try_unique_lock());
+    }
+    CHECK(dm.shared_lock()->size() == 1);
+
+    auto s = dm.mutex().stats();
+    CHECK(s.acquisitions == 1);
+    CHECK(s.shared_acquisitions == 3);
+    CHECK(s.failed_try_locks == 1);
+    CHECK(s.contended == 0);
+
+    itlib::sharded_map<std::unordered_map<int, int>, itlib::instrumented_mutex<std::shared_mutex>> map(4);
+    for (int i = 0; i < 100; ++i) {
+        map.try_emplace(i, i);
+    }
+    uint64_t total = 0;
+    for (size_t i = 0; i < map.num_shards(); ++i) {
+        total += map.shard(i).mutex().stats().acquisitions;
+    }
+    CHECK(total == 100);
+}
+
+TEST_CASE("sharded_map") {
+    using map_t = itlib::sharded_map<std::unordered_map<int, std::string>, std::shared_mutex>;
+
+    map_t map(5);
+    CHECK(map.num_shards() == 8);
+    CHECK(map.empty());
+    CHECK(map.size() == 0);
+    CHECK(reinterpret_cast<uintptr_t>(&map.shard(1)) - reinterpret_cast<uintptr_t>(&map.shard(0)) >= map_t::cache_line_size);
+    CHECK(reinterpret_cast<uintptr_t>(&map.shard(0)) % map_t::cache_line_size == 0);
+
+    CHECK(map.try_emplace(1, "one"));
+    CHECK_FALSE(map.try_emplace(1, "xxx"));
+    CHECK(map.insert_or_assign(2, "two"));
+    CHECK_FALSE(map.insert_or_assign(2, "TWO"));
+    CHECK(map.size() == 2);
+    CHECK(map.contains(1));
+    CHECK_FALSE(map.contains(3));
+    CHECK(map.get(1) == "one");
+    CHECK(map.get(2) == "TWO");
+    CHECK_FALSE(map.get(3));
+
+    CHECK(map.modify(1, [](std::string& s) { s += "!"; }));
+    CHECK_FALSE(map.modify(3, [](std::string&) {}));
+    std::string seen;
+    CHECK(map.visit(1, [&](const std::string& s) { seen = s; }));
+    CHECK(seen == "one!");
+
+    CHECK(map.shard_for(2).shared_lock()->count(2) == 1);
+    CHECK(&map.shard_for(2) == &map.shard(map.shard_index(2)));
+
+    std::vector<std::pair<int, std::string>> items;
+    for (int i = 0; i < 100; ++i) {
+        items.emplace_back(i, std::to_string(i));
+    }
+    items.emplace_back(50, "dup");
+    CHECK(map.insert_many(items) == 98); // 1, 2 and the duplicate 50 are not inserted
+    CHECK(map.size() == 100);
+    CHECK(map.get(50) == "50");
+    CHECK(map.get(1) == "one!");
+
+    std::vector<int> keys = {5, 500, 1, 99, 5};
+    auto found = map.find_many(keys);
+    REQUIRE(found.size() == 5);
+    CHECK(found[0] == "5");
+    CHECK_FALSE(found[1]);
+    CHECK(found[2] == "one!");
+    CHECK(found[3] == "99");
+    CHECK(found[4] == "5");
+
+    size_t sum = 0;
+    map.for_each([&](int k, const std::string&) { sum += size_t(k); });
+    CHECK(sum == 99 * 100 / 2);
+
+    CHECK(map.erase(5) == 1);
+    CHECK(map.erase(5) == 0);
+    CHECK(map.size() == 99);
+
+    // the shards are used
+    size_t nonempty = 0;
+    for (size_t i = 0; i < map.num_shards(); ++i) {
+        nonempty += !map.shard(i).shared_lock()->empty();
+    }
+    CHECK(nonempty == map.num_shards());
+
+    map.clear();
+    CHECK(map.empty());
+
+    itlib::sharded_map<std::unordered_map<int, int>, std::shared_mutex> single(1);
+    CHECK(single.num_shards() == 1);
+    single.try_emplace(3, 4);
+    CHECK(single.get(3) == 4);
+}
+
+struct string_hash {
+    using is_transparent = void;
+    size_t operator()(std::string_view str) const { return std::hash<std::string_view>{}(str); }
+};
+
+TEST_CASE("sharded_map transparent") {
+    using map_t = itlib::flat_hash_map<std::string, std::unique_ptr<int>, string_hash, std::equal_to<>>;
+    itlib::sharded_map<map_t, std::shared_mutex> map;
+    CHECK(map.num_shards() >= 8);
+
+    std::string_view a = "a";
+    CHECK(map.try_emplace(a, std::make_unique<int>(1)));
+    CHECK(map.contains("a"));
+    CHECK(map.visit(std::string_view("a"), [](const std::unique_ptr<int>& p) { CHECK(*p == 1); }));
+
+    // move-only values
+    std::vector<std::pair<std::string, std::unique_ptr<int>>> items;
+    items.emplace_back("b", std::make_unique<int>(2));
+    items.emplace_back("c", std::make_unique<int>(3));
+    CHECK(map.insert_many(std::make_move_iterator(items.begin()), std::make_move_iterator(items.end())) == 2);
+    CHECK(!items[0].second);
+
+    std::vector<std::string_view> keys = {"c", "x", "a"};
+    int sum = 0;
+    map.find_many(keys, [&](size_t i, const std::unique_ptr<int>* p) {
+        CHECK((i == 1) == !p);
+        if (p) sum += **p;
+    });
+    CHECK(sum == 4);
+    CHECK(map.erase(std::string_view("b")) == 1);
+}
+
+TEST_CASE("sharded_map threads") {
+    itlib::sharded_map<std::unordered_map<int, int>, std::shared_mutex> map(4);
+
+    constexpr int per_thread = 1000;
+    auto writer = [&](int t) {
+        std::vector<std::pair<int, int>> batch;
+        for (int i = 0; i < per_thread; ++i) {
+            const int k = t * per_thread + i;
+            if (i % 2) map.try_emplace(k, k);
+            else batch.emplace_back(k, k);
+        }
+        map.insert_many(batch);
+        for (int i = 0; i < per_thread; i += 10) {
+            map.modify(t * per_thread + i, [](int& v) { v = -v; });
+        }
+    };
+    std::atomic_int bad_reads = {0};
+    auto reader = [&] {
+        std::vector<int> keys;
+        for (int i = 0; i < 4 * per_thread; i += 7) keys.push_back(i);
+        for (int n = 0; n < 20; ++n) {
+            map.find_many(keys, [&](size_t i, const int* v) {
+                if (v && *v != keys[i] && *v != -keys[i]) ++bad_reads;
+            });
+            if (map.size() > size_t(4 * per_thread)) ++bad_reads;
+            std::this_thread::yield();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) threads.emplace_back(writer, t);
+    threads.emplace_back(reader);
+    threads.emplace_back(reader);
+    for (auto& t : threads) t.join();
+
+    CHECK(bad_reads == 0);
+    CHECK(map.size() == 4 * per_thread);
+    for (int k = 0; k < 4 * per_thread; ++k) {
+        CHECK(map.get(k) == (k % per_thread % 10 == 0 ? -k : k));
+    }
+}
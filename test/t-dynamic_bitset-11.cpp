@@ -4,6 +4,13 @@
 #include <doctest/doctest.h>
 
 #include <itlib/dynamic_bitset.hpp>
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 using vec32 = std::vector<uint32_t>;
 using db32 = itlib::dynamic_bitset<vec32>;
 
@@ -417,3 +424,229 @@ TEST_CASE("copy")
         CHECK(buf[3] == ia[3]);
     }
 }
+
+template <typename DB>
+void check_bulk_ops()
+{
+    std::minstd_rand rng(42);
+    for (size_t size : {0, 1, 7, 8, 31, 32, 33, 64, 100, 257, 1000})
+    {
+        DB a(size), b(size);
+        std::vector<bool> ra(size), rb(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            if (rng() % 3 == 0) { a.set(i); ra[i] = true; }
+            if (rng() % 5 == 0) { b.set(i); rb[i] = true; }
+        }
+
+        CHECK(a.count() == size_t(std::count(ra.begin(), ra.end(), true)));
+
+        std::vector<size_t> found, rfound;
+        for (auto i = a.find_first(); i != DB::npos; i = a.find_next(i)) found.push_back(i);
+        for (size_t i = 0; i < size; ++i) if (ra[i]) rfound.push_back(i);
+        CHECK(found == rfound);
+
+        auto check = [&](const DB& x, const std::vector<bool>& r) {
+            for (size_t i = 0; i < size; ++i) if (x.test(i) != r[i]) return false;
+            return x.count() == size_t(std::count(r.begin(), r.end(), true));
+        };
+
+        auto c = a; auto rc = ra;
+        c &= b;
+        for (size_t i = 0; i < size; ++i) rc[i] = ra[i] && rb[i];
+        CHECK(check(c, rc));
+
+        c = a; c |= b;
+        for (size_t i = 0; i < size; ++i) rc[i] = ra[i] || rb[i];
+        CHECK(check(c, rc));
+
+        c = a; c ^= b;
+        for (size_t i = 0; i < size; ++i) rc[i] = ra[i] != rb[i];
+        CHECK(check(c, rc));
+
+        c = a; c.andnot(b);
+        for (size_t i = 0; i < size; ++i) rc[i] = ra[i] && !rb[i];
+        CHECK(check(c, rc));
+
+        for (int r = 0; r < 20 && size; ++r)
+        {
+            size_t from = rng() % size, to = rng() % (size + 1);
+            if (from > to) std::swap(from, to);
+            c = a; rc = ra;
+            c.set_range(from, to);
+            for (size_t i = from; i < to; ++i) rc[i] = true;
+            CHECK(check(c, rc));
+            c.reset_range(from, to);
+            for (size_t i = from; i < to; ++i) rc[i] = false;
+            CHECK(check(c, rc));
+        }
+    }
+}
+
+TEST_CASE("bulk ops")
+{
+    check_bulk_ops<itlib::dynamic_bitset<std::vector<uint8_t>>>();
+    check_bulk_ops<db32>();
+    check_bulk_ops<itlib::dynamic_bitset<std::vector<uint64_t>>>();
+
+    // trailing bits of the last word are ignored
+    db32 a(40, 0xFFFFFFFF);
+    CHECK(a.count() == 40);
+    CHECK(a.all());
+    a.reset_range(0, 39);
+    CHECK(a.find_first() == 39);
+    CHECK(a.find_next(39) == db32::npos);
+    a.resize(39);
+    CHECK(a.count() == 0);
+    CHECK(a.find_first() == db32::npos);
+
+    itlib::dynamic_bitset<std::vector<uint8_t>> b(20, 0xFF);
+    CHECK(b.all());
+    b.reset(3);
+    CHECK(!b.all());
+}
+
+template <typename DB>
+void check_build_and_shift()
+{
+    using word = typename DB::word_type;
+    std::minstd_rand rng(7);
+
+    DB a;
+    std::vector<bool> ra;
+    for (int i = 0; i < 300; ++i)
+    {
+        bool b = rng() % 2;
+        a.push_back(b);
+        ra.push_back(b);
+    }
+
+    // stale tail bits after shrinking must not leak into push_back and append
+    a.resize(250);
+    ra.resize(250);
+    a.push_back(false);
+    ra.push_back(false);
+
+    for (size_t bits : {1, 5, 8, 13, 32, 64, 65, 130})
+    {
+        std::vector<word> words(DB::word_size(bits));
+        for (auto& w : words) w = word(rng()) | word(rng() << 5);
+        a.append(words.data(), bits);
+        for (size_t i = 0; i < bits; ++i)
+        {
+            ra.push_back(words[i / DB::bits_per_word] & (word(1) << (i % DB::bits_per_word)));
+        }
+    }
+
+    auto check = [](const DB& x, const std::vector<bool>& r) {
+        if (x.size() != r.size()) return false;
+        for (size_t i = 0; i < r.size(); ++i) if (x.test(i) != r[i]) return false;
+        return x.count() == size_t(std::count(r.begin(), r.end(), true));
+    };
+    CHECK(check(a, ra));
+
+    auto self = a;
+    auto rself = ra;
+    self.append(self);
+    rself.insert(rself.end(), ra.begin(), ra.end());
+    CHECK(check(self, rself));
+
+    for (size_t n : {0, 1, 3, 8, 31, 32, 33, 64, 100, 300, 600, 2000})
+    {
+        auto l = a;
+        l.shift_left(n);
+        std::vector<bool> rl(ra.size());
+        for (size_t i = n; i < ra.size(); ++i) rl[i] = ra[i - n];
+        CHECK(check(l, rl));
+
+        auto r = a;
+        r.shift_right(n);
+        std::vector<bool> rr(ra.size());
+        for (size_t i = 0; i + n < ra.size(); ++i) rr[i] = ra[i + n];
+        CHECK(check(r, rr));
+    }
+}
+
+TEST_CASE("build and shift")
+{
+    check_build_and_shift<itlib::dynamic_bitset<std::vector<uint8_t>>>();
+    check_build_and_shift<db32>();
+    check_build_and_shift<itlib::dynamic_bitset<std::vector<uint64_t>>>();
+
+    // shifting in stale bits
+    db32 a(20, 0xFFFFFFFF);
+    a.shift_right(4);
+    CHECK(a.count() == 16);
+    CHECK(!a.test(19));
+}
+
+TEST_CASE("atomic_dynamic_bitset")
+{
+    using adb = itlib::atomic_dynamic_bitset<>;
+    adb a(200);
+    CHECK(a.size() == 200);
+    CHECK(a.word_size() == 4);
+    CHECK(a.none());
+    CHECK(a.count() == 0);
+    CHECK(a.find_first() == adb::npos);
+
+    a.set(3);
+    a.set(150, std::memory_order_relaxed);
+    CHECK(a.test(3));
+    CHECK(a.test(150, std::memory_order_acquire));
+    CHECK(!a.test(4));
+    CHECK(a.any());
+    CHECK(a.count() == 2);
+    CHECK(a.find_first() == 3);
+    CHECK(a.find_next(3) == 150);
+    CHECK(a.find_next(150) == adb::npos);
+
+    CHECK(a.test_and_set(3));
+    CHECK(!a.test_and_set(4, std::memory_order_acq_rel));
+    CHECK(a.test(4));
+    CHECK(a.test_and_reset(4, std::memory_order_release));
+    CHECK(!a.test_and_reset(4));
+    CHECK(!a.flip(199));
+    CHECK(a.flip(199));
+    CHECK(!a.test(199));
+    a.reset(3);
+    CHECK(a.count() == 1);
+
+    adb b = std::move(a);
+    CHECK(b.size() == 200);
+    CHECK(b.test(150));
+    CHECK(a.size() == 0);
+    b.reset_all();
+    CHECK(b.none());
+
+    itlib::atomic_dynamic_bitset<uint8_t> c(20);
+    c.set(19);
+    CHECK(c.find_first() == 19);
+    CHECK(c.count() == 1);
+}
+
+TEST_CASE("atomic_dynamic_bitset threads")
+{
+    // every bit must be claimed exactly once
+    static const size_t n = 10000;
+    itlib::atomic_dynamic_bitset<uint32_t> visited(n);
+    std::atomic<size_t> claimed(0);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            size_t mine = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                const size_t bit = t % 2 ? i : n - i - 1;
+                if (!visited.test_and_set(bit, std::memory_order_acq_rel)) ++mine;
+            }
+            claimed += mine;
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    CHECK(claimed == n);
+    CHECK(visited.count() == n);
+}
@@ -0,0 +1,454 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include <itlib/flat_hash_map.hpp>
+#include <doctest/doctest.h>
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <unordered_map>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+TEST_CASE("[flat_hash_map] basic") {
+    itlib::flat_hash_map<int, std::string> map;
+    CHECK(map.empty());
+    CHECK(map.size() == 0);
+    CHECK(map.begin() == map.end());
+    CHECK(map.find(5) == map.end());
+    CHECK(map.count(5) == 0);
+    CHECK_FALSE(map.contains(5));
+    CHECK(map.erase(5) == 0);
+    CHECK_THROWS_AS(map.at(5), std::out_of_range);
+
+    map[5] = "five";
+    CHECK(map.size() == 1);
+    CHECK(map.begin()->first == 5);
+    CHECK(map.at(5) == "five");
+    CHECK(map.contains(5));
+
+    auto r = map.insert({3, "three"});
+    CHECK(r.second);
+    CHECK(r.first->second == "three");
+    r = map.insert({3, "xxx"});
+    CHECK_FALSE(r.second);
+    CHECK(r.first->second == "three");
+
+    r = map.emplace(7, "seven");
+    CHECK(r.second);
+    r = map.emplace(std::make_pair(8, "eight"));
+    CHECK(r.second);
+    CHECK(map[8] == "eight");
+    r = map.emplace(std::piecewise_construct, std::forward_as_tuple(9), std::forward_as_tuple(3, 'n'));
+    CHECK(r.second);
+    CHECK(map[9] == "nnn");
+    r = map.emplace(9, "x");
+    CHECK_FALSE(r.second);
+    CHECK(map[9] == "nnn");
+
+    r = map.try_emplace(1, 2, 'o');
+    CHECK(r.second);
+    CHECK(r.first->second == "oo");
+    r = map.try_emplace(1, "no");
+    CHECK_FALSE(r.second);
+
+    r = map.insert_or_assign(1, "one");
+    CHECK_FALSE(r.second);
+    CHECK(map.at(1) == "one");
+    r = map.insert_or_assign(2, "two");
+    CHECK(r.second);
+    CHECK(map.at(2) == "two");
+
+    CHECK(map.size() == 7);
+
+    const auto& cmap = map;
+    auto ci = cmap.find(7);
+    CHECK(ci->second == "seven");
+    CHECK(ci == map.find(7));
+    CHECK(cmap.at(7) == "seven");
+    CHECK_THROWS_AS(cmap.at(17), std::out_of_range);
+    auto er = cmap.equal_range(7);
+    CHECK(er.first == ci);
+    CHECK(std::distance(er.first, er.second) == 1);
+    er = cmap.equal_range(17);
+    CHECK(er.first == cmap.end());
+    CHECK(er.second == cmap.end());
+
+    std::vector<int> keys;
+    for (auto& e : map) {
+        keys.push_back(e.first);
+    }
+    std::sort(keys.begin(), keys.end());
+    CHECK(keys == std::vector<int>{1, 2, 3, 5, 7, 8, 9});
+
+    CHECK(map.erase(3) == 1);
+    CHECK(map.erase(3) == 0);
+    auto it = map.erase(map.find(5));
+    CHECK(map.size() == 5);
+    CHECK(map.find(5) == map.end());
+    int count = 0;
+    for (; it != map.end(); ++it) ++count;
+    CHECK(count <= 5);
+
+    map.erase(map.begin(), map.end());
+    CHECK(map.empty());
+    CHECK(map.begin() == map.end());
+
+    map = {{1, "a"}, {2, "b"}, {1, "c"}};
+    CHECK(map.size() == 2);
+    CHECK(map[1] == "a");
+
+    map.clear();
+    CHECK(map.empty());
+    CHECK(map.capacity() > 0);
+    map.rehash(0);
+    CHECK(map.capacity() == 0);
+}
+
+TEST_CASE("[flat_hash_map] copy move swap") {
+    using map_t = itlib::flat_hash_map<std::string, int>;
+    map_t a = {{"one", 1}, {"two", 2}, {"three", 3}};
+    map_t b = a;
+    CHECK(a == b);
+    CHECK(b.at("two") == 2);
+
+    b["four"] = 4;
+    CHECK(a != b);
+
+    map_t c = std::move(b);
+    CHECK(b.empty());
+    CHECK(b.begin() == b.end());
+    CHECK(c.size() == 4);
+    b["x"] = 10; // moved-from is usable
+    CHECK(b.size() == 1);
+
+    a = c;
+    CHECK(a == c);
+    a = std::move(b);
+    CHECK(a.size() == 1);
+    CHECK(a.at("x") == 10);
+
+    a.swap(c);
+    CHECK(a.size() == 4);
+    CHECK(c.size() == 1);
+
+    itlib::flat_hash_map<int, std::unique_ptr<int>> u;
+    for (int i = 0; i < 100; ++i) {
+        u.emplace(i, std::make_unique<int>(i));
+    }
+    auto u2 = std::move(u);
+    CHECK(u2.size() == 100);
+    CHECK(*u2[42] == 42);
+}
+
+TEST_CASE("[flat_hash_map] growth and erase") {
+    itlib::flat_hash_map<int, int> map;
+    std::unordered_map<int, int> ref;
+
+    std::minstd_rand rng(42);
+    for (int i = 0; i < 20000; ++i) {
+        const int k = int(rng() % 3000);
+        if (rng() % 3 == 0) {
+            CHECK(map.erase(k) == ref.erase(k));
+        }
+        else {
+            auto a = map.emplace(k, i);
+            auto b = ref.emplace(k, i);
+            CHECK(a.second == b.second);
+            CHECK(a.first->second == b.first->second);
+        }
+    }
+
+    CHECK(map.size() == ref.size());
+    CHECK(map.load_factor() <= map.max_load_factor());
+    for (auto& e : ref) {
+        CHECK(map.at(e.first) == e.second);
+    }
+    size_t n = 0;
+    for (auto& e : map) {
+        CHECK(ref.at(e.first) == e.second);
+        ++n;
+    }
+    CHECK(n == ref.size());
+
+    // erase while iterating
+    for (auto i = map.begin(); i != map.end(); ) {
+        if (i->first % 2) i = map.erase(i);
+        else ++i;
+    }
+    for (auto& e : ref) {
+        CHECK(map.contains(e.first) == (e.first % 2 == 0));
+    }
+
+    map.reserve(10000);
+    const auto cap = map.capacity();
+    for (int i = 0; i < 10000; ++i) {
+        map[i] = i;
+    }
+    CHECK(map.capacity() == cap);
+    CHECK(map.size() == 10000);
+
+    map.rehash(0);
+    CHECK(map.capacity() < cap * 2);
+    CHECK(map.size() == 10000);
+    CHECK(map[9999] == 9999);
+
+    // keys are moved on growth
+    itlib::flat_hash_map<std::string, std::string> smap;
+    for (int i = 0; i < 1000; ++i) {
+        smap[std::string(40, 'k') + std::to_string(i)] = std::string(40, 'v') + std::to_string(i);
+    }
+    CHECK(smap.size() == 1000);
+    for (int i = 0; i < 1000; ++i) {
+        CHECK(smap.at(std::string(40, 'k') + std::to_string(i)) == std::string(40, 'v') + std::to_string(i));
+    }
+}
+
+struct bad_hash {
+    size_t operator()(int i) const { return size_t(i % 3); }
+};
+
+TEST_CASE("[flat_hash_map] collisions") {
+    // the same hash means the same probe sequence and the same control byte
+    itlib::flat_hash_map<int, int, bad_hash> map;
+    for (int i = 0; i < 300; ++i) {
+        map[i] = i * 2;
+    }
+    CHECK(map.size() == 300);
+    for (int i = 0; i < 300; i += 2) {
+        CHECK(map.erase(i) == 1);
+    }
+    for (int i = 0; i < 300; ++i) {
+        CHECK(map.count(i) == size_t(i % 2));
+    }
+    for (int i = 0; i < 300; i += 2) {
+        map[i] = 1;
+    }
+    CHECK(map.size() == 300);
+    CHECK(map.at(299) == 598);
+}
+
+struct string_hash {
+    using is_transparent = void;
+    size_t operator()(std::string_view str) const { return std::hash<std::string_view>{}(str); }
+};
+
+TEST_CASE("[flat_hash_map] transparent") {
+    itlib::flat_hash_map<std::string, int, string_hash, std::equal_to<>> map;
+
+    std::string_view one = "one";
+    map.try_emplace(one, 1);
+    map[std::string_view("two")] = 2;
+    map["three"] = 3;
+    map.insert_or_assign(std::string_view("four"), 4);
+    map.insert_or_assign(std::string_view("four"), 44);
+
+    CHECK(map.size() == 4);
+    CHECK(map.find(one)->second == 1);
+    CHECK(map.find("two")->second == 2);
+    CHECK(map.at(std::string_view("three")) == 3);
+    CHECK(map.at("four") == 44);
+    CHECK(map.count(std::string_view("five")) == 0);
+    CHECK(map.contains(std::string_view("one")));
+    CHECK_THROWS_AS(map.at(std::string_view("five")), std::out_of_range);
+
+    const auto& cmap = map;
+    CHECK(cmap.find(std::string_view("two"))->second == 2);
+    CHECK(cmap.at(std::string_view("two")) == 2);
+
+    auto hint = map.try_emplace(map.end(), std::string_view("five"), 5);
+    CHECK(hint->second == 5);
+
+    CHECK(map.erase(std::string_view("one")) == 1);
+    CHECK(map.erase(std::string_view("one")) == 0);
+    CHECK(map.size() == 4);
+}
+
+struct throwing_key {
+    static inline int copies_left = 1000;
+
+    int value;
+
+    throwing_key(int v) : value(v) {}
+    throwing_key(const throwing_key& other) : value(other.value) {
+        if (--copies_left < 0) throw std::runtime_error("copy");
+    }
+    bool operator==(const throwing_key& other) const { return value == other.value; }
+};
+
+struct throwing_key_hash {
+    size_t operator()(const throwing_key& k) const { return size_t(k.value); }
+};
+
+TEST_CASE("[flat_hash_map] rehash exception safety") {
+    itlib::flat_hash_map<throwing_key, std::unique_ptr<int>, throwing_key_hash> map;
+    for (int i = 0; i < 10; ++i) {
+        map.emplace(std::piecewise_construct, std::forward_as_tuple(i), std::forward_as_tuple(new int(i)));
+    }
+    const auto cap = map.capacity();
+
+    throwing_key::copies_left = 5;
+    CHECK_THROWS_AS(map.reserve(1000), std::runtime_error);
+    throwing_key::copies_left = 1000;
+
+    // values which were moved to the new table before the throw are back
+    CHECK(map.capacity() == cap);
+    CHECK(map.size() == 10);
+    for (int i = 0; i < 10; ++i) {
+        auto& v = map.at(throwing_key(i));
+        REQUIRE(v);
+        CHECK(*v == i);
+    }
+
+    map.reserve(1000);
+    CHECK(map.size() == 10);
+    CHECK(*map.at(throwing_key(7)) == 7);
+}
+
+struct throwing_value {
+    static inline int copies_left = 1000;
+
+    int value;
+
+    throwing_value(int v) : value(v) {}
+    throwing_value(const throwing_value& other) : value(other.value) {
+        if (--copies_left < 0) throw std::runtime_error("copy");
+    }
+};
+
+struct throwing_hash {
+    static inline int calls_left = 1000;
+
+    size_t operator()(const std::string& s) const {
+        if (--calls_left < 0) throw std::runtime_error("hash");
+        return std::hash<std::string>{}(s);
+    }
+};
+
+static std::string long_key(int i) {
+    return std::string(40, 'k') + std::to_string(i);
+}
+
+TEST_CASE("[flat_hash_map] rehash exception safety with movable keys") {
+    // the keys can be moved, but the values can't, so neither is moved
+    itlib::flat_hash_map<std::string, throwing_value> map;
+    for (int i = 0; i < 13; ++i) {
+        map.emplace(long_key(i), i);
+    }
+    const auto cap = map.capacity();
+
+    throwing_value::copies_left = 3;
+    CHECK_THROWS_AS(map.reserve(1000), std::runtime_error);
+    throwing_value::copies_left = 1000;
+
+    CHECK(map.capacity() == cap);
+    CHECK(map.size() == 13);
+    for (int i = 0; i < 13; ++i) {
+        CHECK(map.at(long_key(i)).value == i);
+    }
+
+    // a throwing hasher
+    itlib::flat_hash_map<std::string, std::string, throwing_hash> smap;
+    for (int i = 0; i < 13; ++i) {
+        smap.emplace(long_key(i), std::to_string(i));
+    }
+    const auto scap = smap.capacity();
+
+    throwing_hash::calls_left = 5;
+    CHECK_THROWS_AS(smap.reserve(1000), std::runtime_error);
+    throwing_hash::calls_left = 1000;
+
+    CHECK(smap.capacity() == scap);
+    CHECK(smap.size() == 13);
+    for (int i = 0; i < 13; ++i) {
+        CHECK(smap.at(long_key(i)) == std::to_string(i));
+    }
+
+    smap.reserve(1000);
+    CHECK(smap.size() == 13);
+    CHECK(smap.at(long_key(12)) == "12");
+
+    // a throwing hasher and move-only values, which are moved back
+    itlib::flat_hash_map<std::string, std::unique_ptr<int>, throwing_hash> umap;
+    for (int i = 0; i < 13; ++i) {
+        umap.emplace(long_key(i), std::make_unique<int>(i));
+    }
+    const auto ucap = umap.capacity();
+
+    throwing_hash::calls_left = 5;
+    CHECK_THROWS_AS(umap.reserve(1000), std::runtime_error);
+    throwing_hash::calls_left = 1000;
+
+    CHECK(umap.capacity() == ucap);
+    CHECK(umap.size() == 13);
+    for (int i = 0; i < 13; ++i) {
+        auto& v = umap.at(long_key(i));
+        REQUIRE(v);
+        CHECK(*v == i);
+    }
+}
+
+struct move_only_key {
+    int value;
+
+    move_only_key(int v) : value(v) {}
+    move_only_key(move_only_key&& other) noexcept : value(other.value) { other.value = -1; }
+    move_only_key(const move_only_key&) = delete;
+    bool operator==(const move_only_key& other) const { return value == other.value; }
+};
+
+struct move_only_key_hash {
+    static inline int calls_left = 1000;
+
+    size_t operator()(const move_only_key& k) const {
+        if (--calls_left < 0) throw std::runtime_error("hash");
+        return size_t(k.value);
+    }
+};
+
+struct nothrow_move_value {
+    static inline int copies_left = 1000;
+
+    int value;
+
+    nothrow_move_value(int v) : value(v) {}
+    nothrow_move_value(const nothrow_move_value& other) : value(other.value) {
+        if (--copies_left < 0) throw std::runtime_error("copy");
+    }
+    nothrow_move_value(nothrow_move_value&& other) noexcept = default;
+};
+
+TEST_CASE("[flat_hash_map] rehash exception safety with move-only keys") {
+    // the key is moved, so the value is moved too and not copied
+    itlib::flat_hash_map<move_only_key, nothrow_move_value, move_only_key_hash> map;
+    for (int i = 0; i < 13; ++i) {
+        map.try_emplace(i, i);
+    }
+    const auto cap = map.capacity();
+
+    nothrow_move_value::copies_left = 0;
+    map.reserve(100);
+    nothrow_move_value::copies_left = 1000;
+
+    CHECK(map.capacity() > cap);
+    CHECK(map.size() == 13);
+    for (int i = 0; i < 13; ++i) {
+        CHECK(map.at(i).value == i);
+    }
+    CHECK(map.find(-1) == map.end());
+
+    // both are moved back if the hasher throws
+    const auto cap2 = map.capacity();
+    move_only_key_hash::calls_left = 5;
+    CHECK_THROWS_AS(map.reserve(1000), std::runtime_error);
+    move_only_key_hash::calls_left = 1000;
+
+    CHECK(map.capacity() == cap2);
+    CHECK(map.size() == 13);
+    for (int i = 0; i < 13; ++i) {
+        CHECK(map.at(i).value == i);
+    }
+    CHECK(map.find(-1) == map.end());
+}
@@ -5,6 +5,8 @@
 
 #include <itlib/flat_map.hpp>
 
+#include <string>
+
 // struct with no operator==
 struct int_wrap
 {
@@ -415,3 +417,249 @@ TEST_CASE("flat_map_ready_tag")
     // Check that the container is unchanged
     CHECK(fm_ready_iter.container() == broken_data);
 }
+
+template <typename Map>
+void test_lookup_policy()
+{
+    static_assert(sizeof(Map) >= sizeof(std::vector<std::pair<int, int>>), "");
+
+    for (int size = 0; size < 150; size += 7)
+    {
+        Map map;
+        itlib::flat_map<int, int> ref;
+        for (int i = 0; i < size; ++i)
+        {
+            map[i * 3] = i;
+            ref[i * 3] = i;
+        }
+
+        for (int build = 0; build < 2; ++build)
+        {
+            for (int k = -2; k < size * 3 + 2; ++k)
+            {
+                CHECK(map.lower_bound(k) - map.begin() == ref.lower_bound(k) - ref.begin());
+                CHECK(map.count(k) == ref.count(k));
+            }
+            map.build_lookup_index();
+        }
+
+        // modifications invalidate
+        map.erase(0);
+        map[1] = 100;
+        map.insert(std::make_pair(size * 3 + 5, 5));
+        CHECK(map.find(0) == map.end());
+        CHECK(map.at(1) == 100);
+        CHECK(map.find(size * 3 + 5) == map.end() - 1);
+        map.build_lookup_index();
+        CHECK(map.find(0) == map.end());
+        CHECK(map.find(1) == map.begin());
+        CHECK(map.find(size * 3 + 5) == map.end() - 1);
+
+        const auto& cmap = map;
+        for (auto& elem : map)
+        {
+            CHECK(cmap.find(elem.first)->second == elem.second);
+        }
+
+        map.modify_container().clear();
+        CHECK(map.find(1) == map.end());
+        map.build_lookup_index();
+        CHECK(map.find(1) == map.end());
+    }
+}
+
+TEST_CASE("[flat_map] lookup policies")
+{
+    using namespace itlib;
+
+    using bmap = flat_map<int, int, fmimpl::less, std::vector<std::pair<int, int>>, flat_map_branchless_lookup>;
+    static_assert(sizeof(bmap) == sizeof(std::vector<std::pair<int, int>>), "empty base optimization must work");
+    test_lookup_policy<bmap>();
+
+    using emap = flat_map<int, int, fmimpl::less, std::vector<std::pair<int, int>>, flat_map_eytzinger_lookup>;
+    test_lookup_policy<emap>();
+
+    // custom comparator and swap
+    using emap2 = flat_map<int_wrap, int, int_wrap::compare, std::vector<std::pair<int_wrap, int>>, flat_map_eytzinger_lookup>;
+    emap2 a = {{1, 1}, {3, 3}, {2, 2}};
+    a.build_lookup_index();
+    emap2 b = {{5, 5}};
+    CHECK(a.find(2)->second == 2);
+    a.swap(b);
+    CHECK(a.find(2) == a.end());
+    CHECK(a.find(5)->second == 5);
+    CHECK(b.find(3)->second == 3);
+    CHECK(b.find(4) == b.end());
+
+    emap2 c = b;
+    CHECK(c.find(1)->second == 1);
+    emap2 d = std::move(c);
+    CHECK(d.find(1)->second == 1);
+}
+
+TEST_CASE("[flat_map] insert_bulk")
+{
+    using namespace itlib;
+    using imap = flat_map<int, int>;
+
+    imap map;
+    std::vector<std::pair<int, int>> vals = {{5, 1}, {3, 1}, {5, 2}, {1, 1}, {3, 2}};
+    map.insert_bulk(vals.begin(), vals.end());
+    // first one wins
+    CHECK(map.container() == imap::container_type{{1, 1}, {3, 1}, {5, 1}});
+
+    vals = {{4, 3}, {5, 3}, {0, 3}, {4, 4}, {7, 3}};
+    map.insert_bulk(vals.begin(), vals.end());
+    // existing keys are not overwritten
+    CHECK(map.container() == imap::container_type{{0, 3}, {1, 1}, {3, 1}, {4, 3}, {5, 1}, {7, 3}});
+
+    // append
+    vals = {{9, 9}, {8, 8}};
+    map.insert_bulk(vals.begin(), vals.end());
+    CHECK(map.size() == 8);
+    CHECK(map.rbegin()->first == 9);
+
+    map.insert_bulk(vals.begin(), vals.begin());
+    CHECK(map.size() == 8);
+
+    vals = {{-1, 0}, {2, 0}, {3, 0}, {10, 0}};
+    map.insert_bulk(flat_map_ready_tag{}, vals.begin(), vals.end());
+    CHECK(map.container() == imap::container_type{{-1, 0}, {0, 3}, {1, 1}, {2, 0}, {3, 1}, {4, 3}, {5, 1}, {7, 3}, {8, 8}, {9, 9}, {10, 0}});
+
+    // large, compared to one by one
+    imap ref;
+    std::vector<std::pair<int, int>> big;
+    for (int i = 0; i < 1000; ++i)
+    {
+        int k = (i * 7919) % 1500;
+        big.emplace_back(k, i);
+        ref.insert(std::make_pair(k, i));
+    }
+    imap bmap;
+    bmap.insert_bulk(big.begin(), big.begin() + 300);
+    bmap.insert_bulk(big.begin() + 300, big.end());
+    CHECK(bmap == ref);
+
+    // eytzinger index is invalidated
+    using emap = flat_map<int, int, fmimpl::less, std::vector<std::pair<int, int>>, flat_map_eytzinger_lookup>;
+    emap e = {{1, 1}, {2, 2}};
+    e.build_lookup_index();
+    e.insert_bulk(big.begin(), big.end());
+    for (auto& elem : ref)
+    {
+        CHECK(e.find(elem.first) != e.end());
+    }
+}
+
+TEST_CASE("[flat_map] merge")
+{
+    using namespace itlib;
+    using smap = flat_map<int, std::string>;
+
+    smap a = {{1, "a1"}, {3, "a3"}, {5, "a5"}};
+    smap b = {{0, "b0"}, {3, "b3"}, {4, "b4"}, {5, "b5"}, {9, "b9"}};
+    a.merge(b);
+    CHECK(a.container() == smap::container_type{{0, "b0"}, {1, "a1"}, {3, "a3"}, {4, "b4"}, {5, "a5"}, {9, "b9"}});
+    CHECK(b.container() == smap::container_type{{3, "b3"}, {5, "b5"}});
+
+    a.merge(a);
+    CHECK(a.size() == 6);
+
+    smap c;
+    c.merge(smap{{1, "c1"}});
+    c.merge(std::move(b));
+    CHECK(c.container() == smap::container_type{{1, "c1"}, {3, "b3"}, {5, "b5"}});
+}
+
+TEST_CASE("[flat_map] string prefix lookup")
+{
+    using namespace itlib;
+    using pmap = flat_map<std::string, int, fmimpl::less, std::vector<std::pair<std::string, int>>, flat_map_string_prefix_lookup>;
+    using rmap = flat_map<std::string, int>;
+
+    std::vector<std::string> keys = {
+        "com.example.product.a",
+        "com.example.product.abcdefgh",
+        "com.example.product.abcdefghi",
+        "com.example.product.abcdefghj",
+        "com.example.product.abcdefgh\xff",
+        "com.example.product.b",
+        "com.example.product.",
+        std::string("com.example.product.\0x", 22),
+        "com.example.product.zzzzzzzzzzzzz",
+        "com.example.product.\x80\x81",
+    };
+
+    std::vector<std::string> queries = keys;
+    queries.insert(queries.end(), {
+        "", "a", "com", "com.example.product", "com.example.producu", "com.example.producs",
+        "com.example.product.abcdefg", "com.example.product.abcdefgha", "com.example.product.abcdefgz",
+        "com.example.product.c", "com.example.product.\xff", "zzz",
+        std::string("com.example.product.\0", 21),
+    });
+
+    pmap map;
+    rmap ref;
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        map.emplace(keys[i], int(i));
+        ref.emplace(keys[i], int(i));
+    }
+
+    for (int build = 0; build < 2; ++build)
+    {
+        for (auto& q : queries)
+        {
+            CHECK(map.lower_bound(q) - map.begin() == ref.lower_bound(q) - ref.begin());
+            CHECK(map.count(q) == ref.count(q));
+            CHECK(map.lower_bound(q.c_str()) - map.begin() == ref.lower_bound(q.c_str()) - ref.begin());
+        }
+        map.build_lookup_index();
+    }
+
+    CHECK(map.find("com.example.product.b")->second == 5);
+    CHECK(map.at("com.example.product.abcdefghj") == 3);
+    CHECK(map.find("com.example.product.abcdefghk") == map.end());
+
+    // modifications invalidate
+    map.erase("com.example.product.b");
+    map["x"] = 100;
+    CHECK(map.find("x")->second == 100);
+    map.build_lookup_index(); // now there's no common prefix
+    CHECK(map.find("x")->second == 100);
+    CHECK(map.find("com.example.product.a")->second == 0);
+    CHECK(map.find("com.example.product.b") == map.end());
+
+    pmap single = {{"abc", 1}};
+    single.build_lookup_index();
+    CHECK(single.find("abc") == single.begin());
+    CHECK(single.find("ab") == single.end());
+    CHECK(single.lower_bound("ab") == single.begin());
+    CHECK(single.lower_bound("abcd") == single.end());
+
+    pmap empty;
+    empty.build_lookup_index();
+    CHECK(empty.find("abc") == empty.end());
+
+    // groups of keys with common prefixes longer than all index levels
+    pmap deep;
+    rmap deepref;
+    for (int g = 0; g < 5; ++g)
+    {
+        const std::string group = "g" + std::to_string(g) + std::string(size_t(g * 9), char('a' + g));
+        for (int i = 0; i < 30; ++i)
+        {
+            const std::string key = group + std::to_string(i * 7 % 30);
+            deep.emplace(key, i);
+            deepref.emplace(key, i);
+        }
+    }
+    deep.build_lookup_index();
+    for (auto& elem : deepref)
+    {
+        for (auto& q : {elem.first, elem.first + "0", elem.first.substr(0, elem.first.size() - 1)})
+        {
+            CHECK(deep.lower_bound(q) - deep.begin() == deepref.lower_bound(q) - deepref.begin());
+        }
+    }
+}
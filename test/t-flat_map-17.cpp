@@ -26,3 +26,14 @@ TEST_CASE("[flat_map] std::string_view transparency")
     CHECK(map[std::string_view("yuiop")] == 0);
     CHECK(map.find("yuiop") != map.end());
 }
+
+TEST_CASE("[flat_map] string prefix lookup with std::string_view")
+{
+    using pmap = itlib::flat_map<std::string, int, itlib::fmimpl::less, std::vector<std::pair<std::string, int>>, itlib::flat_map_string_prefix_lookup>;
+    pmap map = {{"/usr/lib/libfoo.so", 1}, {"/usr/lib/libbar.so", 2}, {"/usr/lib/libfoo.so.1", 3}};
+    map.build_lookup_index();
+    CHECK(map.find(std::string_view("/usr/lib/libfoo.so"))->second == 1);
+    CHECK(map.find(std::string_view("/usr/lib/libfoo.so.1"))->second == 3);
+    CHECK(map.find(std::string_view("/usr/lib/libbaz.so")) == map.end());
+    CHECK(map[std::string_view("/usr/lib/libbar.so")] == 2);
+}
@@ -5,6 +5,8 @@
 
 #include <itlib/flat_set.hpp>
 
+#include <string>
+
 // struct with no operator==
 struct int_wrap
 {
@@ -372,3 +374,95 @@ TEST_CASE("flat_set_ready_tag")
     // Check that the container is unchanged
     CHECK(fs_ready_iter.container() == broken_data);
 }
+
+template <typename Set>
+void test_lookup_policy()
+{
+    for (int size = 0; size < 150; size += 7)
+    {
+        Set set;
+        itlib::flat_set<int> ref;
+        for (int i = 0; i < size; ++i)
+        {
+            set.insert(i * 3);
+            ref.insert(i * 3);
+        }
+
+        for (int build = 0; build < 2; ++build)
+        {
+            for (int k = -2; k < size * 3 + 2; ++k)
+            {
+                CHECK(set.lower_bound(k) - set.begin() == ref.lower_bound(k) - ref.begin());
+                CHECK(set.count(k) == ref.count(k));
+            }
+            set.build_lookup_index();
+        }
+
+        // modifications invalidate
+        set.erase(0);
+        set.insert(1);
+        CHECK(set.find(0) == set.end());
+        CHECK(set.find(1) == set.begin());
+        set.build_lookup_index();
+        CHECK(set.find(0) == set.end());
+        CHECK(set.find(1) == set.begin());
+
+        set.clear();
+        CHECK(set.find(1) == set.end());
+    }
+}
+
+TEST_CASE("[flat_set] lookup policies")
+{
+    using namespace itlib;
+
+    using bset = flat_set<int, fsimpl::less, std::vector<int>, flat_set_branchless_lookup>;
+    static_assert(sizeof(bset) == sizeof(std::vector<int>), "empty base optimization must work");
+    test_lookup_policy<bset>();
+
+    test_lookup_policy<flat_set<int, fsimpl::less, std::vector<int>, flat_set_eytzinger_lookup>>();
+
+    using sset = flat_set<std::string, std::less<std::string>, std::vector<std::string>, flat_set_eytzinger_lookup>;
+    sset strs = {"x", "a", "zz", "b"};
+    strs.build_lookup_index();
+    CHECK(strs.find("a") == strs.begin());
+    CHECK(strs.find("zz") == strs.end() - 1);
+    CHECK(strs.find("c") == strs.end());
+    CHECK(strs.lower_bound("c") - strs.begin() == 2);
+}
+
+TEST_CASE("[flat_set] insert_bulk and merge")
+{
+    using namespace itlib;
+    using iset = flat_set<int>;
+
+    iset set;
+    std::vector<int> vals = {5, 3, 5, 1, 3};
+    set.insert_bulk(vals.begin(), vals.end());
+    CHECK(set.container() == std::vector<int>{1, 3, 5});
+
+    vals = {4, 5, 0, 4, 7};
+    set.insert_bulk(vals.begin(), vals.end());
+    CHECK(set.container() == std::vector<int>{0, 1, 3, 4, 5, 7});
+
+    vals = {-1, 2, 3, 10};
+    set.insert_bulk(flat_set_ready_tag{}, vals.begin(), vals.end());
+    CHECK(set.container() == std::vector<int>{-1, 0, 1, 2, 3, 4, 5, 7, 10});
+
+    // custom equivalence which is not ==
+    using ciset = flat_set<int_wrap, int_wrap::compare>;
+    ciset cs;
+    std::vector<int_wrap> cvals = {3, 1, 2};
+    cs.insert_bulk(cvals.begin(), cvals.end());
+    CHECK(cs.size() == 3);
+    CHECK(cs.begin()->val == 1);
+
+    iset other = {-5, 0, 6, 10, 11};
+    set.merge(other);
+    CHECK(set.container() == std::vector<int>{-5, -1, 0, 1, 2, 3, 4, 5, 6, 7, 10, 11});
+    CHECK(other.container() == std::vector<int>{0, 10});
+
+    set.merge(iset{100});
+    CHECK(set.size() == 13);
+    CHECK(*set.rbegin() == 100);
+}
@@ -0,0 +1,177 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include <doctest/doctest.h>
+
+#include <itlib/flat_soa_map.hpp>
+#include <itlib/flat_map.hpp>
+#include <itlib/pod_vector.hpp>
+#include <itlib/small_vector.hpp>
+
+#include <string>
+#include <stdexcept>
+
+TEST_CASE("[flat_soa_map] test")
+{
+    using namespace itlib;
+
+    flat_soa_map<int, std::string> map;
+    static_assert(sizeof(map) == 2 * sizeof(std::vector<int>), "empty base optimization must work");
+    CHECK(map.empty());
+    CHECK(map.size() == 0);
+    CHECK(map.begin() == map.end());
+
+    map[5] = "five";
+    CHECK(map.size() == 1);
+    CHECK(map.begin()->first == 5);
+    CHECK(map.begin()->second == "five");
+    CHECK(map.at(5) == "five");
+    CHECK(map.count(5) == 1);
+    CHECK(map.count(3) == 0);
+    CHECK_THROWS_AS(map.at(3), std::out_of_range);
+
+    auto res = map.insert(std::make_pair(3, std::string("three")));
+    CHECK(res.second);
+    CHECK(res.first == map.begin());
+    res = map.emplace(9, "nine");
+    CHECK(res.second);
+    CHECK(res.first == map.begin() + 2);
+    res = map.emplace(3, "xxx");
+    CHECK_FALSE(res.second);
+    CHECK(res.first->second == "three");
+
+    CHECK(map.keys() == std::vector<int>{3, 5, 9});
+    CHECK(map.values() == std::vector<std::string>{"three", "five", "nine"});
+
+    // modify via iterator
+    map.find(5)->second = "FIVE";
+    CHECK(map[5] == "FIVE");
+    auto elem = *map.find(9);
+    elem.second += "!";
+    CHECK(map[9] == "nine!");
+
+    const auto& cmap = map;
+    auto ci = cmap.find(3);
+    CHECK(ci->second == "three");
+    CHECK(ci == map.begin());
+    CHECK(map.begin() == ci);
+    CHECK(cmap.find(4) == cmap.end());
+    CHECK(cmap.lower_bound(4)->first == 5);
+    CHECK(cmap.upper_bound(5)->first == 9);
+    auto er = map.equal_range(5);
+    CHECK(er.second - er.first == 1);
+    CHECK(er.first->first == 5);
+
+    // iteration
+    int sum = 0;
+    std::string cat;
+    for (auto e : map)
+    {
+        sum += e.first;
+        cat += e.second;
+    }
+    CHECK(sum == 17);
+    CHECK(cat == "threeFIVEnine!");
+
+    cat.clear();
+    for (auto i = map.rbegin(); i != map.rend(); ++i)
+    {
+        cat += (*i).second;
+    }
+    CHECK(cat == "nine!FIVEthree");
+
+    auto it = map.erase(map.begin());
+    CHECK(it->first == 5);
+    CHECK(map.erase(9) == 1);
+    CHECK(map.erase(9) == 0);
+    CHECK(map.size() == 1);
+    CHECK(map.values().front() == "FIVE");
+
+    flat_soa_map<int, std::string> map2 = {{1, "one"}};
+    map.swap(map2);
+    CHECK(map.begin()->second == "one");
+    CHECK(map2.begin()->second == "FIVE");
+
+    map.clear();
+    CHECK(map.empty());
+    CHECK(map.values().empty());
+}
+
+TEST_CASE("[flat_soa_map] initialize")
+{
+    using namespace itlib;
+    using map_t = flat_soa_map<int, int>;
+
+    map_t a = {{3, 30}, {1, 10}, {2, 20}, {1, 11}, {3, 31}};
+    CHECK(a.keys() == std::vector<int>{1, 2, 3});
+    CHECK(a.values() == std::vector<int>{10, 20, 30}); // the first one remains
+
+    map_t b({5, 4, 3, 2, 1, 4}, {50, 40, 30, 20, 10, 41});
+    CHECK(b.keys() == std::vector<int>{1, 2, 3, 4, 5});
+    CHECK(b.values() == std::vector<int>{10, 20, 30, 40, 50});
+
+    std::vector<std::pair<int, int>> pairs = {{2, 2}, {1, 1}};
+    map_t c(pairs.begin(), pairs.end());
+    CHECK(c.keys() == std::vector<int>{1, 2});
+
+    map_t d({1, 2}, {1, 2}, flat_soa_map_ready_tag{});
+    CHECK(c == d);
+    CHECK(c != b);
+
+    // mismatched sizes
+    CHECK_THROWS_AS(map_t({1, 2, 3}, {1}), std::invalid_argument);
+    CHECK_THROWS_AS(map_t({1, 2}, {1, 2, 3}, flat_soa_map_ready_tag{}), std::invalid_argument);
+
+    // larger permutation compared against flat_map
+    std::vector<int> keys, values;
+    itlib::flat_map<int, int> ref;
+    for (int i = 0; i < 500; ++i)
+    {
+        int k = (i * 7919) % 300;
+        keys.push_back(k);
+        values.push_back(i);
+        ref.emplace(k, i);
+    }
+    map_t f(keys, values);
+    CHECK(f.size() == ref.size());
+    auto ri = ref.begin();
+    for (auto elem : f)
+    {
+        CHECK(elem.first == ri->first);
+        CHECK(elem.second == ri->second);
+        ++ri;
+    }
+}
+
+struct big_value
+{
+    float data[16];
+};
+
+TEST_CASE("[flat_soa_map] other containers")
+{
+    using namespace itlib;
+
+    flat_soa_map<int, big_value, std::less<int>, pod_vector<int>, pod_vector<big_value>> pmap;
+    for (int i = 10; i > 0; --i)
+    {
+        big_value v;
+        v.data[0] = float(i);
+        pmap.insert(std::make_pair(i, v));
+    }
+    CHECK(pmap.size() == 10);
+    CHECK(pmap.keys().front() == 1);
+    CHECK(pmap.at(7).data[0] == 7.f);
+    pmap.erase(7);
+    CHECK(pmap.find(7) == pmap.end());
+    CHECK(pmap[8].data[0] == 8.f);
+
+    flat_soa_map<std::string, int, fsoaimpl::less, small_vector<std::string, 4>, small_vector<int, 4>> smap;
+    smap["b"] = 2;
+    smap["a"] = 1;
+    smap["c"] = 3;
+    CHECK(smap.begin()->first == "a");
+    CHECK(smap.find("c")->second == 3);
+    CHECK(smap.find("d") == smap.end());
+    CHECK(smap.keys().is_static());
+}
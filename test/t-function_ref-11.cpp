@@ -0,0 +1,113 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include <doctest/doctest.h>
+
+#include <itlib/function_ref.hpp>
+
+#include <type_traits>
+#include <string>
+#include <vector>
+
+using itlib::function_ref;
+
+static_assert(sizeof(function_ref<void()>) == 2 * sizeof(void*), "function_ref must be two pointers");
+static_assert(std::is_trivially_copyable<function_ref<int(int)>>::value, "function_ref must be trivially copyable");
+static_assert(!std::is_default_constructible<function_ref<void()>>::value, "function_ref must not be nullable");
+static_assert(!std::is_constructible<function_ref<void()>, std::nullptr_t>::value, "function_ref must not be nullable");
+static_assert(!std::is_constructible<function_ref<int(int)>, int>::value, "not callable");
+
+struct fo { void operator()() {} };
+static_assert(std::is_assignable<function_ref<void()>&, fo&>::value, "lvalues can be assigned");
+static_assert(!std::is_assignable<function_ref<void()>&, fo>::value, "temporaries cannot be assigned");
+
+struct returns_string { std::string operator()() const { return std::string(100, 'x'); } };
+struct returns_string_ref { std::string& operator()() const { static std::string s; return s; } };
+static_assert(!std::is_constructible<function_ref<const std::string&()>, returns_string&>::value, "would dangle");
+static_assert(std::is_constructible<function_ref<const std::string&()>, returns_string_ref&>::value, "reference to reference");
+static_assert(std::is_constructible<function_ref<std::string()>, returns_string_ref&>::value, "reference to value");
+
+int sum(int a, int b) { return a + b; }
+
+int visit(const std::vector<int>& vec, function_ref<void(int)> cb)
+{
+    for (auto i : vec) cb(i);
+    return int(vec.size());
+}
+
+TEST_CASE("function_ref basic")
+{
+    int total = 0;
+    auto n = visit({1, 2, 3}, [&](int i) { total += i; });
+    CHECK(n == 3);
+    CHECK(total == 6);
+
+    function_ref<int(int, int)> f = sum;
+    CHECK(f(1, 2) == 3);
+
+    auto mul = [](int a, int b) { return a * b; };
+    f = mul;
+    CHECK(f(3, 4) == 12);
+
+    f = &sum;
+    CHECK(f(3, 4) == 7);
+
+    // copies refer to the same object
+    int calls = 0;
+    auto counter = [&calls](int, int) { return ++calls; };
+    function_ref<int(int, int)> c1 = counter;
+    auto c2 = c1;
+    c1(0, 0);
+    c2(0, 0);
+    CHECK(calls == 2);
+
+    // conversions of arguments and return value
+    function_ref<long(short, short)> fl = sum;
+    CHECK(fl(5, 6) == 11);
+
+    // discard return value
+    function_ref<void(int, int)> fv = sum;
+    fv(1, 2);
+    fv = counter;
+    fv(1, 2);
+    CHECK(calls == 3);
+}
+
+struct stateful
+{
+    int value = 0;
+    int operator()(int i) { return value += i; }
+    int operator()(int i) const { return value + i + 1000; }
+};
+
+TEST_CASE("function_ref constness")
+{
+    stateful s;
+    function_ref<int(int)> f = s;
+    CHECK(f(5) == 5);
+    CHECK(f(5) == 10);
+    CHECK(s.value == 10);
+
+    const stateful& cs = s;
+    function_ref<int(int)> cf = cs;
+    CHECK(cf(5) == 1015);
+    CHECK(s.value == 10);
+
+    int m = 0;
+    auto ml = [m](int i) mutable { return m += i; };
+    function_ref<int(int)> fm = ml;
+    fm(3);
+    CHECK(fm(3) == 6);
+}
+
+TEST_CASE("function_ref forward")
+{
+    std::string str = "abc";
+    function_ref<std::string(std::string&&)> take = [](std::string&& s) { return std::move(s); };
+    auto taken = take(std::move(str));
+    CHECK(taken == "abc");
+
+    function_ref<void(std::string&)> append = [](std::string& s) { s += "xyz"; };
+    append(taken);
+    CHECK(taken == "abcxyz");
+}
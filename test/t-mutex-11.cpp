@@ -6,6 +6,9 @@
 #include <itlib/mutex.hpp>
 
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
 
 TEST_CASE("strong_try_rec_mutex")
 {
@@ -76,3 +79,142 @@ TEST_CASE("strong_try_rec_mutex")
         m.unlock();
     }
 }
+
+TEST_CASE("instrumented_mutex")
+{
+    itlib::instrumented_mutex<> m;
+    auto s = m.stats();
+    CHECK(s.acquisitions == 0);
+    CHECK(s.contended == 0);
+
+    m.lock();
+    m.unlock();
+    CHECK(m.try_lock());
+    std::thread([&]() {
+        CHECK_FALSE(m.try_lock());
+    }).join();
+    m.unlock();
+
+    s = m.stats();
+    CHECK(s.acquisitions == 2);
+    CHECK(s.shared_acquisitions == 0);
+    CHECK(s.contended == 0);
+    CHECK(s.failed_try_locks == 1);
+    CHECK(s.total_wait_ns == 0);
+    CHECK(s.total_hold_ns >= s.max_hold_ns);
+
+    // contention
+    std::atomic_bool locked = {false};
+    m.lock();
+    std::thread ta([&]() {
+        while (!locked);
+        m.lock();
+        m.unlock();
+    });
+    locked = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    m.unlock();
+    ta.join();
+
+    s = m.stats();
+    CHECK(s.acquisitions == 4);
+    uint64_t hist = 0;
+    for (auto h : s.wait_histogram) hist += h;
+    CHECK(hist == s.contended);
+    CHECK(s.max_hold_ns >= 5000000);
+    if (s.contended)
+    {
+        // the other thread may have not reached lock() before the unlock
+        CHECK(s.contended == 1);
+        CHECK(s.max_wait_ns == s.total_wait_ns);
+    }
+
+    m.reset_stats();
+    s = m.stats();
+    CHECK(s.acquisitions == 0);
+    CHECK(s.max_hold_ns == 0);
+    CHECK(s.wait_histogram[itlib::mutex_stats::num_wait_buckets - 1] == 0);
+}
+
+TEST_CASE("adaptive_mutex")
+{
+    itlib::adaptive_mutex m;
+    CHECK(m.try_lock());
+    CHECK_FALSE(m.try_lock());
+    m.unlock();
+    m.lock();
+    CHECK_FALSE(m.try_lock());
+    m.unlock();
+
+    static constexpr int num_threads = 4;
+    static constexpr int n = 20000;
+    int counter = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t)
+    {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < n; ++i)
+            {
+                m.lock();
+                ++counter;
+                m.unlock();
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    CHECK(counter == num_threads * n);
+}
+
+TEST_CASE("adaptive_shared_mutex")
+{
+    itlib::adaptive_shared_mutex m;
+    CHECK(m.try_lock_shared());
+    CHECK(m.try_lock_shared());
+    CHECK_FALSE(m.try_lock());
+    m.unlock_shared();
+    CHECK_FALSE(m.try_lock());
+    m.unlock_shared();
+    CHECK(m.try_lock());
+    CHECK_FALSE(m.try_lock_shared());
+    CHECK_FALSE(m.try_lock());
+    m.unlock();
+
+    static constexpr int n = 10000;
+    int a = 0, b = 0;
+    std::atomic_bool done = {false};
+    std::atomic_int torn = {0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 2; ++t)
+    {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < n; ++i)
+            {
+                m.lock();
+                ++a;
+                ++b;
+                m.unlock();
+            }
+        });
+    }
+    for (int t = 0; t < 2; ++t)
+    {
+        threads.emplace_back([&]() {
+            while (!done)
+            {
+                m.lock_shared();
+                if (a != b) ++torn;
+                m.unlock_shared();
+            }
+        });
+    }
+    threads[0].join();
+    threads[1].join();
+    done = true;
+    for (auto& t : threads)
+    {
+        if (t.joinable()) t.join();
+    }
+    CHECK(torn == 0);
+    CHECK(a == 2 * n);
+    CHECK(b == 2 * n);
+}
@@ -0,0 +1,95 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include <doctest/doctest.h>
+
+#include <itlib/mutex.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// the C++20 versions of the adaptive mutexes block with std::atomic::wait
+
+TEST_CASE("adaptive_mutex")
+{
+    itlib::adaptive_mutex m;
+    CHECK(m.try_lock());
+    CHECK_FALSE(m.try_lock());
+    m.unlock();
+    m.lock();
+    CHECK_FALSE(m.try_lock());
+    m.unlock();
+
+    static constexpr int num_threads = 4;
+    static constexpr int n = 20000;
+    int counter = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t)
+    {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < n; ++i)
+            {
+                m.lock();
+                ++counter;
+                m.unlock();
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    CHECK(counter == num_threads * n);
+}
+
+TEST_CASE("adaptive_shared_mutex")
+{
+    itlib::adaptive_shared_mutex m;
+    CHECK(m.try_lock_shared());
+    CHECK(m.try_lock_shared());
+    CHECK_FALSE(m.try_lock());
+    m.unlock_shared();
+    CHECK_FALSE(m.try_lock());
+    m.unlock_shared();
+    CHECK(m.try_lock());
+    CHECK_FALSE(m.try_lock_shared());
+    CHECK_FALSE(m.try_lock());
+    m.unlock();
+
+    static constexpr int n = 10000;
+    int a = 0, b = 0;
+    std::atomic_bool done = {false};
+    std::atomic_int torn = {0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 2; ++t)
+    {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < n; ++i)
+            {
+                m.lock();
+                ++a;
+                ++b;
+                m.unlock();
+            }
+        });
+    }
+    for (int t = 0; t < 2; ++t)
+    {
+        threads.emplace_back([&]() {
+            while (!done)
+            {
+                m.lock_shared();
+                if (a != b) ++torn;
+                m.unlock_shared();
+            }
+        });
+    }
+    threads[0].join();
+    threads[1].join();
+    done = true;
+    for (auto& t : threads)
+    {
+        if (t.joinable()) t.join();
+    }
+    CHECK(torn == 0);
+    CHECK(a == 2 * n);
+    CHECK(b == 2 * n);
+}
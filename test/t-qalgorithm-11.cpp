@@ -4,8 +4,12 @@
 #include <doctest/doctest.h>
 
 #include <itlib/qalgorithm.hpp>
+#include <itlib/stride_span.hpp>
 
 #include <vector>
+#include <cstdint>
+#include <string>
+#include <stdexcept>
 
 TEST_CASE("find")
 {
@@ -145,4 +149,238 @@ TEST_CASE("span")
     *p = 18;
     auto cp = pfind(cspan, 18);
     CHECK(cp == p);
-}
\ No newline at end of file
+}
+
+template <typename T>
+void test_simd()
+{
+    // sizes which cover empty, partial, exactly one, and multiple sse2 and avx2 blocks
+    for (size_t size = 0; size < 80; ++size)
+    {
+        std::vector<T> vec(size);
+        for (size_t i = 0; i < size; ++i) vec[i] = T(i % 7 + 10);
+        const auto& cvec = vec;
+
+        CHECK(itlib::qfind(vec, T(3)) == vec.end());
+        CHECK(itlib::qfind(cvec, T(3)) == cvec.end());
+        CHECK_FALSE(itlib::pfind(vec, T(3)));
+        CHECK_FALSE(itlib::qcontains(vec, T(3)));
+        CHECK(itlib::qcount(vec, T(3)) == 0);
+        CHECK(itlib::qcount(vec, T(12)) == size_t(std::count(vec.begin(), vec.end(), T(12))));
+
+        for (size_t pos = 0; pos < size; ++pos)
+        {
+            auto copy = vec;
+            copy[pos] = T(3);
+            CHECK(itlib::qfind(copy, T(3)) - copy.begin() == ptrdiff_t(pos));
+            CHECK(itlib::pfind(copy, T(3)) == copy.data() + pos);
+            CHECK(itlib::qcontains(copy, T(3)));
+            CHECK(itlib::qcount(copy, T(3)) == 1);
+
+            // a second match must not affect the first
+            copy.back() = T(3);
+            CHECK(itlib::qfind(copy, T(3)) - copy.begin() == ptrdiff_t(pos));
+            CHECK(itlib::qcount(copy, T(3)) == (pos == size - 1 ? 1u : 2u));
+
+            // values which only differ in the high bytes
+            copy[pos] = T(T(3) | T(T(1) << (sizeof(T) * 8 - 2)));
+            CHECK(itlib::qcount(copy, T(3)) == (pos == size - 1 ? 0u : 1u));
+
+            auto ref = vec;
+            ref.erase(std::remove(ref.begin(), ref.end(), T(12)), ref.end());
+            copy = vec;
+            CHECK(itlib::erase_all(copy, T(12)) == vec.size() - ref.size());
+            CHECK(copy == ref);
+
+            copy = vec;
+            copy[pos] = T(12);
+            ref = copy;
+            ref.erase(std::remove(ref.begin(), ref.end(), T(12)), ref.end());
+            CHECK(itlib::erase_all(copy, T(12)) == vec.size() - ref.size());
+            CHECK(copy == ref);
+        }
+
+        auto copy = vec;
+        CHECK(itlib::erase_all(copy, T(3)) == 0);
+        CHECK(copy == vec);
+
+        std::fill(copy.begin(), copy.end(), T(3));
+        CHECK(itlib::qcount(copy, T(3)) == size);
+        CHECK(itlib::erase_all(copy, T(3)) == size);
+        CHECK(copy.empty());
+    }
+}
+
+TEST_CASE("simd")
+{
+    test_simd<int8_t>();
+    test_simd<uint8_t>();
+    test_simd<int16_t>();
+    test_simd<uint16_t>();
+    test_simd<int32_t>();
+    test_simd<uint32_t>();
+    test_simd<int64_t>();
+    test_simd<uint64_t>();
+}
+
+TEST_CASE("simd mixed types")
+{
+    std::vector<uint8_t> u8(40, 0);
+    u8[20] = 255;
+    CHECK(itlib::qfind(u8, 255) - u8.begin() == 20);
+    CHECK(itlib::qfind(u8, -1) == u8.end()); // 255 != -1
+    CHECK(itlib::qfind(u8, 256) == u8.end()); // doesn't match 0
+    CHECK(itlib::qcount(u8, 0) == 39);
+    CHECK(itlib::qcount(u8, 256) == 0);
+    CHECK(itlib::erase_all(u8, 256) == 0);
+    CHECK(u8.size() == 40);
+
+    std::vector<uint32_t> u32(40, 0);
+    u32[30] = 0xFFFFFFFF;
+    CHECK(itlib::qfind(u32, -1) - u32.begin() == 30); // -1 converts to 0xFFFFFFFF
+    CHECK(itlib::qfind(u32, int64_t(-1)) == u32.end());
+    CHECK(itlib::qcount(u32, 0ull) == 39);
+
+    std::vector<int32_t> i32(40, 0);
+    i32[10] = -1;
+    CHECK(itlib::qfind(i32, 0xFFFFFFFFu) - i32.begin() == 10); // -1 converts to 0xFFFFFFFF
+    CHECK(itlib::qfind(i32, int64_t(0xFFFFFFFF)) == i32.end());
+    CHECK(itlib::erase_all(i32, -1ll) == 1);
+    CHECK(i32.size() == 39);
+
+    std::string str = "the quick brown fox jumps over the lazy dog";
+    CHECK(itlib::qfind(str, 'z') - str.begin() == 37);
+    CHECK(itlib::qcount(str, ' ') == 8);
+    CHECK(itlib::erase_all(str, ' ') == 8);
+    CHECK(str == "thequickbrownfoxjumpsoverthelazydog");
+
+    std::vector<int> vec(100);
+    for (int i = 0; i < 100; ++i) vec[size_t(i)] = i;
+    itlib::span<const int> span(vec.data() + 10, 80);
+    CHECK(itlib::qfind(span, 50) - span.begin() == 40);
+    CHECK(itlib::pfind(span, 95) == nullptr);
+    CHECK(itlib::qcount(span, 5) == 0);
+}
+
+TEST_CASE("simd stride_span")
+{
+    // data() returns a pointer to bytes, but the iterators skip the padding
+    uint8_t buf[40];
+    for (size_t i = 0; i < sizeof(buf); ++i) buf[i] = i % 4 ? 7 : 1;
+    itlib::stride_span<uint8_t> s(buf, 4, 10);
+    const auto& cs = s;
+
+    CHECK(itlib::qfind(s, 7) == s.end());
+    CHECK(itlib::qfind(cs, 7) == cs.end());
+    CHECK_FALSE(itlib::qcontains(s, 7));
+    CHECK(itlib::qcount(s, 1) == 10);
+    CHECK(itlib::qcount(s, 7) == 0);
+    CHECK(itlib::pfind(s, 7) == nullptr);
+
+    buf[24] = 7;
+    CHECK(itlib::qfind(s, 7) - s.begin() == 6);
+    CHECK(itlib::qcount(s, 7) == 1);
+}
+
+// runs the tasks serially in reverse order
+// the last chunks finish first, so this checks that the results don't depend on the order
+struct reverse_executor
+{
+    size_t chunks;
+    mutable size_t calls;
+    size_t concurrency() const { return chunks; }
+    template <typename Task>
+    void operator()(size_t count, Task& task) const
+    {
+        ++calls;
+        while (count--) task(count);
+    }
+};
+
+TEST_CASE("par small")
+{
+    std::vector<int> vec = {1, 2, 3, 4, 5};
+    reverse_executor exec = {4, 0};
+    CHECK(itlib::par_qany_of(vec, [](int i) { return i == 3; }, exec));
+    CHECK_FALSE(itlib::par_qany_of(vec, [](int i) { return i == 6; }, exec));
+    CHECK(itlib::par_pfind_if(vec, [](int i) { return i > 2; }, exec) == vec.data() + 2);
+    CHECK(itlib::par_erase_all_if(vec, [](int i) { return i % 2 == 0; }, exec) == 2);
+    CHECK(vec == std::vector<int>{1, 3, 5});
+
+    // too small to split
+    CHECK(exec.calls == 0);
+
+    std::vector<int> empty;
+    CHECK_FALSE(itlib::par_qany_of(empty, [](int) { return true; }));
+    CHECK_FALSE(itlib::par_pfind_if(empty, [](int) { return true; }));
+    CHECK(itlib::par_erase_all_if(empty, [](int) { return true; }) == 0);
+}
+
+template <typename Executor>
+void test_par(Executor&& exec)
+{
+    const size_t size = itlib::par_min_chunk_size * 5 + 123;
+    std::vector<int> vec(size);
+    for (size_t i = 0; i < size; ++i) vec[i] = int(i);
+    const auto& cvec = vec;
+
+    CHECK(itlib::par_qany_of(vec, [](int i) { return i == 70000; }, exec));
+    CHECK(itlib::par_qany_of(vec, [](int i) { return i == 0; }, exec));
+    CHECK_FALSE(itlib::par_qany_of(vec, [](int i) { return i < 0; }, exec));
+
+    CHECK(itlib::par_pfind_if(vec, [](int i) { return i == 70000; }, exec) == vec.data() + 70000);
+    CHECK(itlib::par_pfind_if(cvec, [](int i) { return i == 70000; }, exec) == vec.data() + 70000);
+    CHECK_FALSE(itlib::par_pfind_if(vec, [](int i) { return i < 0; }, exec));
+    // the first match must be returned even if later chunks match sooner
+    CHECK(itlib::par_pfind_if(vec, [](int i) { return i % 20000 == 19999; }, exec) == vec.data() + 19999);
+    CHECK(itlib::par_pfind_if(vec, [](int i) { return i > 3; }, exec) == vec.data() + 4);
+
+    auto ref = vec;
+    auto pred = [](int i) { return i % 3 == 0 || (i > 40000 && i < 50000); };
+    ref.erase(std::remove_if(ref.begin(), ref.end(), pred), ref.end());
+    auto copy = vec;
+    CHECK(itlib::par_erase_all_if(copy, pred, exec) == size - ref.size());
+    CHECK(copy == ref);
+
+    CHECK(itlib::par_erase_all_if(copy, [](int) { return false; }, exec) == 0);
+    CHECK(copy == ref);
+
+    CHECK(itlib::par_erase_all_if(copy, [](int) { return true; }, exec) == ref.size());
+    CHECK(copy.empty());
+}
+
+TEST_CASE("par")
+{
+    reverse_executor rexec = {4, 0};
+    test_par(rexec);
+    CHECK(rexec.calls != 0);
+
+    test_par(itlib::std_thread_executor{});
+    test_par(itlib::std_thread_executor(3));
+    test_par(itlib::std_thread_executor(100)); // more threads than chunks
+
+    // std::string is not trivially copyable
+    std::vector<std::string> strs(itlib::par_min_chunk_size * 3, "abc");
+    for (size_t i = 0; i < strs.size(); i += 7) strs[i] = "x";
+    auto ref = strs;
+    ref.erase(std::remove(ref.begin(), ref.end(), "x"), ref.end());
+    itlib::par_erase_all_if(strs, [](const std::string& s) { return s == "x"; }, rexec);
+    CHECK(strs == ref);
+
+    // nothing removed: the chunks must not be moved onto themselves
+    ref = strs;
+    CHECK(itlib::par_erase_all_if(strs, [](const std::string& s) { return s == "x"; }, rexec) == 0);
+    CHECK(strs == ref);
+    CHECK(itlib::par_erase_all_if(strs, [](const std::string& s) { return s == "x"; }, itlib::std_thread_executor(4)) == 0);
+    CHECK(strs == ref);
+}
+
+TEST_CASE("par exceptions")
+{
+    std::vector<int> vec(itlib::par_min_chunk_size * 4, 0);
+    vec.back() = 1;
+    CHECK_THROWS_AS(itlib::par_qany_of(vec, [](int i) -> bool {
+        if (i) throw std::runtime_error("x");
+        return false;
+    }, itlib::std_thread_executor(4)), std::runtime_error);
+}
@@ -1,6 +1,9 @@
 #include <itlib/ref_ptr.hpp>
 #include <doctest/doctest.h>
 #include <string>
+#include <stdexcept>
+#include <cstdint>
+#include <vector>
 
 using itlib::ref_ptr;
 using itlib::make_ref_ptr;
@@ -98,12 +101,153 @@ TEST_CASE("poly") {
     CHECK_FALSE(a < d);
 }
 
+struct named {
+    named(std::string n) : name(std::move(n)) {}
+    virtual ~named() = default;
+    std::string name;
+};
+
+struct cat : public named, public animal {
+    cat(std::string n, int l) : named(n + " the cat"), animal(std::move(n)), lives(l) {}
+    std::string speak() const override {
+        return animal::name + ": meow";
+    }
+    int lives;
+};
+
+TEST_CASE("multiple inheritance") {
+    auto c = make_ref_ptr<cat>("Tom", 9);
+    ref_ptr<const named> n = c;
+    ref_ptr<animal> a = c;
+    CHECK(c.use_count() == 3);
+
+    CHECK(n->name == "Tom the cat");
+    CHECK(a->speak() == "Tom: meow");
+
+    c.reset();
+    CHECK(a.use_count() == 2);
+    n = nullptr;
+    CHECK(a.unique());
+
+    ref_ptr<animal> a2 = std::move(a);
+    CHECK_FALSE(a);
+    CHECK(a2.unique());
+    CHECK(a2->speak() == "Tom: meow");
+}
+
+struct counted {
+    static int alive;
+    int value;
+    counted(int v) : value(v) {
+        if (v < 0) throw std::runtime_error("negative");
+        ++alive;
+    }
+    counted(const counted& o) : value(o.value) { ++alive; }
+    ~counted() { --alive; }
+};
+int counted::alive = 0;
+
+struct alignas(64) overaligned {
+    int x = 5;
+};
+
+TEST_CASE("native") {
+    static_assert(sizeof(ref_ptr<int>) == sizeof(void*), "ref_ptr must be a single pointer");
+    static_assert(sizeof(ref_ptr<animal>) == sizeof(void*), "ref_ptr must be a single pointer");
+
+    static_assert(std::is_convertible<ref_ptr<dog>, ref_ptr<const animal>>::value, "polymorphic upcast");
+    static_assert(std::is_convertible<ref_ptr<int>, ref_ptr<const int>>::value, "const");
+    static_assert(!std::is_convertible<ref_ptr<const int>, ref_ptr<int>>::value, "no const drop");
+    static_assert(!std::is_convertible<ref_ptr<animal>, ref_ptr<dog>>::value, "no downcast");
+
+    {
+        auto p = make_ref_ptr<counted>(3);
+        CHECK(counted::alive == 1);
+        auto p2 = p;
+        ref_ptr<const counted> p3 = p2;
+        CHECK(p.use_count() == 3);
+        p.reset();
+        p2.reset();
+        CHECK(counted::alive == 1);
+        CHECK(p3->value == 3);
+    }
+    CHECK(counted::alive == 0);
+
+    CHECK_THROWS_AS(make_ref_ptr<counted>(-1), std::runtime_error);
+    CHECK(counted::alive == 0);
+
+    auto oa = make_ref_ptr<overaligned>();
+    CHECK(reinterpret_cast<uintptr_t>(oa.get()) % 64 == 0);
+    CHECK(oa->x == 5);
+    CHECK(oa.unique());
+
+    std::vector<ref_ptr<overaligned>> oas;
+    for (int i = 0; i < 100; ++i) {
+        oas.push_back(make_ref_ptr<overaligned>());
+        CHECK(reinterpret_cast<uintptr_t>(oas.back().get()) % 64 == 0);
+    }
+}
+
 TEST_CASE("unsafe") {
-    auto sp = std::make_shared<int>(55);
-    auto rp = itlib::_ref_ptr_from_shared_ptr_unsafe(sp);
+    auto rp = make_ref_ptr<int>(55);
+    auto sp = rp._as_shared_ptr_unsafe();
     CHECK(sp.get() == rp.get());
     CHECK_FALSE(rp.unique());
-    auto sp2 = rp._as_shared_ptr_unsafe();
-    CHECK(sp == sp2);
-    CHECK(rp.use_count() == 3);
+    CHECK(rp.use_count() == 2);
+
+    auto sp2 = sp;
+    CHECK(rp.use_count() == 2);
+    CHECK(sp.use_count() == 2);
+
+    sp.reset();
+    CHECK_FALSE(rp.unique());
+    sp2.reset();
+    CHECK(rp.unique());
+
+    ref_ptr<int> null;
+    CHECK_FALSE(null._as_shared_ptr_unsafe());
+}
+
+TEST_CASE("st") {
+    using itlib::ref_ptr_st;
+    static_assert(sizeof(ref_ptr_st<int>) == sizeof(void*), "ref_ptr_st must be a single pointer");
+    static_assert(!std::is_convertible<ref_ptr_st<int>, ref_ptr<int>>::value, "no policy conversion");
+    static_assert(!std::is_convertible<ref_ptr<int>, ref_ptr_st<int>>::value, "no policy conversion");
+
+    ref_ptr_st<int> p0;
+    CHECK_FALSE(p0);
+    CHECK(p0.use_count() == 0);
+
+    auto p1 = itlib::make_ref_ptr_st<int>(42);
+    CHECK(p1.unique());
+
+    ref_ptr_st<const int> p2 = p1;
+    CHECK(p2.use_count() == 2);
+    CHECK(p2 == p1);
+
+    auto p3 = itlib::make_ref_ptr_st_from(*p2);
+    CHECK(p3 != p2);
+    CHECK(*p3 == 42);
+
+    p1.reset();
+    CHECK(p2.unique());
+
+    {
+        auto d = itlib::make_ref_ptr_st_from(dog("Rex"));
+        ref_ptr_st<const animal> a = d;
+        CHECK(a.use_count() == 2);
+        d = nullptr;
+        CHECK(a.unique());
+        CHECK(a->speak() == "Rex: woof");
+    }
+
+    {
+        auto p = ref_ptr_st<counted>::make(5);
+        auto pc = p;
+        CHECK(counted::alive == 1);
+        p.reset();
+        CHECK(counted::alive == 1);
+        pc.reset();
+        CHECK(counted::alive == 0);
+    }
 }
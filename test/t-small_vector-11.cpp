@@ -10,6 +10,8 @@
 #include <utility>
 #include <string>
 #include <cstring>
+#include <vector>
+#include <stdexcept>
 
 using itlib::small_vector;
 
@@ -539,7 +541,260 @@ TEST_CASE("[small_vector] compare")
     CHECK(fvec1 != fvec2);
 }
 
+template <typename Vec>
+void check_transfers(std::vector<typename Vec::value_type> src)
+{
+    using T = typename Vec::value_type;
+    std::vector<T> ref;
+    Vec vec;
+
+    for (size_t i = 0; i < 10; ++i)
+    {
+        vec.push_back(src[i]);
+        ref.push_back(src[i]);
+    }
+    CHECK(vec.is_static());
+
+    // static to dynamic
+    vec.insert(vec.begin() + 3, src.data() + 10, src.data() + 20);
+    ref.insert(ref.begin() + 3, src.begin() + 10, src.begin() + 20);
+    CHECK_FALSE(vec.is_static());
+    CHECK(std::vector<T>(vec.begin(), vec.end()) == ref);
+
+    // dynamic to dynamic
+    vec.insert(vec.begin() + 5, src.data() + 20, src.data() + 30);
+    ref.insert(ref.begin() + 5, src.begin() + 20, src.begin() + 30);
+    CHECK(std::vector<T>(vec.begin(), vec.end()) == ref);
+
+    // in place
+    vec.reserve(100);
+    vec.insert(vec.begin(), src.begin() + 30, src.begin() + 35);
+    ref.insert(ref.begin(), src.begin() + 30, src.begin() + 35);
+    vec.insert(vec.begin() + 7, 3, src[40]);
+    ref.insert(ref.begin() + 7, 3, src[40]);
+    vec.erase(vec.begin() + 2, vec.begin() + 9);
+    ref.erase(ref.begin() + 2, ref.begin() + 9);
+    CHECK(std::vector<T>(vec.begin(), vec.end()) == ref);
+
+    Vec copy = vec;
+    CHECK(copy == vec);
+
+    // dynamic to static
+    vec.erase(vec.begin() + 1, vec.end() - 4);
+    ref.erase(ref.begin() + 1, ref.end() - 4);
+    CHECK(vec.is_static());
+    CHECK(std::vector<T>(vec.begin(), vec.end()) == ref);
+
+    copy.erase(copy.begin() + 1, copy.end() - 4);
+    CHECK(copy == vec);
+    copy.shrink_to_fit();
+    CHECK(copy.is_static());
+    CHECK(copy == vec);
+
+    Vec moved = std::move(vec);
+    CHECK(std::vector<T>(moved.begin(), moved.end()) == ref);
+    CHECK(vec.empty());
+}
+
+template <typename T>
+struct constructing_allocator : public std::allocator<T>
+{
+    using std::allocator<T>::allocator;
+    template <typename U>
+    struct rebind { using other = constructing_allocator<U>; };
+
+    static int& constructs() { static int c = 0; return c; }
+
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args)
+    {
+        ++constructs();
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+    template <typename U>
+    void destroy(U* p) { p->~U(); }
+};
+
+TEST_CASE("[small_vector] element transfers")
+{
+    std::vector<uint32_t> ints;
+    std::vector<std::string> strings;
+    for (uint32_t i = 0; i < 50; ++i)
+    {
+        ints.push_back(i * 7);
+        strings.push_back(std::string(30, char('a' + i % 26)) + std::to_string(i));
+    }
+
+    check_transfers<small_vector<uint32_t, 16, 17>>(ints);
+    check_transfers<small_vector<std::string, 16, 17>>(strings);
+    check_transfers<small_vector<uint32_t, 16, 17, constructing_allocator<uint32_t>>>(ints);
+
+    // the allocator's construct is called when it's provided
+    constructing_allocator<uint32_t>::constructs() = 0;
+    small_vector<uint32_t, 4, 0, constructing_allocator<uint32_t>> cvec(ints.begin(), ints.begin() + 3);
+    CHECK(constructing_allocator<uint32_t>::constructs() == 3);
+    cvec.push_back(1);
+    cvec.push_back(2);
+    CHECK(constructing_allocator<uint32_t>::constructs() == 9);
+}
+
 #if !defined(__EMSCRIPTEN__) // emscripten doesn't allow exceptions by default
+struct throwing_copy
+{
+    static int copies_left;
+    static int alive;
+
+    std::string value;
+
+    throwing_copy(int i) : value(std::string(30, 'x') + std::to_string(i)) { ++alive; }
+    throwing_copy(const throwing_copy& other) : value(other.value)
+    {
+        if (--copies_left < 0) throw std::runtime_error("copy");
+        ++alive;
+    }
+    throwing_copy& operator=(const throwing_copy&) = default;
+    ~throwing_copy() { --alive; }
+};
+int throwing_copy::copies_left = 1000;
+int throwing_copy::alive = 0;
+
+// copyable, but its move may throw, and it leaves the source empty if it does
+struct throwing_move
+{
+    static int moves_left;
+    static int copies;
+    static int alive;
+
+    std::string value;
+
+    throwing_move(int i) : value(std::string(30, 'x') + std::to_string(i)) { ++alive; }
+    throwing_move(const throwing_move& other) : value(other.value) { ++copies; ++alive; }
+    throwing_move(throwing_move&& other) : value(std::move(other.value))
+    {
+        if (--moves_left < 0) throw std::runtime_error("move");
+        ++alive;
+    }
+    throwing_move& operator=(const throwing_move&) = default;
+    throwing_move& operator=(throwing_move&&) = default;
+    ~throwing_move() { --alive; }
+};
+int throwing_move::moves_left = 1000;
+int throwing_move::copies = 0;
+int throwing_move::alive = 0;
+
+template <typename Vec>
+bool check_values(const Vec& vec, std::vector<int> expected)
+{
+    if (vec.size() != expected.size()) return false;
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        if (vec[i].value != std::string(30, 'x') + std::to_string(expected[i])) return false;
+    }
+    return true;
+}
+
+TEST_CASE("[small_vector] exception safety")
+{
+    {
+        small_vector<throwing_copy, 4, 3> vec;
+        for (int i = 0; i < 4; ++i) vec.emplace_back(i);
+
+        // static to dynamic
+        throwing_copy::copies_left = 2;
+        CHECK_THROWS_AS(vec.reserve(10), std::runtime_error);
+        CHECK(vec.is_static());
+        CHECK(check_values(vec, {0, 1, 2, 3}));
+
+        throwing_copy::copies_left = 2;
+        CHECK_THROWS_AS(vec.emplace_back(4), std::runtime_error);
+        CHECK(vec.is_static());
+        CHECK(check_values(vec, {0, 1, 2, 3}));
+
+        throwing_copy::copies_left = 1000;
+        vec.emplace_back(4);
+        vec.emplace_back(5);
+        CHECK_FALSE(vec.is_static());
+
+        // dynamic to dynamic
+        vec.shrink_to_fit();
+        throwing_copy::copies_left = 3;
+        CHECK_THROWS_AS(vec.emplace(vec.begin() + 2, 10), std::runtime_error);
+        CHECK(check_values(vec, {0, 1, 2, 3, 4, 5}));
+
+        // dynamic to static
+        throwing_copy::copies_left = 1;
+        CHECK_THROWS_AS(vec.erase(vec.begin() + 1, vec.begin() + 5), std::runtime_error);
+        CHECK_FALSE(vec.is_static());
+        CHECK(check_values(vec, {0, 1, 2, 3, 4, 5}));
+
+        throwing_copy::copies_left = 1000;
+        vec.reserve(20);
+        vec.erase(vec.begin() + 5);
+        const auto cap = vec.capacity();
+        throwing_copy::copies_left = 2;
+        CHECK_THROWS_AS(vec.shrink_to_fit(), std::runtime_error);
+        CHECK(vec.capacity() == cap);
+        CHECK(check_values(vec, {0, 1, 2, 3, 4}));
+
+        // copy
+        small_vector<throwing_copy, 4, 3> copy;
+        copy.emplace_back(7);
+        throwing_copy::copies_left = 2;
+        CHECK_THROWS_AS(copy = vec, std::runtime_error);
+        CHECK(copy.empty());
+
+        // in place: the vector remains valid
+        throwing_copy::copies_left = 1;
+        CHECK_THROWS_AS(vec.emplace(vec.begin(), 10), std::runtime_error);
+        CHECK(vec.size() <= 5);
+        throwing_copy::copies_left = 1;
+        CHECK_THROWS_AS(vec.erase(vec.begin()), std::runtime_error);
+        CHECK(vec.size() <= 5);
+        throwing_copy::copies_left = 1000;
+    }
+    CHECK(throwing_copy::alive == 0);
+
+    {
+        // the elements are copied instead of moved on reallocation
+        small_vector<throwing_move, 4, 3> vec;
+        for (int i = 0; i < 4; ++i) vec.emplace_back(i);
+
+        // static to dynamic
+        throwing_move::moves_left = 2;
+        vec.reserve(100);
+        CHECK_FALSE(vec.is_static());
+        CHECK(check_values(vec, {0, 1, 2, 3}));
+
+        // dynamic to dynamic
+        throwing_move::moves_left = 0;
+        CHECK(vec.shrink_to_fit());
+        CHECK(vec.capacity() == 4);
+        CHECK(check_values(vec, {0, 1, 2, 3}));
+
+        vec.emplace(vec.begin() + 1, 10);
+        CHECK_FALSE(vec.is_static());
+        CHECK(check_values(vec, {0, 10, 1, 2, 3}));
+
+        // dynamic to static on erase
+        vec.erase(vec.begin() + 1, vec.begin() + 4);
+        CHECK(vec.is_static());
+        CHECK(check_values(vec, {0, 3}));
+
+        throwing_move::moves_left = 1000;
+
+        // moving the vector itself moves the elements from the static buffer
+        throwing_move::copies = 0;
+        small_vector<throwing_move, 4, 3> moved(std::move(vec));
+        CHECK(moved.is_static());
+        CHECK(check_values(moved, {0, 3}));
+        small_vector<throwing_move, 4, 3> assigned;
+        assigned = std::move(moved);
+        CHECK(check_values(assigned, {0, 3}));
+        CHECK(throwing_move::copies == 0);
+    }
+    CHECK(throwing_move::alive == 0);
+}
+
 TEST_CASE("[small_vector] out of range")
 {
     using namespace itlib;
@@ -0,0 +1,247 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include <doctest/doctest.h>
+
+#include <itlib/sparse_bitset.hpp>
+
+#include <set>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <iterator>
+
+using sbs = itlib::sparse_bitset;
+using ref_set = std::set<uint32_t>;
+
+static bool same(const sbs& b, const ref_set& r)
+{
+    if (b.count() != r.size()) return false;
+    if (!std::equal(r.begin(), r.end(), b.begin())) return false;
+    std::vector<uint32_t> found;
+    for (auto i = b.find_first(); i != sbs::npos; i = b.find_next(i)) found.push_back(uint32_t(i));
+    return std::equal(r.begin(), r.end(), found.begin()) && found.size() == r.size();
+}
+
+TEST_CASE("basic")
+{
+    sbs b;
+    CHECK(b.empty());
+    CHECK(b.none());
+    CHECK(!b.any());
+    CHECK(b.count() == 0);
+    CHECK(b.find_first() == sbs::npos);
+    CHECK(b.begin() == b.end());
+
+    b.set(5);
+    b.set(0xFFFFFFFF);
+    b.set(70000);
+    b.set(5);
+    CHECK(b.any());
+    CHECK(b.count() == 3);
+    CHECK(b.test(5));
+    CHECK(b.test(70000));
+    CHECK(b.test(0xFFFFFFFF));
+    CHECK(!b.test(6));
+    CHECK(!b.test(70000 - 65536));
+
+    CHECK(b.find_first() == 5);
+    CHECK(b.find_next(5) == 70000);
+    CHECK(b.find_next(70000) == 0xFFFFFFFF);
+    CHECK(b.find_next(0xFFFFFFFF) == sbs::npos);
+
+    std::vector<uint32_t> vals(b.begin(), b.end());
+    CHECK(vals == std::vector<uint32_t>{5, 70000, 0xFFFFFFFF});
+
+    b.flip(5);
+    b.flip(6);
+    CHECK(!b.test(5));
+    CHECK(b.test(6));
+    b.set(6, false);
+    b.reset(100); // not set
+    b.reset(200000); // no chunk
+    CHECK(b.count() == 2);
+
+    b.clear();
+    CHECK(b.empty());
+}
+
+TEST_CASE("random")
+{
+    std::minstd_rand rng(42);
+    sbs b;
+    ref_set r;
+
+    for (int i = 0; i < 30000; ++i)
+    {
+        // mostly sparse with a few dense chunks which turn into bitmaps
+        uint32_t v = i % 3 ? uint32_t(rng()) * 2 : uint32_t(rng() % 12000) + (uint32_t(i % 2) << 16);
+        if (rng() % 4 == 0)
+        {
+            b.reset(v);
+            r.erase(v);
+        }
+        else
+        {
+            b.set(v);
+            r.insert(v);
+        }
+    }
+    CHECK(same(b, r));
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        auto v = uint32_t(rng());
+        CHECK(b.test(v) == !!r.count(v));
+        auto next = b.find_next(v);
+        auto f = r.upper_bound(v);
+        CHECK(next == (f == r.end() ? sbs::npos : *f));
+    }
+
+    // dense chunks back to arrays
+    for (uint32_t v = 0; v < 12000; v += 2)
+    {
+        b.reset(v);
+        r.erase(v);
+    }
+    CHECK(same(b, r));
+
+    auto c = b;
+    CHECK(c == b);
+    c.optimize();
+    CHECK(c == b);
+    CHECK(same(c, r));
+}
+
+TEST_CASE("ranges and runs")
+{
+    sbs b;
+    ref_set r;
+
+    b.set_range(100, 200000);
+    for (uint32_t i = 100; i < 200000; ++i) r.insert(i);
+    CHECK(same(b, r));
+    CHECK(b.memory_usage() < 30000);
+
+    b.reset(65536 + 10);
+    r.erase(65536 + 10);
+    b.set(300000);
+    r.insert(300000);
+    CHECK(same(b, r));
+
+    b.reset_range(150, 131072 + 5);
+    r.erase(r.lower_bound(150), r.lower_bound(131072 + 5));
+    CHECK(same(b, r));
+
+    b.set_range(0xFFFFFF00u, uint64_t(1) << 32);
+    for (uint32_t i = 0xFFFFFF00u; i != 0; ++i) r.insert(i);
+    CHECK(same(b, r));
+    CHECK(b.test(0xFFFFFFFF));
+
+    // runs
+    sbs s;
+    for (uint32_t i = 0; i < 20; ++i)
+    {
+        s.set_range(i * 1000, i * 1000 + 500);
+    }
+    auto before = s.memory_usage();
+    auto copy = s;
+    s.optimize();
+    CHECK(s == copy);
+    CHECK(s.memory_usage() < before);
+    CHECK(s.count() == 20 * 500);
+    CHECK(s.test(19250));
+    CHECK(!s.test(19750));
+    CHECK(s.find_next(1499) == 2000);
+
+    // modifying runs
+    s.set(750);
+    s.reset(0);
+    CHECK(s.test(750));
+    CHECK(!s.test(0));
+    CHECK(s.count() == 20 * 500);
+    s.optimize();
+    CHECK(s.count() == 20 * 500);
+
+    // the whole universe
+    sbs all;
+    all.set_range(0, uint64_t(1) << 32);
+    CHECK(all.count() == uint64_t(1) << 32);
+    CHECK(all.memory_usage() < 65536 * 128); // instead of 512 MB
+    all.reset_range(1, (uint64_t(1) << 32) - 1);
+    CHECK(all.count() == 2);
+    CHECK(all.find_next(0) == 0xFFFFFFFF);
+}
+
+static sbs make(const ref_set& r, bool optimize)
+{
+    sbs ret;
+    for (auto v : r) ret.set(v);
+    if (optimize) ret.optimize();
+    return ret;
+}
+
+TEST_CASE("algebra")
+{
+    std::minstd_rand rng(7);
+    ref_set ra, rb;
+    for (int i = 0; i < 20000; ++i)
+    {
+        ra.insert(uint32_t(rng() % 400000));
+        rb.insert(uint32_t(rng() % 100000) + 200000);
+    }
+    for (uint32_t i = 0; i < 6000; ++i)
+    {
+        ra.insert(i + 140000);
+        rb.insert(i * 3 + 130000);
+    }
+
+    for (int opt = 0; opt < 4; ++opt)
+    {
+        const auto a = make(ra, opt & 1);
+        const auto b = make(rb, opt & 2);
+
+        ref_set r;
+        auto x = a;
+        x &= b;
+        std::set_intersection(ra.begin(), ra.end(), rb.begin(), rb.end(), std::inserter(r, r.end()));
+        CHECK(same(x, r));
+
+        r.clear();
+        x = a;
+        x |= b;
+        std::set_union(ra.begin(), ra.end(), rb.begin(), rb.end(), std::inserter(r, r.end()));
+        CHECK(same(x, r));
+
+        r.clear();
+        x = a;
+        x ^= b;
+        std::set_symmetric_difference(ra.begin(), ra.end(), rb.begin(), rb.end(), std::inserter(r, r.end()));
+        CHECK(same(x, r));
+
+        r.clear();
+        x = a;
+        x.andnot(b);
+        std::set_difference(ra.begin(), ra.end(), rb.begin(), rb.end(), std::inserter(r, r.end()));
+        CHECK(same(x, r));
+
+        x = a;
+        x ^= a;
+        CHECK(x.empty());
+        x = b;
+        x &= b;
+        CHECK(x == b);
+
+        // self aliasing
+        x = a;
+        x &= x;
+        CHECK(x == a);
+        x |= x;
+        CHECK(x == a);
+        x.andnot(x);
+        CHECK(x.empty());
+        x = a;
+        x ^= x;
+        CHECK(x.empty());
+    }
+}
@@ -4,3 +4,92 @@
 #include <itlib/transparent_umap.hpp>
 #include <doctest/doctest.h>
 
+#include <string>
+#include <vector>
+
+TEST_CASE("pooled_transparent_umap") {
+    itlib::pooled_transparent_umap<int, std::string> map;
+    for (int i = 0; i < 1000; ++i) {
+        map[i] = std::to_string(i);
+    }
+    CHECK(map.size() == 1000);
+    CHECK(map.at(500) == "500");
+
+    // freed nodes are reused
+    auto p = &*map.find(10);
+    map.erase(10);
+    map.emplace(2000, "x");
+    CHECK(&*map.find(2000) == p);
+    map.erase(2000);
+
+    // churn
+    for (int n = 0; n < 10; ++n) {
+        for (int i = 0; i < 1000; i += 2) {
+            map.erase(i);
+        }
+        for (int i = 0; i < 1000; i += 2) {
+            map.emplace(i, std::to_string(i * n));
+        }
+    }
+    CHECK(map.size() == 1000);
+    CHECK(map.at(998) == std::to_string(998 * 9));
+    CHECK(map.at(999) == "999");
+
+    // copies have their own pools
+    auto copy = map;
+    CHECK(copy == map);
+    CHECK(copy.get_allocator() != map.get_allocator());
+    copy.clear();
+    CHECK(map.size() == 1000);
+
+    auto moved = std::move(map);
+    CHECK(moved.size() == 1000);
+    map.clear();
+    map[1] = "one"; // moved-from is still usable
+    CHECK(map.at(1) == "one");
+
+    copy = moved;
+    CHECK(copy.size() == 1000);
+    copy.swap(map);
+    CHECK(copy.size() == 1);
+    CHECK(map.size() == 1000);
+    map = std::move(copy);
+    CHECK(map.size() == 1);
+    CHECK(map.at(1) == "one");
+}
+
+TEST_CASE("node_pool_allocator") {
+    itlib::node_pool_allocator<int> a;
+    itlib::node_pool_allocator<double> b = a;
+    CHECK(a == b);
+    CHECK(a != itlib::node_pool_allocator<int>{});
+
+    std::vector<int*> ptrs;
+    for (int i = 0; i < 100; ++i) {
+        ptrs.push_back(a.allocate(1));
+        *ptrs.back() = i;
+    }
+    for (int i = 0; i < 100; ++i) {
+        CHECK(*ptrs[i] == i);
+    }
+
+    // different sizes use different lists of the same pool
+    struct big { char buf[100]; };
+    itlib::node_pool_allocator<big> c(a);
+    auto bp = c.allocate(1);
+    auto bp2 = c.allocate(1);
+    CHECK(bp != bp2);
+    c.deallocate(bp2, 1);
+    c.deallocate(bp, 1);
+    CHECK(c.allocate(1) == bp);
+
+    auto arr = a.allocate(10); // not from the pool
+    a.deallocate(arr, 10);
+
+    // any copy can deallocate
+    itlib::node_pool_allocator<int> a2(b);
+    for (auto p : ptrs) {
+        a2.deallocate(p, 1);
+    }
+    CHECK(a.allocate(1) == ptrs.back());
+}
@@ -6,6 +6,11 @@
 #include <type_traits>
 #include <itlib/ufunction.hpp>
 
+#include <memory>
+#include <stdexcept>
+#include <functional>
+#include <vector>
+
 TEST_SUITE_BEGIN("ufunction");
 
 static_assert(!std::is_copy_constructible<itlib::ufunction<void()>>::value, "must not be copy constructible");
@@ -65,6 +70,41 @@ TEST_CASE("from copy")
     CHECK(f2(10, 20) == 30);
 }
 
+TEST_CASE("discard return value")
+{
+    int n = 0;
+    itlib::ufunction<void()> f = [&n]() { return ++n; };
+    f();
+    CHECK(n == 1);
+    f = [&n]() { n = 10; };
+    f();
+    CHECK(n == 10);
+}
+
+struct ret_int { int operator()() { return 5; } };
+struct base { virtual ~base() = default; };
+struct derived : base {};
+struct ret_base_ref { base& operator()() { static base b; return b; } };
+struct ret_derived_ref { derived& operator()() { static derived d; return d; } };
+
+// same rules as std::function: implicit conversions only
+static_assert(std::is_constructible<itlib::ufunction<void()>, ret_int>::value, "discard");
+static_assert(std::is_constructible<itlib::ufunction<long()>, ret_int>::value, "implicit conversion");
+static_assert(!std::is_constructible<itlib::ufunction<std::vector<int>()>, ret_int>::value, "explicit conversion");
+static_assert(!std::is_constructible<itlib::ufunction<int(int)>, ret_int>::value, "bad args");
+static_assert(!std::is_constructible<itlib::ufunction<const int&()>, ret_int>::value, "dangling reference");
+static_assert(!std::is_constructible<itlib::ufunction<const long&()>, ret_int>::value, "dangling reference");
+static_assert(std::is_constructible<itlib::ufunction<base&()>, ret_derived_ref>::value, "upcast");
+static_assert(!std::is_constructible<itlib::ufunction<derived&()>, ret_base_ref>::value, "downcast");
+
+TEST_CASE("return conversion")
+{
+    itlib::ufunction<long()> f = ret_int{};
+    CHECK(f() == 5);
+    itlib::ufunction<base&()> b = ret_derived_ref{};
+    CHECK(dynamic_cast<derived*>(&b()));
+}
+
 TEST_CASE("from null") {
     {
         itlib::ufunction<void()> f;
@@ -80,3 +120,103 @@ TEST_CASE("from null") {
         CHECK_FALSE(f);
     }
 }
+
+struct self_addr
+{
+    char buf[16] = {};
+    const void* operator()() const { return this; }
+};
+
+struct self_addr_big
+{
+    char buf[100] = {};
+    const void* operator()() const { return this; }
+};
+
+struct self_addr_throw_move
+{
+    self_addr_throw_move() = default;
+    self_addr_throw_move(self_addr_throw_move&&) noexcept(false) {}
+    const void* operator()() const { return this; }
+};
+
+template <typename UF>
+bool is_inside(const UF& f, const void* p)
+{
+    auto b = reinterpret_cast<const char*>(&f);
+    auto c = static_cast<const char*>(p);
+    return c >= b && c < b + sizeof(UF);
+}
+
+TEST_CASE("inline buffer")
+{
+    using namespace itlib;
+
+    {
+        ufunction<const void*()> f = self_addr{};
+        CHECK(is_inside(f, f()));
+        auto f2 = std::move(f);
+        CHECK(is_inside(f2, f2()));
+        CHECK_FALSE(f);
+    }
+
+    {
+        ufunction<const void*()> f = self_addr_big{};
+        auto p = f();
+        CHECK_FALSE(is_inside(f, p));
+        auto f2 = std::move(f);
+        CHECK(f2() == p); // heap object is not moved
+    }
+
+    {
+        ufunction<const void*(), 128> f = self_addr_big{};
+        CHECK(is_inside(f, f()));
+    }
+
+    {
+        ufunction<const void*()> f = self_addr_throw_move{};
+        CHECK_FALSE(is_inside(f, f()));
+    }
+
+    {
+        ufunction<const void*(), 0> f = self_addr{};
+        CHECK_FALSE(is_inside(f, f()));
+        f = {};
+        CHECK_FALSE(f);
+    }
+
+    static_assert(std::is_nothrow_constructible<ufunction<const void*()>, self_addr>::value, "inline is noexcept");
+    static_assert(sizeof(ufunction<void(), 64>) - sizeof(ufunction<void(), 32>) == 32, "inline buffer");
+}
+
+TEST_CASE("lifetime")
+{
+    auto p = std::make_shared<int>(5);
+    {
+        itlib::ufunction<int()> f = [p]() { return *p; };
+        CHECK(p.use_count() == 2);
+        CHECK(f() == 5);
+
+        auto f2 = std::move(f);
+        CHECK(p.use_count() == 2);
+
+        f = [p]() { return *p + 1; };
+        CHECK(p.use_count() == 3);
+
+        f2 = std::move(f);
+        CHECK(p.use_count() == 2);
+        CHECK(f2() == 6);
+
+        f2 = nullptr;
+        CHECK(p.use_count() == 1);
+
+        self_addr_big big;
+        f2 = [p, big]() { return *p + !!big(); };
+        CHECK(p.use_count() == 2);
+        CHECK(f2() == 6);
+    }
+    CHECK(p.use_count() == 1);
+
+    itlib::ufunction<void()> empty;
+    CHECK_THROWS_AS(empty(), std::bad_function_call);
+}
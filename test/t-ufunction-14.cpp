@@ -7,6 +7,7 @@
 #include <itlib/ufunction.hpp>
 
 #include <memory>
+#include <vector>
 
 TEST_SUITE_BEGIN("ufunction");
 
@@ -34,3 +35,26 @@ TEST_CASE("Basic")
     f2 = nullptr; // must compile
     CHECK_FALSE(f2);
 }
+
+TEST_CASE("inline unique_ptr captures")
+{
+    auto u = std::make_unique<int>(11);
+    auto raw = u.get();
+    int a = 1, b = 2, c = 3;
+    itlib::ufunction<int(int), 64> f = [u = std::move(u), a, b, c](int x) {
+        return *u + a + b + c + x;
+    };
+    CHECK(f(100) == 117);
+
+    std::vector<itlib::ufunction<int(int), 64>> vec;
+    vec.push_back(std::move(f));
+    for (int i = 0; i < 10; ++i) {
+        vec.emplace_back([i](int x) { return x * i; });
+    }
+    CHECK(vec.front()(0) == 17);
+    CHECK(vec.back()(3) == 27);
+
+    auto take = [raw](std::unique_ptr<int> p) { return p.get() == raw; };
+    itlib::ufunction<bool(std::unique_ptr<int>)> ft = take;
+    CHECK_FALSE(ft(std::make_unique<int>(3)));
+}
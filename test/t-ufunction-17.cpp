@@ -0,0 +1,109 @@
+// Copyright (c) Borislav Stanimirov
+// SPDX-License-Identifier: MIT
+//
+#include <cstdint> // just something that will give us _LIBCPP_VERSION
+
+// completely disable this test on older versions of libc++ which don't have pmr
+#if !defined(_LIBCPP_VERSION) || _LIBCPP_VERSION >= 16000
+
+#include <itlib/ufunction.hpp>
+#include <itlib/pmr_allocator.hpp>
+
+#include <doctest/doctest.h>
+
+#include <memory>
+#include <vector>
+#include <array>
+
+TEST_SUITE_BEGIN("ufunction");
+
+class counting_resource : public std::pmr::memory_resource {
+public:
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    size_t allocated_bytes = 0;
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++allocations;
+        allocated_bytes += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        ++deallocations;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+using pmr_ufunc = itlib::ufunction<int(), 16, itlib::pmr_allocator<>>;
+
+TEST_CASE("ufunction pmr_allocator") {
+    counting_resource res;
+    itlib::pmr_allocator<> alloc(&res);
+
+    std::array<int, 10> big = {1, 2, 3};
+    auto u = std::make_unique<int>(4);
+
+    {
+        pmr_ufunc f(std::allocator_arg, alloc, [big]() { return big[2]; });
+        CHECK(f.get_allocator() == alloc);
+        CHECK(res.allocations == 1);
+        CHECK(f() == 3);
+
+        f = [u = std::move(u)]() { return *u; }; // inline
+        CHECK(res.allocations == 1);
+        CHECK(res.deallocations == 1);
+        CHECK(f() == 4);
+
+        f = [big]() { return big[0]; };
+        CHECK(res.allocations == 2);
+
+        pmr_ufunc f2 = std::move(f);
+        CHECK(f2.get_allocator() == alloc);
+        CHECK(res.allocations == 2);
+        CHECK(f2() == 1);
+
+        // other allocator: heap block of f2 keeps its own
+        counting_resource res2;
+        pmr_ufunc f3(std::allocator_arg, itlib::pmr_allocator<>(&res2), [big]() { return big[1]; });
+        CHECK(res2.allocations == 1);
+        f3 = std::move(f2);
+        CHECK(res2.deallocations == 1);
+        CHECK(f3() == 1);
+        f3 = nullptr;
+        CHECK(res.deallocations == 2);
+        CHECK(res2.deallocations == 1);
+    }
+    CHECK(res.allocations == res.deallocations);
+}
+
+TEST_CASE("ufunction pmr container") {
+    static_assert(std::uses_allocator_v<pmr_ufunc, itlib::pmr_allocator<>>);
+    static_assert(std::uses_allocator_v<pmr_ufunc, std::pmr::polymorphic_allocator<int>>);
+    static_assert(!std::uses_allocator_v<itlib::ufunction<int()>, std::allocator<int>>);
+
+    counting_resource res;
+    std::array<int, 10> big = {5};
+    {
+        std::pmr::monotonic_buffer_resource arena(&res);
+        std::pmr::vector<pmr_ufunc> tasks(&arena);
+
+        for (int i = 0; i < 10; ++i) {
+            auto& f = tasks.emplace_back();
+            CHECK(f.get_allocator().resource() == &arena);
+            f = [i, big]() { return i + big[0]; };
+        }
+
+        tasks.emplace_back([]() { return 100; });
+        CHECK(tasks.back().get_allocator().resource() == &arena);
+
+        int sum = 0;
+        for (auto& t : tasks) sum += t();
+        CHECK(sum == 45 + 50 + 100);
+    }
+    CHECK(res.allocations == res.deallocations);
+}
+
+#endif